@@ -143,6 +143,7 @@ list (APPEND PUBLIC_HEADER_FILES
              opm/models/discretization/common/fvbaseproblem.hh
              opm/models/discretization/common/fvbaseprimaryvariables.hh
              opm/models/discretization/common/linearizationtype.hh
+             opm/models/discretization/common/rcmelementmapper.hh
              opm/models/discretization/ecfv/ecfvgridcommhandlefactory.hh
              opm/models/discretization/ecfv/ecfvstencil.hh
              opm/models/discretization/ecfv/ecfvbaseoutputmodule.hh
@@ -159,6 +160,7 @@ list (APPEND PUBLIC_HEADER_FILES
              opm/models/flash/flashparameters.hh
              opm/models/flash/flashproperties.hh
              opm/models/immiscible/immisciblelocalresidual.hh
+             opm/models/immiscible/immisciblelocalresidualtpfa.hh
              opm/models/immiscible/immiscibleproperties.hh
              opm/models/immiscible/immisciblemodel.hh
              opm/models/immiscible/immiscibleboundaryratevector.hh
@@ -213,7 +215,9 @@ list (APPEND PUBLIC_HEADER_FILES
              opm/models/parallel/threadmanager.hh
              opm/models/parallel/gridcommhandles.hh
              opm/models/parallel/mpibuffer.hh
+             opm/models/parallel/collectiveaccumulator.hh
              opm/models/parallel/threadedentityiterator.hh
+             opm/models/parallel/threadedelementchunks.hh
              opm/models/ptflash/flashintensivequantities.hh
              opm/models/ptflash/flashindices.hh
              opm/models/ptflash/flashlocalresidual.hh
@@ -275,6 +279,8 @@ list (APPEND PUBLIC_HEADER_FILES
              opm/simulators/linalg/elementborderlistfromgrid.hh
              opm/simulators/linalg/combinedcriterion.hh
              opm/simulators/linalg/bicgstabsolver.hh
+             opm/simulators/linalg/fusedbicgstabsolver.hh
+             opm/simulators/linalg/sparsitypattern.hh
              opm/simulators/linalg/globalindices.hh
              opm/simulators/linalg/superlubackend.hh
              opm/simulators/linalg/matrixblock.hh
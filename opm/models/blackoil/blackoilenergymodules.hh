@@ -295,8 +295,8 @@ public:
         return std::abs(scalarValue(resid[contiEnergyEqIdx]));
     }
 
-    template <class DofEntity>
-    static void serializeEntity(const Model& model, std::ostream& outstream, const DofEntity& dof)
+    template <class OutStream, class DofEntity>
+    static void serializeEntity(const Model& model, OutStream& outstream, const DofEntity& dof)
     {
         if constexpr (enableEnergy) {
             unsigned dofIdx = model.dofMapper().index(dof);
@@ -305,8 +305,8 @@ public:
         }
     }
 
-    template <class DofEntity>
-    static void deserializeEntity(Model& model, std::istream& instream, const DofEntity& dof)
+    template <class InStream, class DofEntity>
+    static void deserializeEntity(Model& model, InStream& instream, const DofEntity& dof)
     {
         if constexpr (enableEnergy) {
             unsigned dofIdx = model.dofMapper().index(dof);
@@ -447,8 +447,8 @@ public:
         return std::abs(Toolbox::scalarValue(resid[contiZfracEqIdx]));
     }
 
-    template <class DofEntity>
-    static void serializeEntity(const Model& model, std::ostream& outstream, const DofEntity& dof)
+    template <class OutStream, class DofEntity>
+    static void serializeEntity(const Model& model, OutStream& outstream, const DofEntity& dof)
     {
         if constexpr (enableExtbo) {
             unsigned dofIdx = model.dofMapper().index(dof);
@@ -458,8 +458,8 @@ public:
         }
     }
 
-    template <class DofEntity>
-    static void deserializeEntity(Model& model, std::istream& instream, const DofEntity& dof)
+    template <class InStream, class DofEntity>
+    static void deserializeEntity(Model& model, InStream& instream, const DofEntity& dof)
     {
         if constexpr (enableExtbo) {
             unsigned dofIdx = model.dofMapper().index(dof);
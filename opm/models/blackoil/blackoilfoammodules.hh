@@ -368,9 +368,9 @@ public:
         return static_cast<Scalar>(0.0);
     }
 
-    template <class DofEntity>
+    template <class OutStream, class DofEntity>
     static void serializeEntity([[maybe_unused]] const Model& model,
-                                [[maybe_unused]] std::ostream& outstream,
+                                [[maybe_unused]] OutStream& outstream,
                                 [[maybe_unused]] const DofEntity& dof)
     {
         if constexpr (enableFoam) {
@@ -380,9 +380,9 @@ public:
         }
     }
 
-    template <class DofEntity>
+    template <class InStream, class DofEntity>
     static void deserializeEntity([[maybe_unused]] Model& model,
-                                  [[maybe_unused]] std::istream& instream,
+                                  [[maybe_unused]] InStream& instream,
                                   [[maybe_unused]] const DofEntity& dof)
     {
         if constexpr (enableFoam) {
@@ -43,6 +43,10 @@
 #include <opm/input/eclipse/EclipseState/Grid/FaceDir.hpp>
 #include <opm/input/eclipse/Schedule/BCProp.hpp>
 
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+
 namespace Opm {
 /*!
  * \ingroup BlackOilModel
@@ -114,26 +118,234 @@ class BlackOilLocalResidualTPFA : public GetPropType<TypeTag, Properties::DiscLo
     using Toolbox = MathToolbox<Evaluation>;
 
 public:
+    // the parts of the face data which are only required by some modules
+    struct EnergyNBInfo
+    {
+        Scalar inAlpha;
+        Scalar outAlpha;
+    };
+    struct DiffusionNBInfo
+    {
+        Scalar diffusivity;
+    };
+    struct DispersionNBInfo
+    {
+        Scalar dispersivity;
+    };
+    template <int moduleIdx>
+    struct NoNBInfo
+    {};
 
+    /*!
+     * \brief The data of an interior face which is required to compute its flux.
+     *
+     * The fields of the energy, diffusion and dispersion modules are only present if
+     * the respective module is enabled, i.e., the linearizer only streams through the
+     * data which is actually used.
+     */
     struct ResidualNBInfo
+        : public std::conditional_t<enableEnergy, EnergyNBInfo, NoNBInfo<0>>
+        , public std::conditional_t<enableDiffusion, DiffusionNBInfo, NoNBInfo<1>>
+        , public std::conditional_t<enableDispersion, DispersionNBInfo, NoNBInfo<2>>
     {
-        double trans;
-        double faceArea;
-        double thpres;
-        double dZg;
+        Scalar trans;
+        Scalar faceArea;
+        Scalar thpres;
+        Scalar dZg;
+        Scalar Vin;
+        Scalar Vex;
         FaceDir::DirEnum faceDir;
-        double Vin;
-        double Vex;
-        double inAlpha;
-        double outAlpha;
-        double diffusivity;
-        double dispersivity;
     };
 
     struct ModuleParams {
         ConvectiveMixingModuleParam convectiveMixingModuleParam;
     };
 
+    using ScalarFluidState = typename IntensiveQuantities::ScalarFluidState;
+    struct BoundaryConditionData
+    {
+        BCType type;
+        Dune::FieldVector<Scalar, numEq> massRate;
+        unsigned pvtRegionIdx;
+        unsigned boundaryFaceIndex;
+        double faceArea;
+        double faceZCoord;
+        ScalarFluidState exFluidState;
+    };
+
+    // The methods below are the interface which is used by TpfaLinearizer to obtain
+    // the data of the faces, the boundary conditions, the sparse source terms and
+    // the requested output. They are all ECL-specific for the black-oil model.
+
+    /*!
+     * \brief Compute the data of an interior face which is kept by the linearizer.
+     *
+     * Apart from the area and the direction of the face, the geometry is taken from
+     * the problem, i.e., from the ECL transmissibilities.
+     */
+    template <class Stencil>
+    static ResidualNBInfo computeNeighborInfo(const Problem& problem,
+                                              unsigned globalIndexIn,
+                                              unsigned globalIndexEx,
+                                              const Stencil& stencil,
+                                              unsigned scvfIdx)
+    {
+        const auto& scvf = stencil.interiorFace(scvfIdx);
+        const Scalar faceArea = scvf.area();
+        const int dirId = scvf.dirId();
+        const Scalar gravity = problem.gravity()[dimWorld - 1];
+        const Scalar zIn = problem.dofCenterDepth(globalIndexIn);
+        const Scalar zEx = problem.dofCenterDepth(globalIndexEx);
+
+        ResidualNBInfo nbInfo;
+        nbInfo.trans = problem.transmissibility(globalIndexIn, globalIndexEx);
+        nbInfo.faceArea = faceArea;
+        nbInfo.thpres = problem.thresholdPressure(globalIndexIn, globalIndexEx);
+        nbInfo.dZg = (zIn - zEx)*gravity;
+        nbInfo.Vin = problem.model().dofTotalVolume(globalIndexIn);
+        nbInfo.Vex = problem.model().dofTotalVolume(globalIndexEx);
+        nbInfo.faceDir = faceDirFromDirId(dirId);
+        if constexpr(enableEnergy){
+            nbInfo.inAlpha = problem.thermalHalfTransmissibility(globalIndexIn, globalIndexEx);
+            nbInfo.outAlpha = problem.thermalHalfTransmissibility(globalIndexEx, globalIndexIn);
+        }
+        if constexpr(enableDiffusion){
+            nbInfo.diffusivity = problem.diffusivity(globalIndexIn, globalIndexEx);
+        }
+        if constexpr(enableDispersion){
+            nbInfo.dispersivity = needsVelocityInfo(problem)
+                ? problem.dispersivity(globalIndexIn, globalIndexEx)
+                : 0.0;
+        }
+        return nbInfo;
+    }
+
+    /*!
+     * \brief Update the parts of the face data which depend on the transmissibilities.
+     */
+    static void updateNeighborInfo(ResidualNBInfo& nbInfo,
+                                   const Problem& problem,
+                                   unsigned globalIndexIn,
+                                   unsigned globalIndexEx)
+    { nbInfo.trans = problem.transmissibility(globalIndexIn, globalIndexEx); }
+
+    /*!
+     * \brief Returns the parameters of the modules which are passed to computeFlux().
+     */
+    static decltype(auto) moduleParams(const Problem& problem)
+    { return problem.moduleParams(); }
+
+    /*!
+     * \brief Returns true if the phase velocities of the faces need to be stored.
+     *
+     * This is the case if dispersion is enabled by the deck.
+     */
+    static bool needsVelocityInfo(const Problem& problem)
+    { return problem.simulator().vanguard().eclState().getSimulationConfig().rock_config().dispersion(); }
+
+    /*!
+     * \brief Add the source terms which are not treated cell by cell, i.e., the wells.
+     */
+    template <class GlobalEqVector, class DiagonalBlockAddresses>
+    static void addSparseSourceTerms(Problem& problem,
+                                     GlobalEqVector& residual,
+                                     DiagonalBlockAddresses& diagMatAddress)
+    { problem.wellModel().addReservoirSourceTerms(residual, diagMatAddress); }
+
+    /*!
+     * \brief Returns true if boundary conditions other than no-flow are possible.
+     */
+    static bool nonTrivialBoundaryConditions(const Problem& problem)
+    { return problem.nonTrivialBoundaryConditions(); }
+
+    /*!
+     * \brief Returns the data of the boundary condition of a boundary face.
+     */
+    template <class BoundaryFace, class GlobalPosition>
+    static BoundaryConditionData boundaryConditionData(const Problem& problem,
+                                                       unsigned globalIndex,
+                                                       unsigned bfIndex,
+                                                       const BoundaryFace& face,
+                                                       const GlobalPosition& /*cellCenter*/)
+    {
+        const int dirId = face.dirId();
+        const auto [type, massrateAD] = problem.boundaryCondition(globalIndex, dirId);
+        const auto& exFluidState = problem.boundaryFluidState(globalIndex, dirId);
+        return BoundaryConditionData{type,
+                                     massRateValues_(massrateAD),
+                                     exFluidState.pvtRegionIndex(),
+                                     bfIndex,
+                                     face.area(),
+                                     face.integrationPos()[dimWorld - 1],
+                                     exFluidState};
+    }
+
+    /*!
+     * \brief Update the boundary condition of a boundary face for the current time.
+     */
+    static void updateBoundaryConditionData(BoundaryConditionData& bcdata,
+                                            const Problem& problem,
+                                            unsigned globalIndex,
+                                            int dirId)
+    {
+        const auto [type, massrateAD] = problem.boundaryCondition(globalIndex, dirId);
+        if (type != BCType::NONE) {
+            bcdata.type = type;
+            bcdata.massRate = massRateValues_(massrateAD);
+            bcdata.exFluidState = problem.boundaryFluidState(globalIndex, dirId);
+        }
+    }
+
+    /*!
+     * \brief Returns true if there is a flux over a boundary face.
+     */
+    static bool hasBoundaryFlux(const BoundaryConditionData& bcdata)
+    { return bcdata.type != BCType::NONE; }
+
+    /*!
+     * \brief Returns whether the flows and the flores are written for the current
+     *        time step.
+     */
+    static std::pair<bool, bool> flowsOutput(const Problem& problem)
+    {
+        const auto& outputModule = problem.eclWriter()->outputModule();
+        return {outputModule.hasFlows() || outputModule.hasBlockFlows(),
+                outputModule.hasFlores()};
+    }
+
+    /*!
+     * \brief Returns whether the flows and the flores are written for any time step.
+     */
+    static std::pair<bool, bool> anyFlowsOutput(const Problem& problem)
+    {
+        const auto& outputModule = problem.eclWriter()->outputModule();
+        return {outputModule.anyFlows(), outputModule.anyFlores()};
+    }
+
+    /*!
+     * \brief Returns the non-neighbor connections for which flows are written.
+     *
+     * The map contains the index of the connection for the Cartesian index of its
+     * first cell and that of its second cell.
+     */
+    static std::unordered_multimap<int, std::pair<int, int>> outputNncIndices(const Problem& problem)
+    {
+        std::unordered_multimap<int, std::pair<int, int>> nncIndices;
+        const auto& nncOutput = problem.eclWriter()->getOutputNnc();
+        for (unsigned int nncIdx = 0; nncIdx < nncOutput.size(); ++nncIdx) {
+            const int ci1 = nncOutput[nncIdx].cell1;
+            const int ci2 = nncOutput[nncIdx].cell2;
+            nncIndices.emplace(ci1, std::make_pair(ci2, nncIdx));
+        }
+        return nncIndices;
+    }
+
+    /*!
+     * \brief Returns the Cartesian index of a cell which is used by outputNncIndices().
+     */
+    static int cartesianIndex(const Problem& problem, unsigned globalIndex)
+    { return problem.simulator().vanguard().cartesianIndex(globalIndex); }
+
     /*!
      * \copydoc FvBaseLocalResidual::computeStorage
      */
@@ -304,13 +516,25 @@ public:
         // the distances from the DOF's depths. (i.e., the additional depth of the
         // exterior DOF)
         const Scalar distZ = zIn - zEx;
+        ResidualNBInfo res_nbinfo;
+        res_nbinfo.trans = trans;
+        res_nbinfo.faceArea = faceArea;
+        res_nbinfo.thpres = thpres;
+        res_nbinfo.dZg = distZ * g;
+        res_nbinfo.Vin = Vin;
+        res_nbinfo.Vex = Vex;
+        res_nbinfo.faceDir = faceDir;
         // for thermal harmonic mean of half trans
-        const Scalar inAlpha = problem.thermalHalfTransmissibility(globalIndexIn, globalIndexEx);
-        const Scalar outAlpha = problem.thermalHalfTransmissibility(globalIndexEx, globalIndexIn);
-        const Scalar diffusivity = problem.diffusivity(globalIndexEx, globalIndexIn);
-        const Scalar dispersivity = problem.dispersivity(globalIndexEx, globalIndexIn);
-
-        const ResidualNBInfo res_nbinfo {trans, faceArea, thpres, distZ * g, faceDir, Vin, Vex, inAlpha, outAlpha, diffusivity, dispersivity};
+        if constexpr(enableEnergy){
+            res_nbinfo.inAlpha = problem.thermalHalfTransmissibility(globalIndexIn, globalIndexEx);
+            res_nbinfo.outAlpha = problem.thermalHalfTransmissibility(globalIndexEx, globalIndexIn);
+        }
+        if constexpr(enableDiffusion){
+            res_nbinfo.diffusivity = problem.diffusivity(globalIndexEx, globalIndexIn);
+        }
+        if constexpr(enableDispersion){
+            res_nbinfo.dispersivity = problem.dispersivity(globalIndexEx, globalIndexIn);
+        }
 
         calculateFluxes_(flux,
                          darcy,
@@ -322,6 +546,87 @@ public:
                          problem.moduleParams());
     }
 
+    /*!
+     * \brief Compute the values of the flux over a face without any derivatives.
+     *
+     * This works like computeFlux(), but apart from the pressure difference, the
+     * fluxes are evaluated using scalars. It is thus considerably cheaper if only the
+     * residual is required. The modules which only provide fluxes in terms of
+     * Evaluation fall back to computeFlux().
+     */
+    template <class ScalarVector>
+    static void computeFluxValues(ScalarVector& flux,
+                                  ScalarVector& darcy,
+                                  const unsigned globalIndexIn,
+                                  const unsigned globalIndexEx,
+                                  const IntensiveQuantities& intQuantsIn,
+                                  const IntensiveQuantities& intQuantsEx,
+                                  const ResidualNBInfo& nbInfo,
+                                  const ModuleParams& moduleParams)
+    {
+        OPM_TIMEBLOCK_LOCAL(computeFluxValues);
+        if constexpr (enableEnergy || enableDiffusion || enableDispersion || enableConvectiveMixing) {
+            RateVector adFlux;
+            RateVector adDarcy;
+            computeFlux(adFlux, adDarcy, globalIndexIn, globalIndexEx,
+                        intQuantsIn, intQuantsEx, nbInfo, moduleParams);
+            for (unsigned eqIdx = 0; eqIdx < numEq; ++eqIdx) {
+                flux[eqIdx] = Toolbox::value(adFlux[eqIdx]);
+                darcy[eqIdx] = Toolbox::value(adDarcy[eqIdx]);
+            }
+        }
+        else {
+            flux = 0.0;
+            darcy = 0.0;
+
+            const Scalar trans = nbInfo.trans;
+            const Scalar faceArea = nbInfo.faceArea;
+            const FaceDir::DirEnum facedir = nbInfo.faceDir;
+            const Scalar transMult =
+                (Toolbox::value(intQuantsIn.rockCompTransMultiplier())
+                 + Toolbox::value(intQuantsEx.rockCompTransMultiplier()))/2;
+
+            for (unsigned phaseIdx = 0; phaseIdx < numPhases; ++phaseIdx) {
+                if (!FluidSystem::phaseIsActive(phaseIdx))
+                    continue;
+
+                short dnIdx;
+                short upIdx;
+                short interiorDofIdx = 0; // NB
+                short exteriorDofIdx = 1; // NB
+                Evaluation pressureDifference;
+                ExtensiveQuantities::calculatePhasePressureDiff_(upIdx,
+                                                                 dnIdx,
+                                                                 pressureDifference,
+                                                                 intQuantsIn,
+                                                                 intQuantsEx,
+                                                                 phaseIdx,
+                                                                 interiorDofIdx,
+                                                                 exteriorDofIdx,
+                                                                 nbInfo.Vin,
+                                                                 nbInfo.Vex,
+                                                                 globalIndexIn,
+                                                                 globalIndexEx,
+                                                                 nbInfo.dZg,
+                                                                 nbInfo.thpres,
+                                                                 moduleParams);
+
+                const IntensiveQuantities& up = (upIdx == interiorDofIdx) ? intQuantsIn : intQuantsEx;
+                const Scalar darcyFlux =
+                    Toolbox::value(pressureDifference)
+                    * Toolbox::value(up.mobility(phaseIdx, facedir)) * transMult * (-trans / faceArea);
+
+                unsigned activeCompIdx = Indices::canonicalToActiveComponentIndex(FluidSystem::solventComponentIndex(phaseIdx));
+                darcy[conti0EqIdx + activeCompIdx] = darcyFlux * faceArea;
+
+                unsigned pvtRegionIdx = up.pvtRegionIndex();
+                const Scalar invB = getInvB_<FluidSystem, FluidState, Scalar>(up.fluidState(), phaseIdx, pvtRegionIdx);
+                evalPhaseFluxes_<Scalar, Scalar, FluidState>(
+                    flux, phaseIdx, pvtRegionIdx, invB * darcyFlux, up.fluidState());
+            }
+        }
+    }
+
     static void calculateFluxes_(RateVector& flux,
                                  RateVector& darcy,
                                  const IntensiveQuantities& intQuantsIn,
@@ -749,8 +1054,8 @@ public:
      * \brief Helper function to calculate the flux of mass in terms of conservation
      *        quantities via specific fluid phase over a face.
      */
-    template <class UpEval, class Eval,class FluidState>
-    static void evalPhaseFluxes_(RateVector& flux,
+    template <class UpEval, class Eval, class FluidState, class FluxVector>
+    static void evalPhaseFluxes_(FluxVector& flux,
                                  unsigned phaseIdx,
                                  unsigned pvtRegionIdx,
                                  const Eval& surfaceVolumeFlux,
@@ -851,6 +1156,17 @@ public:
     }
 
 
+    template <class RateVectorAD>
+    static Dune::FieldVector<Scalar, numEq> massRateValues_(const RateVectorAD& massrateAD)
+    {
+        // Strip the unnecessary (and zero anyway) derivatives off massrate.
+        Dune::FieldVector<Scalar, numEq> massrate(0.0);
+        for (size_t ii = 0; ii < massrate.size(); ++ii) {
+            massrate[ii] = massrateAD[ii].value();
+        }
+        return massrate;
+    }
+
     static FaceDir::DirEnum faceDirFromDirId(const int dirId)
     {
         // NNC does not have a direction
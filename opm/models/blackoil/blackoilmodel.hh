@@ -464,8 +464,8 @@ public:
      *                  be serialized to
      * \param dof The Dune entity which's data should be serialized
      */
-    template <class DofEntity>
-    void serializeEntity(std::ostream& outstream, const DofEntity& dof)
+    template <class OutStream, class DofEntity>
+    void serializeEntity(OutStream& outstream, const DofEntity& dof)
     {
         unsigned dofIdx = static_cast<unsigned>(asImp_().dofMapper().index(dof));
 
@@ -499,8 +499,8 @@ public:
      *                  be deserialized from
      * \param dof The Dune entity which's data should be deserialized
      */
-    template <class DofEntity>
-    void deserializeEntity(std::istream& instream,
+    template <class InStream, class DofEntity>
+    void deserializeEntity(InStream& instream,
                            const DofEntity& dof)
     {
         unsigned dofIdx = static_cast<unsigned>(asImp_().dofMapper().index(dof));
@@ -35,6 +35,7 @@
 
 #include <opm/models/utils/signum.hh>
 #include <opm/models/nonlinear/newtonmethod.hh>
+#include <opm/models/parallel/collectiveaccumulator.hh>
 #include "blackoilmicpmodules.hh"
 
 namespace Opm::Properties {
@@ -154,18 +155,8 @@ protected:
     void endIteration_(SolutionVector& uCurrentIter,
                        const SolutionVector& uLastIter)
     {
-#if HAVE_MPI
-        // in the MPI enabled case we need to add up the number of DOF
-        // for which the interpretation changed over all processes.
-        int localSwitched = numPriVarsSwitched_;
-        MPI_Allreduce(&localSwitched,
-                      &numPriVarsSwitched_,
-                      /*num=*/1,
-                      MPI_INT,
-                      MPI_SUM,
-                      MPI_COMM_WORLD);
-#endif // HAVE_MPI
-
+        // the number of DOFs for which the interpretation changed has already been
+        // added up over all processes by update_()
         this->simulator_.model().newtonMethod().endIterMsg()
             << ", num switched=" << numPriVarsSwitched_;
 
@@ -178,8 +169,6 @@ public:
                  const GlobalEqVector& solutionUpdate,
                  const GlobalEqVector& currentResidual)
     {
-        const auto& comm = this->simulator_.gridView().comm();
-
         int succeeded;
         try {
             ParentType::update_(nextSolution,
@@ -191,12 +180,18 @@ public:
         catch (...) {
             succeeded = 0;
         }
-        succeeded = comm.min(succeeded);
 
-        if (!succeeded)
+        // reduce the status and the number of switched DOFs using a single collective
+        // operation
+        CollectiveAccumulator collectives(this->simulator_.gridView().comm());
+        const auto succeededIdx = collectives.addMin(succeeded);
+        const auto numSwitchedIdx = collectives.addSum(numPriVarsSwitched_);
+        collectives.reduce();
+
+        if (!collectives[succeededIdx])
             throw NumericalProblem("A process did not succeed in adapting the primary variables");
 
-        numPriVarsSwitched_ = comm.sum(numPriVarsSwitched_);
+        numPriVarsSwitched_ = static_cast<int>(collectives[numSwitchedIdx]);
     }
 
     template <class DofIndices>
@@ -220,6 +215,19 @@ public:
     }
 
 protected:
+    /*!
+     * \copydoc FvBaseNewtonMethod::primaryVarsMeaningChanged_
+     */
+    bool primaryVarsMeaningChanged_(const PrimaryVariables& nextValue,
+                                    const PrimaryVariables& currentValue) const
+    {
+        return nextValue.primaryVarsMeaningWater() != currentValue.primaryVarsMeaningWater() ||
+               nextValue.primaryVarsMeaningPressure() != currentValue.primaryVarsMeaningPressure() ||
+               nextValue.primaryVarsMeaningGas() != currentValue.primaryVarsMeaningGas() ||
+               nextValue.primaryVarsMeaningBrine() != currentValue.primaryVarsMeaningBrine() ||
+               nextValue.primaryVarsMeaningSolvent() != currentValue.primaryVarsMeaningSolvent();
+    }
+
     /*!
      * \copydoc FvBaseNewtonMethod::updatePrimaryVariables_
      */
@@ -417,8 +425,13 @@ protected:
         else
             wasSwitched_[globalDofIdx] = nextValue.adaptPrimaryVariables(this->problem(), globalDofIdx, waterSaturationMax_, waterOnlyThreshold_);
 
-        if (wasSwitched_[globalDofIdx])
+        if (wasSwitched_[globalDofIdx]) {
+            // the DOFs may be updated by multiple threads
+#ifdef _OPENMP
+#pragma omp atomic
+#endif
             ++ numPriVarsSwitched_;
+        }
         if(projectSaturations_){
             nextValue.chopAndNormalizeSaturations();
         }
@@ -443,8 +456,9 @@ private:
     Scalar pressMin_;
 
     // keep track of cells where the primary variable meaning has changed
-    // to detect and hinder oscillations
-    std::vector<bool> wasSwitched_;
+    // to detect and hinder oscillations. a std::vector<bool> can't be written
+    // concurrently by multiple threads.
+    std::vector<unsigned char> wasSwitched_;
 };
 
 } // namespace Opm
@@ -572,8 +572,8 @@ public:
         return static_cast<Scalar>(0.0);
     }
 
-    template <class DofEntity>
-    static void serializeEntity(const Model& model, std::ostream& outstream, const DofEntity& dof)
+    template <class OutStream, class DofEntity>
+    static void serializeEntity(const Model& model, OutStream& outstream, const DofEntity& dof)
     {
         if constexpr (enablePolymer) {
             unsigned dofIdx = model.dofMapper().index(dof);
@@ -583,8 +583,8 @@ public:
         }
     }
 
-    template <class DofEntity>
-    static void deserializeEntity(Model& model, std::istream& instream, const DofEntity& dof)
+    template <class InStream, class DofEntity>
+    static void deserializeEntity(Model& model, InStream& instream, const DofEntity& dof)
     {
         if constexpr (enablePolymer) {
             unsigned dofIdx = model.dofMapper().index(dof);
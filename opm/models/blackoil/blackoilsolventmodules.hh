@@ -578,8 +578,8 @@ public:
         return std::abs(Toolbox::scalarValue(resid[contiSolventEqIdx]));
     }
 
-    template <class DofEntity>
-    static void serializeEntity(const Model& model, std::ostream& outstream, const DofEntity& dof)
+    template <class OutStream, class DofEntity>
+    static void serializeEntity(const Model& model, OutStream& outstream, const DofEntity& dof)
     {
         if constexpr (enableSolvent) {
             unsigned dofIdx = model.dofMapper().index(dof);
@@ -589,8 +589,8 @@ public:
         }
     }
 
-    template <class DofEntity>
-    static void deserializeEntity(Model& model, std::istream& instream, const DofEntity& dof)
+    template <class InStream, class DofEntity>
+    static void deserializeEntity(Model& model, InStream& instream, const DofEntity& dof)
     {
         if constexpr (enableSolvent) {
             unsigned dofIdx = model.dofMapper().index(dof);
@@ -1369,7 +1369,7 @@ public:
         Valgrind::CheckDefined(solventPGrad);
 
         // correct the pressure gradients by the gravitational acceleration
-        if (Parameters::Get<Parameters::EnableGravity>()) {
+        if (Parameters::GetCached<Parameters::EnableGravity>()) {
             // estimate the gravitational acceleration at a given SCV face
             // using the arithmetic mean
             const auto& gIn = elemCtx.problem().gravity(elemCtx, i, timeIdx);
@@ -212,7 +212,7 @@ protected:
         }
 
         // correct the pressure gradients by the gravitational acceleration
-        if (Parameters::Get<Parameters::EnableGravity>()) {
+        if (Parameters::GetCached<Parameters::EnableGravity>()) {
             // estimate the gravitational acceleration at a given SCV face
             // using the arithmetic mean
             const auto& gIn = elemCtx.problem().gravity(elemCtx, i, timeIdx);
@@ -362,7 +362,7 @@ protected:
         K_ = intQuantsIn.intrinsicPermeability();
 
         // correct the pressure gradients by the gravitational acceleration
-        if (Parameters::Get<Parameters::EnableGravity>()) {
+        if (Parameters::GetCached<Parameters::EnableGravity>()) {
             // estimate the gravitational acceleration at a given SCV face
             // using the arithmetic mean
             const auto& gIn = elemCtx.problem().gravity(elemCtx, i, timeIdx);
@@ -32,7 +32,9 @@
 #include <opm/models/discretization/common/fvbaseproperties.hh>
 #include <opm/simulators/linalg/linalgproperties.hh>
 
+#include <cstddef>
 #include <set>
+#include <utility>
 #include <vector>
 
 namespace Opm::Properties::Tag {
@@ -102,6 +104,24 @@ public:
      */
     virtual void addNeighbors(std::vector<NeighborSet>& neighbors) const = 0;
 
+    /*!
+     * \brief Append the additional neighboring correlations caused by the auxiliary
+     *        module as pairs of row and column indices.
+     *
+     * The default implementation obtains them from addNeighbors(), which requires an
+     * empty set for each of the numDof degrees of freedom. Modules should override
+     * this method if this is too expensive.
+     */
+    virtual void addConnections(std::vector<std::pair<unsigned, unsigned>>& connections,
+                                std::size_t numDof) const
+    {
+        std::vector<NeighborSet> neighbors(numDof);
+        addNeighbors(neighbors);
+        for (unsigned rowIdx = 0; rowIdx < numDof; ++rowIdx)
+            for (unsigned colIdx : neighbors[rowIdx])
+                connections.emplace_back(rowIdx, colIdx);
+    }
+
     /*!
      * \brief Set the initial condition of the auxiliary module in the solution vector.
      */
@@ -197,6 +197,37 @@ public:
         }
     }
 
+    /*!
+     * \brief Evaluate the residual of an element without computing its local Jacobian
+     *        matrix.
+     *
+     * The values of the residual do not depend on the focus degree of freedom, so in
+     * contrast to linearize(), the local residual only needs to be evaluated once.
+     *
+     * \param elemCtx The element execution context for which the local residual should
+     *                be calculated.
+     */
+    void linearizeResidual(ElementContext& elemCtx, const Element& elem)
+    {
+        elemCtx.updateStencil(elem);
+        elemCtx.updateAllIntensiveQuantities();
+
+        // update the weights of the primary variables for the context
+        model_().updatePVWeights(elemCtx);
+
+        resize_(elemCtx);
+
+        elemCtx.setFocusDofIndex(/*dofIdx=*/0);
+        elemCtx.updateAllExtensiveQuantities();
+        localResidual_.eval(elemCtx);
+
+        const auto& resid = localResidual_.residual();
+        unsigned numPrimaryDof = elemCtx.numPrimaryDof(/*timeIdx=*/0);
+        for (unsigned dofIdx = 0; dofIdx < numPrimaryDof; dofIdx++)
+            for (unsigned eqIdx = 0; eqIdx < numEq; eqIdx++)
+                residual_[dofIdx][eqIdx] = resid[dofIdx][eqIdx].value();
+    }
+
     /*!
      * \brief Return reference to the local residual.
      */
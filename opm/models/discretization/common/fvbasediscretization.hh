@@ -56,6 +56,7 @@
 #include <opm/models/io/vtkprimaryvarsmodule.hh>
 
 #include <opm/models/parallel/gridcommhandles.hh>
+#include <opm/models/parallel/threadedelementchunks.hh>
 #include <opm/models/parallel/threadmanager.hh>
 
 #include <opm/models/utils/alignedallocator.hh>
@@ -70,6 +71,7 @@
 #include <cstddef>
 #include <limits>
 #include <list>
+#include <memory>
 #include <stdexcept>
 #include <sstream>
 #include <string>
@@ -413,7 +415,8 @@ public:
         size_t numDof = asImp_().numGridDof();
         for (unsigned timeIdx = 0; timeIdx < historySize; ++timeIdx) {
             if (storeIntensiveQuantities()) {
-                intensiveQuantityCache_[timeIdx].resize(numDof);
+                if (keepIntensiveQuantities_(timeIdx))
+                    intensiveQuantityCache_[timeIdx].resize(numDof);
                 intensiveQuantityCacheUpToDate_[timeIdx].resize(numDof, /*value=*/false);
             }
 
@@ -463,6 +466,10 @@ public:
             ("Turn on caching of intensive quantities");
         Parameters::Register<Parameters::EnableStorageCache>
             ("Store previous storage terms and avoid re-calculating them.");
+        Parameters::Register<Parameters::IntensiveQuantityUpdateThreshold<Scalar>>
+            ("The weighted change of the primary variables of a degree of freedom up to "
+             "which its cached intensive quantities are not recalculated after a Newton "
+             "update");
         Parameters::Register<Parameters::OutputDir>
             ("The directory to which result files are written");
     }
@@ -658,18 +665,42 @@ public:
             return nullptr;
         }
 
-        // With the storage cache enabled, usually only the
-        // intensive quantities for the most recent time step are
-        // cached. However, this may be false for some Problem
-        // variants, so we should check if the cache exists for
-        // the timeIdx in question.
-        if (timeIdx > 0 && enableStorageCache_ && intensiveQuantityCache_[timeIdx].empty()) {
+        // entries which have not been touched since the last time level shift are
+        // identical to the ones of the next older time level
+        if (intensiveQuantityCacheUpToDate_[timeIdx][globalIdx] == sharedCacheEntry_)
+            ++timeIdx;
+
+        // With the storage cache enabled, only the intensive quantities for the most
+        // recent time step are cached. The previous time steps are represented by
+        // their storage terms.
+        if (intensiveQuantityCache_[timeIdx].empty()) {
             return nullptr;
         }
 
         return &intensiveQuantityCache_[timeIdx][globalIdx];
     }
 
+    /*!
+     * \brief Return the intensive quantities for a entity on the grid at given time.
+     *
+     * In contrast to cachedIntensiveQuantities(), the intensive quantities must be
+     * available, i.e., they need to be updated beforehand, e.g., by
+     * updateIntensiveQuantities().
+     *
+     * \param globalIdx The global space index for the entity.
+     * \param timeIdx The index used by the time discretization.
+     */
+    const IntensiveQuantities& intensiveQuantities(unsigned globalIdx, unsigned timeIdx) const
+    {
+        const auto* intQuants = cachedIntensiveQuantities(globalIdx, timeIdx);
+        if (!intQuants) {
+            throw std::logic_error("The intensive quantities of degree of freedom "
+                                   + std::to_string(globalIdx) + " for time index "
+                                   + std::to_string(timeIdx) + " are not cached");
+        }
+        return *intQuants;
+    }
+
     /*!
      * \brief Update the intensive quantity cache for a entity on the grid at given time.
      *
@@ -682,7 +713,7 @@ public:
                                          unsigned globalIdx,
                                          unsigned timeIdx) const
     {
-        if (!storeIntensiveQuantities())
+        if (!storeIntensiveQuantities() || intensiveQuantityCache_[timeIdx].empty())
             return;
 
         intensiveQuantityCache_[timeIdx][globalIdx] = intQuants;
@@ -703,7 +734,11 @@ public:
         if (!storeIntensiveQuantities())
             return;
 
-        intensiveQuantityCacheUpToDate_[timeIdx][globalIdx] = newValue ? 1 : 0;
+        auto& upToDate = intensiveQuantityCacheUpToDate_[timeIdx][globalIdx];
+        if (!newValue)
+            upToDate = 0;
+        else if (!upToDate)
+            upToDate = 1;
     }
 
     /*!
@@ -720,24 +755,47 @@ public:
         }
     }
 
+    /*!
+     * \brief Recalculate the intensive quantities of all degrees of freedom.
+     *
+     * \param timeIdx The index used by the time discretization.
+     */
     void invalidateAndUpdateIntensiveQuantities(unsigned timeIdx) const
     {
         invalidateIntensiveQuantitiesCache(timeIdx);
+        updateIntensiveQuantities(timeIdx);
+    }
 
-        // loop over all elements...
-        ThreadedEntityIterator<GridView, /*codim=*/0> threadedElemIt(gridView_);
-#ifdef _OPENMP
-#pragma omp parallel
-#endif
-        {
-            ElementContext elemCtx(simulator_);
-            ElementIterator elemIt = threadedElemIt.beginParallel();
-            for (; !threadedElemIt.isFinished(elemIt); elemIt = threadedElemIt.increment()) {
-                const Element& elem = *elemIt;
-                elemCtx.updatePrimaryStencil(elem);
-                elemCtx.updatePrimaryIntensiveQuantities(timeIdx);
-            }
+    /*!
+     * \brief Recalculate the intensive quantities of all degrees of freedom whose cache
+     *        entries are invalid.
+     *
+     * In contrast to invalidateAndUpdateIntensiveQuantities(), the cache entries which
+     * are still valid are kept. After a Newton update, these are the ones of the degrees
+     * of freedom which did not change (see FvBaseNewtonMethod::update_()), after a failed
+     * update the ones which did not need to be reset (see updateFailed()).
+     *
+     * \param timeIdx The index used by the time discretization.
+     */
+    void updateIntensiveQuantities(unsigned timeIdx) const
+    {
+        // avoid the loop over the grid if all cache entries are valid
+        if (enableIntensiveQuantityCache_ && !intensiveQuantityCache_[timeIdx].empty()) {
+            const auto& upToDate = intensiveQuantityCacheUpToDate_[timeIdx];
+            if (std::all_of(upToDate.begin(), upToDate.end(), [](auto entry) { return entry != 0; }))
+                return;
         }
+
+        std::vector<std::unique_ptr<ElementContext>> elemCtx(ThreadManager::maxThreads());
+        elementChunks().forEachParallel([&](const Element& elem, unsigned threadId)
+        {
+            if (!elemCtx[threadId])
+                elemCtx[threadId] = std::make_unique<ElementContext>(simulator_);
+
+            // cached intensive quantities are only referenced by the context
+            elemCtx[threadId]->updatePrimaryStencil(elem);
+            elemCtx[threadId]->updatePrimaryIntensiveQuantities(timeIdx);
+        });
     }
 
     template <class GridViewType>
@@ -783,28 +841,116 @@ public:
         if (!storeIntensiveQuantities())
             return;
 
-        if (enableStorageCache() && simulator_.problem().recycleFirstIterationStorage()) {
+        if (intensiveQuantityCache_[/*timeIdx=*/1].empty()) {
             // If the storage term is cached, the intensive quantities of the previous
-            // time steps do not need to be accessed, and we can thus spare ourselves to
-            // copy the objects for the intensive quantities.
-            // However, if the storage term at the start of the timestep cannot be deduced
-            // from the primary variables, we must calculate it from the old intensive
-            // quantities, and need to shift them.
+            // time steps are not kept: The linearizers either use the storage term of
+            // the first iteration of the time step, or the values of the storage term
+            // which are captured by captureHistoryStorage().
             return;
         }
 
         assert(numSlots > 0);
 
-        for (unsigned timeIdx = 0; timeIdx < historySize - numSlots; ++ timeIdx) {
-            intensiveQuantityCache_[timeIdx + numSlots] = intensiveQuantityCache_[timeIdx];
-            intensiveQuantityCacheUpToDate_[timeIdx + numSlots] = intensiveQuantityCacheUpToDate_[timeIdx];
+        if (numSlots > 1) {
+            for (unsigned timeIdx = 0; timeIdx < historySize - numSlots; ++ timeIdx) {
+                intensiveQuantityCache_[timeIdx + numSlots] = intensiveQuantityCache_[timeIdx];
+                intensiveQuantityCacheUpToDate_[timeIdx + numSlots] = intensiveQuantityCacheUpToDate_[timeIdx];
+            }
+            return;
+        }
+
+        // entries of the most recent time index which still refer to the ones of the
+        // previous time step need to be resolved before the slots are rotated. Usually,
+        // there are no such entries because the Newton method recalculates everything.
+        auto& upToDate0 = intensiveQuantityCacheUpToDate_[/*timeIdx=*/0];
+        for (std::size_t globalIdx = 0; globalIdx < upToDate0.size(); ++globalIdx) {
+            if (upToDate0[globalIdx] == sharedCacheEntry_) {
+                intensiveQuantityCache_[/*timeIdx=*/0][globalIdx] =
+                    intensiveQuantityCache_[/*timeIdx=*/1][globalIdx];
+                upToDate0[globalIdx] = 1;
+            }
+        }
+
+        // rotate the slots instead of copying the objects: the most recent
+        // intensive quantities become the ones of the previous time index, while
+        // the memory of the oldest ones gets recycled for time index 0.
+        for (unsigned timeIdx = historySize - 1; timeIdx > 0; --timeIdx) {
+            intensiveQuantityCache_[timeIdx].swap(intensiveQuantityCache_[timeIdx - 1]);
+            intensiveQuantityCacheUpToDate_[timeIdx].swap(intensiveQuantityCacheUpToDate_[timeIdx - 1]);
         }
 
         // the cache for the most recent time indices do not need to be invalidated
         // because the solution for them did not change (TODO: that assumes that there is
-        // no post-processing of the solution after a time step! fix it?)
+        // no post-processing of the solution after a time step! fix it?). Instead of
+        // copying them, the entries refer to the ones of the previous time index until
+        // they get updated.
+        const auto& upToDate1 = intensiveQuantityCacheUpToDate_[/*timeIdx=*/1];
+        std::transform(upToDate1.begin(), upToDate1.end(),
+                       intensiveQuantityCacheUpToDate_[/*timeIdx=*/0].begin(),
+                       [](unsigned char isValid)
+                       { return isValid ? sharedCacheEntry_ : static_cast<unsigned char>(0); });
+    }
+
+    /*!
+     * \brief Condense the converged solution of the current time step into the values
+     *        of its storage term.
+     *
+     * With the storage cache enabled, the intensive quantities of the previous time step
+     * are not kept. If the problem does not allow to recycle the storage term of the
+     * first iteration of a time step, the values of the storage term of the previous
+     * time step are used instead, which is all the linearizers need from them.
+     *
+     * These values may depend on state of the problem which is updated at the end of a
+     * time step (e.g., hysteresis or the maximum of a quantity). They are thus computed
+     * after the nonlinear solver has converged and before the problem's endTimeStep()
+     * method is called; advanceTimeLevel() turns them into the storage cache for time
+     * index 1. update() does this via updateSuccessful(), code which drives the
+     * nonlinear solver itself needs to call this method. Without the storage cache, this
+     * method makes sure that the intensive quantities which become the ones of the
+     * previous time step are cached at this point.
+     *
+     * This method must be called in a sequential context.
+     */
+    void captureHistoryStorage()
+    {
+        if (simulator_.problem().recycleFirstIterationStorage())
+            return;
+
+        if (!enableStorageCache_) {
+            if (storeIntensiveQuantities())
+                updateIntensiveQuantities(/*timeIdx=*/0);
+            return;
+        }
+
+        capturedHistoryStorage_.resize(asImp_().numGridDof());
+        computeStorageValues_(capturedHistoryStorage_, /*timeIdx=*/0);
+        haveCapturedHistoryStorage_ = true;
+    }
+
+    /*!
+     * \brief Compute the storage term of the previous time step from its solution.
+     *
+     * This is the fallback of the linearizers if the values of the storage term of the
+     * previous time step were not captured at its end (see captureHistoryStorage()),
+     * i.e., for the first time step and after restarts. The result is stored in the
+     * storage cache for time index 1. This method must be called in a sequential
+     * context.
+     */
+    void updateHistoryStorage()
+    {
+        assert(enableStorageCache_);
+
+        computeStorageValues_(storageCache_[/*timeIdx=*/1], /*timeIdx=*/1);
+        historyStorageUpToDate_ = true;
     }
 
+    /*!
+     * \brief Returns true iff the storage cache for time index 1 has been computed by
+     *        updateHistoryStorage() for the current solution of the previous time step.
+     */
+    bool historyStorageUpToDate() const
+    { return historyStorageUpToDate_; }
+
     /*!
      * \brief Returns true iff the storage term is cached.
      *
@@ -1336,14 +1482,14 @@ public:
      *        which the actual model can overload.
      */
     void updateBegin()
-    { }
+    { haveCapturedHistoryStorage_ = false; }
 
     /*!
      * \brief Called by the update() method if it was
      *        successful.
      */
     void updateSuccessful()
-    { }
+    { asImp_().captureHistoryStorage(); }
 
     /*!
      * \brief Called by the update() method when the grid should be refined.
@@ -1364,8 +1510,18 @@ public:
         // Reset the current solution to the one of the
         // previous time step so that we can start the next
         // update at a physically meaningful solution.
+        //
+        // Only the intensive quantities of the degrees of freedom which are actually
+        // reset need to be recalculated.
+        const auto& curSol = solution(/*timeIdx=*/0);
+        const auto& prevSol = solution(/*timeIdx=*/1);
+        for (unsigned dofIdx = 0; dofIdx < curSol.size(); ++dofIdx) {
+            if (!(curSol[dofIdx] == prevSol[dofIdx]))
+                setIntensiveQuantitiesCacheEntryValidity(dofIdx, /*timeIdx=*/0, false);
+        }
+
         solution(/*timeIdx=*/0) = solution(/*timeIdx=*/1);
-        invalidateAndUpdateIntensiveQuantities(/*timeIdx=*/0);
+        updateIntensiveQuantities(/*timeIdx=*/0);
 
 #ifndef NDEBUG
         for (unsigned timeIdx = 0; timeIdx < historySize; ++timeIdx) {
@@ -1392,12 +1548,25 @@ public:
             asImp_().adaptGrid();
         }
 
-        // make the current solution the previous one.
+        // make the current solution the previous one. note that this cannot be done by
+        // swapping because the current solution is also the initial guess for the
+        // Newton method of the next time step.
         solution(/*timeIdx=*/1) = solution(/*timeIdx=*/0);
 
         // shift the intensive quantities cache by one position in the
         // history
         asImp_().shiftIntensiveQuantityCache(/*numSlots=*/1);
+
+        // if the storage term of the first iteration cannot be used for the previous
+        // time step, use the values of the storage term which were captured before the
+        // time step was post-processed. its intensive quantities are not kept if the
+        // storage term is cached.
+        historyStorageUpToDate_ = false;
+        if (haveCapturedHistoryStorage_) {
+            storageCache_[/*timeIdx=*/1] = capturedHistoryStorage_;
+            historyStorageUpToDate_ = true;
+        }
+        haveCapturedHistoryStorage_ = false;
     }
 
     /*!
@@ -1433,11 +1602,12 @@ public:
      *        restart file.
      *
      * \param outstream The stream into which the vertex data should
-     *                  be serialized to
+     *                  be serialized to. This is either a std::ostream
+     *                  or a BinaryRestartOStream.
      * \param dof The Dune entity which's data should be serialized
      */
-    template <class DofEntity>
-    void serializeEntity(std::ostream& outstream,
+    template <class OutStream, class DofEntity>
+    void serializeEntity(OutStream& outstream,
                          const DofEntity& dof)
     {
         unsigned dofIdx = static_cast<unsigned>(asImp_().dofMapper().index(dof));
@@ -1458,11 +1628,12 @@ public:
      *        freedom from a restart file.
      *
      * \param instream The stream from which the vertex data should
-     *                  be deserialized from
+     *                  be deserialized from. This is either a std::istream
+     *                  or a BinaryRestartIStream.
      * \param dof The Dune entity which's data should be deserialized
      */
-    template <class DofEntity>
-    void deserializeEntity(std::istream& instream,
+    template <class InStream, class DofEntity>
+    void deserializeEntity(InStream& instream,
                            const DofEntity& dof)
     {
         unsigned dofIdx = static_cast<unsigned>(asImp_().dofMapper().index(dof));
@@ -1684,34 +1855,31 @@ public:
         }
 
         // iterate over grid
-        ThreadedEntityIterator<GridView, /*codim=*/0> threadedElemIt(gridView());
-#ifdef _OPENMP
-#pragma omp parallel
-#endif
+        std::vector<std::unique_ptr<ElementContext>> elemCtxs(ThreadManager::maxThreads());
+        elementChunks().forEachParallel([&](const Element& elem, unsigned threadId)
         {
-            ElementContext elemCtx(simulator_);
-            ElementIterator elemIt = threadedElemIt.beginParallel();
-            for (; !threadedElemIt.isFinished(elemIt); elemIt = threadedElemIt.increment()) {
-                const auto& elem = *elemIt;
-                if (elem.partitionType() != Dune::InteriorEntity)
-                    // ignore non-interior entities
-                    continue;
+            if (elem.partitionType() != Dune::InteriorEntity)
+                // ignore non-interior entities
+                return;
 
-                if (needFullContextUpdate)
-                    elemCtx.updateAll(elem);
-                else {
-                    elemCtx.updatePrimaryStencil(elem);
-                    elemCtx.updatePrimaryIntensiveQuantities(/*timeIdx=*/0);
-                }
+            if (!elemCtxs[threadId])
+                elemCtxs[threadId] = std::make_unique<ElementContext>(simulator_);
+            ElementContext& elemCtx = *elemCtxs[threadId];
 
-                // we cannot reuse the "modIt" variable here because the code here might
-                // be threaded and "modIt" is is the same for all threads, i.e., if a
-                // given thread modifies it, the changes affect all threads.
-                auto modIt2 = outputModules_.begin();
-                for (; modIt2 != modEndIt; ++modIt2)
-                    (*modIt2)->processElement(elemCtx);
+            if (needFullContextUpdate)
+                elemCtx.updateAll(elem);
+            else {
+                elemCtx.updatePrimaryStencil(elem);
+                elemCtx.updatePrimaryIntensiveQuantities(/*timeIdx=*/0);
             }
-        }
+
+            // we cannot reuse the "modIt" variable here because the code here might
+            // be threaded and "modIt" is is the same for all threads, i.e., if a
+            // given thread modifies it, the changes affect all threads.
+            auto modIt2 = outputModules_.begin();
+            for (; modIt2 != modEndIt; ++modIt2)
+                (*modIt2)->processElement(elemCtx);
+        });
     }
 
     /*!
@@ -1732,6 +1900,25 @@ public:
     const GridView& gridView() const
     { return gridView_; }
 
+    /*!
+     * \brief Returns the partition of the grid's elements into chunks for threaded
+     *        loops.
+     *
+     * The chunks are re-created if the grid has changed since the last call. This
+     * method must be called in a sequential context.
+     */
+    const ThreadedElementChunks<GridView>& elementChunks() const
+    {
+        const int curSeqNum = simulator_.vanguard().gridSequenceNumber();
+        if (!elementChunks_ || elementChunksSequenceNumber_ != curSeqNum) {
+            elementChunks_ = std::make_unique<ThreadedElementChunks<GridView>>(gridView_,
+                                                                               ThreadManager::maxThreads());
+            elementChunksSequenceNumber_ = curSeqNum;
+        }
+
+        return *elementChunks_;
+    }
+
     /*!
      * \brief Add a module for an auxiliary equation.
      *
@@ -1840,16 +2027,54 @@ protected:
             }
         }
 
+        historyStorageUpToDate_ = false;
+        haveCapturedHistoryStorage_ = false;
+
         // allocate the intensive quantities cache
         if (storeIntensiveQuantities()) {
             size_t numDof = asImp_().numGridDof();
             for(unsigned timeIdx=0; timeIdx<historySize; ++timeIdx) {
-                intensiveQuantityCache_[timeIdx].resize(numDof);
+                if (keepIntensiveQuantities_(timeIdx))
+                    intensiveQuantityCache_[timeIdx].resize(numDof);
                 intensiveQuantityCacheUpToDate_[timeIdx].resize(numDof);
                 invalidateIntensiveQuantitiesCache(timeIdx);
             }
         }
     }
+    // compute the values of the storage term for the solution of a time index
+    void computeStorageValues_(GlobalEqVector& storageValues, unsigned timeIdx)
+    {
+        std::vector<std::unique_ptr<ElementContext>> elemCtxs(ThreadManager::maxThreads());
+        elementChunks().forEachParallel([&](const Element& elem, unsigned threadId)
+        {
+            if (!elemCtxs[threadId]) {
+                elemCtxs[threadId] = std::make_unique<ElementContext>(simulator_);
+
+                // the storage term may be evaluated for a time index other than the
+                // most recent one
+                elemCtxs[threadId]->setEnableStorageCache(false);
+            }
+            ElementContext& elemCtx = *elemCtxs[threadId];
+
+            elemCtx.updatePrimaryStencil(elem);
+            elemCtx.updatePrimaryIntensiveQuantities(timeIdx);
+
+            EqVector storage;
+            const std::size_t numPrimaryDof = elemCtx.numPrimaryDof(timeIdx);
+            for (unsigned dofIdx = 0; dofIdx < numPrimaryDof; ++dofIdx) {
+                storage = 0.0;
+                localResidual(threadId).computeStorage(storage, elemCtx, dofIdx, timeIdx);
+                const unsigned globalIdx = elemCtx.globalSpaceIndex(dofIdx, timeIdx);
+                storageValues[globalIdx] = storage;
+            }
+        });
+    }
+
+    // returns true if the intensive quantities of a time index are cached. if the
+    // storage term is cached, only the most recent time index is needed.
+    bool keepIntensiveQuantities_(unsigned timeIdx) const
+    { return timeIdx == 0 || !enableStorageCache_; }
+
     template <class Context>
     void supplementInitialSolution_(PrimaryVariables&,
                                     const Context&,
@@ -1919,7 +2144,10 @@ protected:
     // solution of the previous time step
     mutable IntensiveQuantitiesVector intensiveQuantityCache_[historySize];
     // while these are logically bools, concurrent writes to vector<bool> are not thread safe.
+    // besides 0 (invalid) and 1 (valid), an entry can be sharedCacheEntry_, i.e. it is
+    // valid and identical to the entry of the next older time index.
     mutable std::vector<unsigned char> intensiveQuantityCacheUpToDate_[historySize];
+    static constexpr unsigned char sharedCacheEntry_ = 2;
 
     mutable std::array< std::unique_ptr< DiscreteFunction >, historySize > solution_;
 
@@ -1930,6 +2158,14 @@ protected:
     std::vector<bool> isLocalDof_;
 
     mutable GlobalEqVector storageCache_[historySize];
+    bool historyStorageUpToDate_ = false;
+    GlobalEqVector capturedHistoryStorage_;
+    bool haveCapturedHistoryStorage_ = false;
+
+    // the element partition used for threaded loops over the grid and the grid
+    // sequence number for which it was created
+    mutable std::unique_ptr<ThreadedElementChunks<GridView>> elementChunks_;
+    mutable int elementChunksSequenceNumber_ = -1;
 
     bool enableGridAdaptation_;
     bool enableIntensiveQuantityCache_;
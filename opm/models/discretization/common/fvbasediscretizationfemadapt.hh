@@ -29,12 +29,15 @@
 #define EWOMS_FV_BASE_DISCRETIZATION_FEMADAPT_HH
 
 #include <opm/models/discretization/common/fvbasediscretization.hh>
+#include <opm/models/discretization/common/rcmelementmapper.hh>
 
 #include <dune/fem/space/common/adaptationmanager.hh>
 #include <dune/fem/space/common/restrictprolongtuple.hh>
 #include <dune/fem/function/blockvectorfunction.hh>
 #include <dune/fem/misc/capabilities.hh>
 
+#include <type_traits>
+
 namespace Opm {
 
 template<class TypeTag>
@@ -66,6 +69,8 @@ template <class TypeTag>
 class FvBaseDiscretizationFemAdapt : public FvBaseDiscretization<TypeTag>
 {
     using Grid = GetPropType<TypeTag, Properties::Grid>;
+    using GridView = GetPropType<TypeTag, Properties::GridView>;
+    using ElementMapper = GetPropType<TypeTag, Properties::ElementMapper>;
     using ParentType = FvBaseDiscretization<TypeTag>;
     using PrimaryVariables = GetPropType<TypeTag, Properties::PrimaryVariables>;
     using Problem = GetPropType<TypeTag, Properties::Problem>;
@@ -88,6 +93,12 @@ class FvBaseDiscretizationFemAdapt : public FvBaseDiscretization<TypeTag>
     // adaptation classes
     using AdaptationManager = Dune::Fem::AdaptationManager<Grid, RestrictProlong>;
 
+    // the discrete functions are indexed by the grid's index set, so the degrees of
+    // freedom must not be renumbered
+    static_assert(!std::is_same_v<ElementMapper, RcmElementMapper<GridView>>,
+                  "The reverse Cuthill-McKee element mapper cannot be used by "
+                  "discretizations which store the solution in dune-fem discrete functions");
+
 public:
     template<class Serializer>
     struct SerializeHelper {
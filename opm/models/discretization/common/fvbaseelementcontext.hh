@@ -61,6 +61,10 @@ class FvBaseElementContext
     enum { timeDiscHistorySize = getPropValue<TypeTag, Properties::TimeDiscHistorySize>() };
 
     struct DofStore_ {
+        // the intensive quantities which are visible to the outside. this either points
+        // to the object owned by the discretization's intensive quantity cache or to
+        // the context's private copy below.
+        const IntensiveQuantities* intensiveQuantitiesPtr[timeDiscHistorySize];
         IntensiveQuantities intensiveQuantities[timeDiscHistorySize];
         const PrimaryVariables* priVars[timeDiscHistorySize];
         const IntensiveQuantities *thermodynamicHint[timeDiscHistorySize];
@@ -416,7 +420,7 @@ public:
                                    "for the most-recent substep (i.e. time index 0) are available!");
 #endif
 
-        return dofVars_[dofIdx].intensiveQuantities[timeIdx];
+        return *dofVars_[dofIdx].intensiveQuantitiesPtr[timeIdx];
     }
 
     /*!
@@ -434,11 +438,15 @@ public:
     }
     /*!
      * \copydoc intensiveQuantities()
+     *
+     * If the intensive quantities of the degree of freedom are taken from the cache of
+     * the discretization, they get copied into the context before a mutable reference
+     * is returned. Use the const version of this method if only read access is needed.
      */
     IntensiveQuantities& intensiveQuantities(unsigned dofIdx, unsigned timeIdx)
     {
         assert(dofIdx < numDof(timeIdx));
-        return dofVars_[dofIdx].intensiveQuantities[timeIdx];
+        return privateIntensiveQuantities_(dofIdx, timeIdx);
     }
 
     /*!
@@ -482,7 +490,7 @@ public:
     {
         assert(dofIdx < numDof(/*timeIdx=*/0));
 
-        intensiveQuantitiesStashed_ = dofVars_[dofIdx].intensiveQuantities[/*timeIdx=*/0];
+        intensiveQuantitiesStashed_ = *dofVars_[dofIdx].intensiveQuantitiesPtr[/*timeIdx=*/0];
         priVarsStashed_ = *dofVars_[dofIdx].priVars[/*timeIdx=*/0];
         stashedDofIdx_ = static_cast<int>(dofIdx);
     }
@@ -496,6 +504,7 @@ public:
     {
         dofVars_[dofIdx].priVars[/*timeIdx=*/0] = &priVarsStashed_;
         dofVars_[dofIdx].intensiveQuantities[/*timeIdx=*/0] = intensiveQuantitiesStashed_;
+        dofVars_[dofIdx].intensiveQuantitiesPtr[/*timeIdx=*/0] = &dofVars_[dofIdx].intensiveQuantities[/*timeIdx=*/0];
         stashedDofIdx_ = -1;
     }
 
@@ -543,7 +552,8 @@ protected:
     /*!
      * \brief Update the first 'n' intensive quantities objects from the primary variables.
      *
-     * This method considers the intensive quantities cache.
+     * This method considers the intensive quantities cache: Cached objects are not
+     * copied, the context only references them until they need to be modified.
      */
     void updateIntensiveQuantities_(unsigned timeIdx, size_t numDof)
     {
@@ -561,7 +571,7 @@ protected:
 
             const auto *cachedIntQuants = model().cachedIntensiveQuantities(globalIdx, timeIdx);
             if (cachedIntQuants) {
-                dofVars_[dofIdx].intensiveQuantities[timeIdx] = *cachedIntQuants;
+                dofVars_[dofIdx].intensiveQuantitiesPtr[timeIdx] = cachedIntQuants;
             }
             else {
                 updateSingleIntQuants_(dofSol, dofIdx, timeIdx);
@@ -581,7 +591,29 @@ protected:
 #endif
 
         dofVars_[dofIdx].priVars[timeIdx] = &priVars;
-        dofVars_[dofIdx].intensiveQuantities[timeIdx].update(/*context=*/asImp_(), dofIdx, timeIdx);
+
+        // the result of the update is always stored by the context itself
+        auto& intQuants = dofVars_[dofIdx].intensiveQuantities[timeIdx];
+        dofVars_[dofIdx].intensiveQuantitiesPtr[timeIdx] = &intQuants;
+        intQuants.update(/*context=*/asImp_(), dofIdx, timeIdx);
+    }
+
+    /*!
+     * \brief Return the context's own copy of the intensive quantities of a DOF.
+     *
+     * If the DOF currently refers to the intensive quantity cache of the discretization,
+     * the cached object is copied first.
+     */
+    IntensiveQuantities& privateIntensiveQuantities_(unsigned dofIdx, unsigned timeIdx)
+    {
+        auto& dofVars = dofVars_[dofIdx];
+        IntensiveQuantities& intQuants = dofVars.intensiveQuantities[timeIdx];
+        if (dofVars.intensiveQuantitiesPtr[timeIdx] != &intQuants) {
+            intQuants = *dofVars.intensiveQuantitiesPtr[timeIdx];
+            dofVars.intensiveQuantitiesPtr[timeIdx] = &intQuants;
+        }
+
+        return intQuants;
     }
 
     IntensiveQuantities intensiveQuantitiesStashed_;
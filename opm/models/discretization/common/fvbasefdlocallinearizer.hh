@@ -258,6 +258,26 @@ public:
         }
     }
 
+    /*!
+     * \brief Evaluate the residual of an element without computing its local Jacobian
+     *        matrix.
+     *
+     * \param elemCtx The element execution context for which the local residual should
+     *                be calculated.
+     */
+    void linearizeResidual(ElementContext& elemCtx, const Element& elem)
+    {
+        elemCtx.updateAll(elem);
+
+        // update the weights of the primary variables for the context
+        model_().updatePVWeights(elemCtx);
+
+        resize_(elemCtx);
+        reset_(elemCtx);
+
+        localResidual_.eval(residual_, elemCtx);
+    }
+
     /*!
      * \brief Returns the unweighted epsilon value used to calculate
      *        the local derivatives
@@ -38,20 +38,38 @@
 #include <opm/models/parallel/gridcommhandles.hh>
 #include <opm/models/parallel/threadmanager.hh>
 #include <opm/models/parallel/threadedentityiterator.hh>
+#include <opm/models/parallel/threadedelementchunks.hh>
 #include <opm/models/discretization/common/baseauxiliarymodule.hh>
+#include <opm/models/utils/parametersystem.hh>
+#include <opm/simulators/linalg/sparsitypattern.hh>
 
 #include <dune/common/version.hh>
 #include <dune/common/fvector.hh>
 #include <dune/common/fmatrix.hh>
 
+#include <cstddef>
 #include <type_traits>
 #include <iostream>
+#include <memory>
 #include <vector>
 #include <thread>
-#include <set>
+#include <utility>
 #include <exception>   // current_exception, rethrow_exception
 #include <mutex>
 
+namespace Opm::Parameters {
+
+/*!
+ * \brief Linearize the elements in groups which do not share any degree of freedom.
+ *
+ * The elements of each group ("color") are linearized in parallel without locking
+ * the global matrix. This only has an effect for discretizations which would
+ * otherwise need to serialize the assembly (i.e., if UseLinearizationLock is set).
+ */
+struct EnableColoredLinearization { static constexpr bool value = false; };
+
+} // namespace Opm::Parameters
+
 namespace Opm {
 // forward declarations
 template<class TypeTag>
@@ -107,6 +125,9 @@ class FvBaseLinearizer
     using VectorBlock = Dune::FieldVector<Scalar, numEq>;
 
     static const bool linearizeNonLocalElements = getPropValue<TypeTag, Properties::LinearizeNonLocalElements>();
+    static const bool useLinearizationLock = getPropValue<TypeTag, Properties::UseLinearizationLock>();
+
+    using ElementSeed = typename Element::EntitySeed;
 
     // copying the linearizer is not a good idea
     FvBaseLinearizer(const FvBaseLinearizer&);
@@ -117,6 +138,7 @@ public:
         : jacobian_()
     {
         simulatorPtr_ = 0;
+        enableColoredLinearization_ = Parameters::Get<Parameters::EnableColoredLinearization>();
     }
 
     ~FvBaseLinearizer()
@@ -131,7 +153,11 @@ public:
      * \brief Register all run-time parameters for the Jacobian linearizer.
      */
     static void registerParameters()
-    { }
+    {
+        Parameters::Register<Parameters::EnableColoredLinearization>
+            ("Linearize groups of elements which do not share degrees of freedom in "
+             "parallel instead of locking the global matrix");
+    }
 
     /*!
      * \brief Initialize the linearizer.
@@ -153,6 +179,8 @@ public:
         }
         elementCtx_.resize(0);
         fullDomain_ = std::make_unique<FullDomain>(simulator.gridView());
+        elementColors_.clear();
+        coloringSequenceNumber_ = -1;
     }
 
     /*!
@@ -240,6 +268,59 @@ public:
             throw NumericalProblem("A process did not succeed in linearizing the system");
     }
 
+    /*!
+     * \brief Evaluate the residual of the spatial domain for the current solution
+     *        without updating the Jacobian matrix.
+     *
+     * This assumes that the Jacobian has been linearized at least once, and that the
+     * caller keeps using its previous values.
+     */
+    void linearizeResidual()
+    {
+        OPM_TIMEBLOCK(linearizeResidual);
+        if (!jacobian_)
+            initFirstIteration_();
+
+        residual_ = 0.0;
+
+        int succeeded;
+        try {
+            applyConstraintsToSolution_();
+
+            model_().elementChunks().forEachParallel([&](const Element& elem, unsigned)
+            {
+                if (!linearizeNonLocalElements && elem.partitionType() != Dune::InteriorEntity)
+                    return;
+
+                evalElementResidual_(elem);
+            });
+
+            // the residual of constraint degrees of freedom is zero
+            for (const auto& constraint : constraintsMap_)
+                residual_[constraint.first] = 0.0;
+
+            succeeded = 1;
+        }
+        catch (const std::exception& e)
+        {
+            std::cout << "rank " << simulator_().gridView().comm().rank()
+                      << " caught an exception while evaluating the residual:" << e.what()
+                      << "\n"  << std::flush;
+            succeeded = 0;
+        }
+        catch (...)
+        {
+            std::cout << "rank " << simulator_().gridView().comm().rank()
+                      << " caught an exception while evaluating the residual"
+                      << "\n"  << std::flush;
+            succeeded = 0;
+        }
+        succeeded = simulator_().gridView().comm().min(succeeded);
+
+        if (!succeeded)
+            throw NumericalProblem("A process did not succeed in evaluating the residual");
+    }
+
     void finalize()
     { jacobian_->finalize(); }
 
@@ -255,8 +336,8 @@ public:
 
         auto& model = model_();
         const auto& comm = simulator_().gridView().comm();
+        bool succeeded = true;
         for (unsigned auxModIdx = 0; auxModIdx < model.numAuxiliaryModules(); ++auxModIdx) {
-            bool succeeded = true;
             try {
                 model.auxiliaryModule(auxModIdx)->linearize(*jacobian_, residual_);
             }
@@ -267,7 +348,11 @@ public:
                           << " caught an exception while linearizing:" << e.what()
                           << "\n"  << std::flush;
             }
+        }
 
+        // the auxiliary modules are linearized independently of each other, so their
+        // status only needs to be communicated once
+        if (model.numAuxiliaryModules() > 0) {
             succeeded = comm.min(succeeded);
 
             if (!succeeded)
@@ -417,38 +502,58 @@ private:
     // Construct the BCRS matrix for the Jacobian of the residual function
     void createMatrix_()
     {
+        OPM_TIMEBLOCK(createMatrix);
         const auto& model = model_();
-        Stencil stencil(gridView_(), model_().dofMapper());
+        const std::size_t numDof = model.numTotalDof();
 
-        // for the main model, find out the global indices of the neighboring degrees of
-        // freedom of each primary degree of freedom
-        sparsityPattern_.clear();
-        sparsityPattern_.resize(model.numTotalDof());
+        // the additional neighbors and degrees of freedom caused by the auxiliary
+        // equations
+        std::vector<std::pair<unsigned, unsigned>> auxConnections;
+        size_t numAuxMod = model.numAuxiliaryModules();
+        for (unsigned auxModIdx = 0; auxModIdx < numAuxMod; ++auxModIdx)
+            model.auxiliaryModule(auxModIdx)->addConnections(auxConnections, numDof);
 
-        for (const auto& elem : elements(gridView_())) {
-            stencil.update(elem);
+        std::vector<std::unique_ptr<Stencil>> stencils(ThreadManager::maxThreads());
+        for (auto& stencil : stencils)
+            stencil = std::make_unique<Stencil>(gridView_(), model.dofMapper());
 
+        // for the main model, find out the global indices of the neighboring degrees of
+        // freedom of each primary degree of freedom. the first pass over the elements
+        // determines an upper bound for the number of neighbors, the second one adds
+        // them.
+        Linear::SparsityPattern sparsityPattern(numDof);
+        model.elementChunks().forEachParallel([&](const Element& elem, unsigned threadId)
+        {
+            Stencil& stencil = *stencils[threadId];
+            stencil.update(elem);
+            for (unsigned primaryDofIdx = 0; primaryDofIdx < stencil.numPrimaryDof(); ++primaryDofIdx)
+                sparsityPattern.reserveEntries(stencil.globalSpaceIndex(primaryDofIdx), stencil.numDof());
+        });
+        for (const auto& connection : auxConnections)
+            sparsityPattern.reserveEntries(connection.first, 1);
+
+        sparsityPattern.allocate();
+        model.elementChunks().forEachParallel([&](const Element& elem, unsigned threadId)
+        {
+            Stencil& stencil = *stencils[threadId];
+            stencil.update(elem);
             for (unsigned primaryDofIdx = 0; primaryDofIdx < stencil.numPrimaryDof(); ++primaryDofIdx) {
                 unsigned myIdx = stencil.globalSpaceIndex(primaryDofIdx);
 
-                for (unsigned dofIdx = 0; dofIdx < stencil.numDof(); ++dofIdx) {
-                    unsigned neighborIdx = stencil.globalSpaceIndex(dofIdx);
-                    sparsityPattern_[myIdx].insert(neighborIdx);
-                }
+                for (unsigned dofIdx = 0; dofIdx < stencil.numDof(); ++dofIdx)
+                    sparsityPattern.addEntry(myIdx, stencil.globalSpaceIndex(dofIdx));
             }
-        }
+        });
+        for (const auto& connection : auxConnections)
+            sparsityPattern.addEntry(connection.first, connection.second);
 
-        // add the additional neighbors and degrees of freedom caused by the auxiliary
-        // equations
-        size_t numAuxMod = model.numAuxiliaryModules();
-        for (unsigned auxModIdx = 0; auxModIdx < numAuxMod; ++auxModIdx)
-            model.auxiliaryModule(auxModIdx)->addNeighbors(sparsityPattern_);
+        sparsityPattern.finalize();
 
         // allocate raw matrix
         jacobian_.reset(new SparseMatrixAdapter(simulator_()));
 
         // create matrix structure based on sparsity pattern
-        jacobian_->reserve(sparsityPattern_);
+        jacobian_->reserve(sparsityPattern);
     }
 
     // reset the global linear system of equations.
@@ -532,6 +637,38 @@ private:
         // parallel block below. initialized to null to indicate no exception
         std::exception_ptr exceptionPtr = nullptr;
 
+        constexpr bool onFullDomain = std::is_same_v<SubDomainType, FullDomain>;
+        if (useLinearizationLock && enableColoredLinearization_ && onFullDomain) {
+            linearizeColored_();
+            applyConstraintsToLinearization_();
+            return;
+        }
+
+        if constexpr (onFullDomain) {
+            // relinearize the elements. the chunks hand out the elements to the
+            // threads without locking and the per-thread element contexts are
+            // selected by the thread index. the model and the problem get a chance to
+            // prefetch the data required to linearize the next element, but only if
+            // we need to consider it.
+            model_().elementChunks().forEachParallel([&](const Element& elem, unsigned)
+            {
+                if (!linearizeNonLocalElements && elem.partitionType() != Dune::InteriorEntity)
+                    return;
+
+                linearizeElement_(elem);
+            },
+            [&](const Element& nextElem)
+            {
+                if (linearizeNonLocalElements || nextElem.partitionType() == Dune::InteriorEntity) {
+                    model_().prefetch(nextElem);
+                    problem_().prefetch(nextElem);
+                }
+            });
+
+            applyConstraintsToLinearization_();
+            return;
+        }
+
         // relinearize the elements...
         using GridViewType = decltype(domain.view);
         ThreadedEntityIterator<GridViewType, /*codim=*/0> threadedElemIt(domain.view);
@@ -589,10 +726,90 @@ private:
         applyConstraintsToLinearization_();
     }
 
+    // linearize all elements of the process, one color at a time. Since the elements
+    // of a color do not share any primary degree of freedom, they can be scattered into
+    // the global system without holding the matrix lock.
+    void linearizeColored_()
+    {
+        OPM_TIMEBLOCK(linearizeColored);
+
+        const int curSeqNum = simulator_().vanguard().gridSequenceNumber();
+        if (coloringSequenceNumber_ != curSeqNum || elementColors_.empty()) {
+            createElementColoring_();
+            coloringSequenceNumber_ = curSeqNum;
+        }
+
+        std::mutex exceptionLock;
+        std::exception_ptr exceptionPtr = nullptr;
+
+        const auto& grid = gridView_().grid();
+        for (unsigned colorIdx = 0; colorIdx < elementColors_.size(); ++colorIdx) {
+            const auto& seeds = elementColors_[colorIdx];
+            const int numElems = seeds.size();
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+            for (int i = 0; i < numElems; ++i) {
+                try {
+                    const auto elem = grid.entity(seeds[i]);
+                    model_().prefetch(elem);
+                    problem_().prefetch(elem);
+                    linearizeElement_(elem, /*lockMatrix=*/false);
+                }
+                catch(...) {
+                    std::lock_guard<std::mutex> take(exceptionLock);
+                    exceptionPtr = std::current_exception();
+                }
+            }
+
+            if (exceptionPtr)
+                std::rethrow_exception(exceptionPtr);
+        }
+    }
+
+    // group the elements of the process such that no two elements of a group share a
+    // primary degree of freedom. This uses a greedy algorithm, i.e., each element gets
+    // the smallest color not yet taken by an element that it shares a DOF with.
+    void createElementColoring_()
+    {
+        OPM_TIMEBLOCK(createElementColoring);
+
+        Stencil stencil(gridView_(), dofMapper_());
+        std::vector<std::vector<unsigned>> colorsOfDof(model_().numTotalDof());
+        std::vector<bool> colorTaken;
+
+        elementColors_.clear();
+        for (const auto& elem : elements(gridView_())) {
+            if (!linearizeNonLocalElements && elem.partitionType() != Dune::InteriorEntity)
+                continue;
+
+            stencil.update(elem);
+
+            colorTaken.assign(elementColors_.size() + 1, false);
+            for (unsigned primaryDofIdx = 0; primaryDofIdx < stencil.numPrimaryDof(); ++primaryDofIdx) {
+                unsigned globI = stencil.globalSpaceIndex(primaryDofIdx);
+                for (unsigned color : colorsOfDof[globI])
+                    colorTaken[color] = true;
+            }
+
+            unsigned color = 0;
+            while (colorTaken[color])
+                ++color;
+
+            for (unsigned primaryDofIdx = 0; primaryDofIdx < stencil.numPrimaryDof(); ++primaryDofIdx) {
+                unsigned globI = stencil.globalSpaceIndex(primaryDofIdx);
+                colorsOfDof[globI].push_back(color);
+            }
+
+            if (elementColors_.size() <= color)
+                elementColors_.resize(color + 1);
+            elementColors_[color].push_back(elem.seed());
+        }
+    }
 
     // linearize an element in the interior of the process' grid partition
     template <class ElementType>
-    void linearizeElement_(const ElementType& elem)
+    void linearizeElement_(const ElementType& elem, bool lockMatrix = useLinearizationLock)
     {
         unsigned threadId = ThreadManager::threadId();
 
@@ -603,7 +820,7 @@ private:
         localLinearizer.linearize(*elementCtx, elem);
 
         // update the right hand side and the Jacobian matrix
-        if (getPropValue<TypeTag, Properties::UseLinearizationLock>())
+        if (lockMatrix)
             globalMatrixMutex_.lock();
 
         size_t numPrimaryDof = elementCtx->numPrimaryDof(/*timeIdx=*/0);
@@ -621,7 +838,31 @@ private:
             }
         }
 
-        if (getPropValue<TypeTag, Properties::UseLinearizationLock>())
+        if (lockMatrix)
+            globalMatrixMutex_.unlock();
+    }
+
+    // add the local residual of an element to the global one without touching the
+    // Jacobian matrix
+    template <class ElementType>
+    void evalElementResidual_(const ElementType& elem)
+    {
+        unsigned threadId = ThreadManager::threadId();
+
+        ElementContext *elementCtx = elementCtx_[threadId];
+        auto& localLinearizer = model_().localLinearizer(threadId);
+        localLinearizer.linearizeResidual(*elementCtx, elem);
+
+        if (useLinearizationLock)
+            globalMatrixMutex_.lock();
+
+        size_t numPrimaryDof = elementCtx->numPrimaryDof(/*timeIdx=*/0);
+        for (unsigned primaryDofIdx = 0; primaryDofIdx < numPrimaryDof; ++ primaryDofIdx) {
+            unsigned globI = elementCtx->globalSpaceIndex(/*spaceIdx=*/primaryDofIdx, /*timeIdx=*/0);
+            residual_[globI] += localLinearizer.residual(primaryDofIdx);
+        }
+
+        if (useLinearizationLock)
             globalMatrixMutex_.unlock();
     }
 
@@ -695,7 +936,11 @@ private:
 
     std::mutex globalMatrixMutex_;
 
-    std::vector<std::set<unsigned int>> sparsityPattern_;
+    // the seeds of the elements of each color for the lock-free linearization, and
+    // the grid sequence number for which they were determined
+    bool enableColoredLinearization_ = false;
+    std::vector<std::vector<ElementSeed>> elementColors_;
+    int coloringSequenceNumber_ = -1;
 
     struct FullDomain
     {
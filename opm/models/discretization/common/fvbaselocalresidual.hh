@@ -43,6 +43,7 @@
 #include <dune/common/classname.hh>
 
 #include <cmath>
+#include <utility>
 
 namespace Opm {
 /*!
@@ -501,8 +502,9 @@ protected:
         // evaluate the volumetric terms (storage + source terms)
         size_t numPrimaryDof = elemCtx.numPrimaryDof(/*timeIdx=*/0);
         for (unsigned dofIdx=0; dofIdx < numPrimaryDof; dofIdx++) {
+            // use read-only access to avoid copying cached intensive quantities
             Scalar extrusionFactor =
-                elemCtx.intensiveQuantities(dofIdx, /*timeIdx=*/0).extrusionFactor();
+                std::as_const(elemCtx).intensiveQuantities(dofIdx, /*timeIdx=*/0).extrusionFactor();
             Valgrind::CheckDefined(extrusionFactor);
             assert(isfinite(extrusionFactor));
             assert(extrusionFactor > 0.0);
@@ -536,12 +538,15 @@ protected:
                 const auto& model = elemCtx.model();
                 unsigned globalDofIdx = elemCtx.globalSpaceIndex(dofIdx, /*timeIdx=*/0);
                 if (model.newtonMethod().numIterations() == 0 &&
-                    !elemCtx.haveStashedIntensiveQuantities())
+                    !elemCtx.haveStashedIntensiveQuantities() &&
+                    !model.historyStorageUpToDate())
                 {
                     if (!elemCtx.problem().recycleFirstIterationStorage()) {
                         // we re-calculate the storage term for the solution of the
                         // previous time step from scratch instead of using the one of
-                        // the first iteration of the current time step.
+                        // the first iteration of the current time step. (this is only
+                        // necessary if the model did not capture it at the end of the
+                        // previous time step.)
                         tmp2 = 0.0;
                         elemCtx.updatePrimaryIntensiveQuantities(/*timeIdx=*/1);
                         asImp_().computeStorage(tmp2, elemCtx,  dofIdx, /*timeIdx=*/1);
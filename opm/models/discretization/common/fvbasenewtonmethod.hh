@@ -30,9 +30,15 @@
 
 #include "fvbasenewtonconvergencewriter.hh"
 
+#include <opm/models/discretization/common/fvbaseparameters.hh>
 #include <opm/models/nonlinear/newtonmethod.hh>
+#include <opm/models/utils/parametersystem.hh>
 #include <opm/models/utils/propertysystem.hh>
 
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
 namespace Opm {
 
 template <class TypeTag>
@@ -94,10 +100,13 @@ class FvBaseNewtonMethod : public NewtonMethod<TypeTag>
     using PrimaryVariables = GetPropType<TypeTag, Properties::PrimaryVariables>;
     using EqVector = GetPropType<TypeTag, Properties::EqVector>;
 
+    enum { numEq = getPropValue<TypeTag, Properties::NumEq>() };
+
 
 public:
     FvBaseNewtonMethod(Simulator& simulator)
         : ParentType(simulator)
+        , intQuantsUpdateThreshold_(Parameters::Get<Parameters::IntensiveQuantityUpdateThreshold<Scalar>>())
     { }
 
 protected:
@@ -127,16 +136,84 @@ protected:
     {
         ParentType::update_(nextSolution, currentSolution, solutionUpdate, currentResidual);
 
-        // make sure that the intensive quantities get recalculated at the next
-        // linearization
+        // make sure that the intensive quantities of the degrees of freedom which have
+        // changed get recalculated at the next linearization
         if (model_().storeIntensiveQuantities()) {
-            for (unsigned dofIdx = 0; dofIdx < model_().numGridDof(); ++dofIdx)
+            const int numGridDof = static_cast<int>(model_().numGridDof());
+            if (intQuantsUpdateThreshold_ > 0.0)
+                accumulatedChange_.resize(numGridDof, 0.0);
+
+            // the degrees of freedom are independent of each other: each iteration
+            // only touches its own accumulated change and cache entry
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+            for (int dofIdx = 0; dofIdx < numGridDof; ++dofIdx) {
+                if (!priVarsChanged_(dofIdx, nextSolution[dofIdx], currentSolution[dofIdx]))
+                    continue;
+
                 model_().setIntensiveQuantitiesCacheEntryValidity(dofIdx,
                                                                   /*timeIdx=*/0,
                                                                   /*valid=*/false);
+            }
         }
     }
 
+    /*!
+     * \brief Returns true if the meaning of the primary variables of a degree of
+     *        freedom differs between two solutions.
+     *
+     * The comparison operator of the primary variables does not necessarily take
+     * their meaning into account, so models which switch primary variables must
+     * overload this method. By default, the meaning never changes.
+     */
+    bool primaryVarsMeaningChanged_(const PrimaryVariables& /*nextValue*/,
+                                    const PrimaryVariables& /*currentValue*/) const
+    { return false; }
+
+    /*!
+     * \brief Returns true if the intensive quantities of a degree of freedom need to be
+     *        recalculated after its primary variables have been updated.
+     *
+     * This is the case if the meaning of the primary variables has changed, or if the
+     * accumulated weighted change of their values since the intensive quantities were
+     * last recalculated exceeds the IntensiveQuantityUpdateThreshold parameter.
+     */
+    bool priVarsChanged_(unsigned globalDofIdx,
+                         const PrimaryVariables& nextValue,
+                         const PrimaryVariables& currentValue)
+    {
+        const bool useThreshold = intQuantsUpdateThreshold_ > 0.0;
+        if (asImp_().primaryVarsMeaningChanged_(nextValue, currentValue)) {
+            if (useThreshold)
+                accumulatedChange_[globalDofIdx] = 0.0;
+            return true;
+        }
+
+        bool valuesChanged = false;
+        for (unsigned pvIdx = 0; pvIdx < numEq && !valuesChanged; ++pvIdx)
+            valuesChanged = nextValue[pvIdx] != currentValue[pvIdx];
+
+        if (!valuesChanged)
+            return false;
+        else if (!useThreshold)
+            return true;
+
+        Scalar change = 0.0;
+        for (unsigned pvIdx = 0; pvIdx < numEq; ++pvIdx) {
+            const Scalar weight = model_().primaryVarWeight(globalDofIdx, pvIdx);
+            change = std::max(change, std::abs(nextValue[pvIdx] - currentValue[pvIdx])*weight);
+        }
+
+        Scalar& accumulatedChange = accumulatedChange_[globalDofIdx];
+        accumulatedChange += change;
+        if (accumulatedChange <= intQuantsUpdateThreshold_)
+            return false;
+
+        accumulatedChange = 0.0;
+        return true;
+    }
+
     /*!
      * \brief Indicates the beginning of a Newton iteration.
      */
@@ -165,6 +242,12 @@ private:
 
     const Implementation& asImp_() const
     { return *static_cast<const Implementation*>(this); }
+
+    Scalar intQuantsUpdateThreshold_;
+
+    // the weighted change of the primary variables of each degree of freedom since its
+    // intensive quantities were invalidated. only used for thresholds larger than zero.
+    std::vector<Scalar> accumulatedChange_;
 };
 } // namespace Opm
 
@@ -97,6 +97,18 @@ struct EnableThermodynamicHints { static constexpr bool value = false; };
  */
 struct EnableVtkOutput { static constexpr bool value = true; };
 
+/*!
+ * \brief The change of the primary variables of a degree of freedom up to which its
+ *        cached intensive quantities are kept after a Newton update.
+ *
+ * The change is the accumulated maximum of the weighted updates of the primary
+ * variables since the intensive quantities were last computed (see
+ * FvBaseDiscretization::primaryVarWeight()). With the default of 0, only the
+ * intensive quantities of degrees of freedom which did not change at all are kept.
+ */
+template<class Scalar>
+struct IntensiveQuantityUpdateThreshold { static constexpr Scalar value = 0.0; };
+
 /*!
  * \brief Specify the maximum size of a time integration [s].
  *
@@ -156,6 +156,7 @@ public:
 
             defaultVtkWriter_ =
                 new VtkMultiWriter(asyncVtkOutput, gridView_, outputDir, asImp_().name());
+            defaultVtkWriter_->setElementMapper(elementMapper_);
         }
     }
 
@@ -309,8 +310,10 @@ public:
                 vertexMapper_.update();
 #endif
 
-        if (enableVtkOutput_())
+        if (enableVtkOutput_()) {
             defaultVtkWriter_->gridChanged();
+            defaultVtkWriter_->setElementMapper(elementMapper_);
+        }
     }
 
     /*!
@@ -0,0 +1,305 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ * \copydoc Opm::RcmElementMapper
+ */
+#ifndef EWOMS_RCM_ELEMENT_MAPPER_HH
+#define EWOMS_RCM_ELEMENT_MAPPER_HH
+
+#include <dune/common/version.hh>
+#include <dune/grid/common/mcmgmapper.hh>
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <vector>
+
+namespace Opm {
+
+/*!
+ * \ingroup FiniteVolumeDiscretizations
+ *
+ * \brief Maps the elements of a grid view to indices which are ordered by the reverse
+ *        Cuthill-McKee algorithm.
+ *
+ * The indices of the grid's index set often do not reflect the connectivity of the
+ * elements, e.g., for corner-point grids or after local refinement. This mapper
+ * renumbers the elements so that neighboring elements have nearby indices. All data
+ * which is indexed by the degrees of freedom, i.e., the solution vectors, the caches of
+ * the intensive quantities and of the storage terms as well as the rows of the Jacobian
+ * matrix, thus become more local in memory.
+ *
+ * For the element centered finite volume discretization, the mapper is enabled by
+ * setting the ElementMapper property:
+ *
+ * \code
+ * template<class TypeTag>
+ * struct ElementMapper<TypeTag, TTag::MyProblem>
+ * { using type = RcmElementMapper<GetPropType<TypeTag, Properties::GridView>>; };
+ * \endcode
+ *
+ * The ordering is deterministic, so all mappers for the same grid view agree. It must
+ * not be combined with discretizations which store the solution in dune-fem discrete
+ * functions, because these are indexed by the grid's index set.
+ */
+template <class GridView>
+class RcmElementMapper
+{
+    using GridMapper = Dune::MultipleCodimMultipleGeomTypeMapper<GridView>;
+    using Element = typename GridView::template Codim<0>::Entity;
+
+public:
+    using Index = typename GridMapper::Index;
+
+    RcmElementMapper(const GridView& gridView, const Dune::MCMGLayout& layout)
+        : gridView_(gridView)
+        , gridMapper_(gridView, layout)
+    {
+        // the mapper only deals with elements
+        assert(int(gridView.size(/*codim=*/0)) == int(gridMapper_.size()));
+        computeOrdering_();
+    }
+
+    /*!
+     * \brief Returns the index of an element.
+     */
+    Index index(const Element& element) const
+    { return newIndex_[gridMapper_.index(element)]; }
+
+    /*!
+     * \brief Returns the index of a sub-entity of an element.
+     *
+     * Since only elements are mapped, the co-dimension must be zero.
+     */
+    Index subIndex(const Element& element, int i, unsigned codim) const
+    {
+        assert(codim == 0);
+        return newIndex_[gridMapper_.subIndex(element, i, codim)];
+    }
+
+    /*!
+     * \brief Returns the total number of elements.
+     */
+    Index size() const
+    { return gridMapper_.size(); }
+
+    /*!
+     * \brief Returns true if an element is mapped and stores its index.
+     */
+    bool contains(const Element& element, Index& result) const
+    {
+        if (!gridMapper_.contains(element, result))
+            return false;
+        result = newIndex_[result];
+        return true;
+    }
+
+    /*!
+     * \brief Returns true if a sub-entity of an element is mapped and stores its index.
+     */
+    bool contains(const Element& element, int i, int cc, Index& result) const
+    {
+        if (!gridMapper_.contains(element, i, cc, result))
+            return false;
+        result = newIndex_[result];
+        return true;
+    }
+
+    /*!
+     * \brief Returns the index of an element in the grid's index set for a given
+     *        index of this mapper.
+     */
+    Index gridIndex(Index idx) const
+    { return oldIndex_[idx]; }
+
+    /*!
+     * \brief Recompute the ordering after the grid has changed.
+     */
+#if DUNE_VERSION_NEWER(DUNE_GRID, 2, 8)
+    void update(const GridView& gridView)
+    {
+        gridView_ = gridView;
+        gridMapper_.update(gridView);
+        computeOrdering_();
+    }
+#else
+    void update()
+    {
+        gridMapper_.update();
+        computeOrdering_();
+    }
+#endif
+
+private:
+    void computeOrdering_()
+    {
+        const std::size_t numElements = gridMapper_.size();
+
+        // the adjacency graph of the elements in compressed row storage
+        std::vector<std::size_t> rowStart(numElements + 1, 0);
+        for (const auto& elem : elements(gridView_)) {
+            const Index elemIdx = gridMapper_.index(elem);
+            for (const auto& intersection : intersections(gridView_, elem))
+                if (intersection.neighbor())
+                    ++rowStart[elemIdx + 1];
+        }
+        for (std::size_t i = 0; i < numElements; ++i)
+            rowStart[i + 1] += rowStart[i];
+
+        neighbors_.resize(rowStart.back());
+        std::vector<std::size_t> pos(rowStart.begin(), rowStart.end() - 1);
+        for (const auto& elem : elements(gridView_)) {
+            const Index elemIdx = gridMapper_.index(elem);
+            for (const auto& intersection : intersections(gridView_, elem))
+                if (intersection.neighbor())
+                    neighbors_[pos[elemIdx]++] = gridMapper_.index(intersection.outside());
+        }
+        rowStart_ = std::move(rowStart);
+
+        // visit the connected components starting with the nodes of lowest degree
+        std::vector<Index> byDegree(numElements);
+        for (std::size_t i = 0; i < numElements; ++i)
+            byDegree[i] = static_cast<Index>(i);
+        std::stable_sort(byDegree.begin(), byDegree.end(),
+                         [this](Index a, Index b) { return degree_(a) < degree_(b); });
+
+        oldIndex_.clear();
+        oldIndex_.reserve(numElements);
+        ordered_.assign(numElements, false);
+        distance_.assign(numElements, -1);
+        for (Index seed : byDegree) {
+            if (ordered_[seed])
+                continue;
+
+            const Index start = pseudoPeripheralNode_(seed);
+            cuthillMcKee_(start);
+        }
+        assert(oldIndex_.size() == numElements);
+
+        // reverse the Cuthill-McKee ordering
+        std::reverse(oldIndex_.begin(), oldIndex_.end());
+        newIndex_.resize(numElements);
+        for (std::size_t i = 0; i < numElements; ++i)
+            newIndex_[oldIndex_[i]] = static_cast<Index>(i);
+
+        // the graph is not needed anymore
+        neighbors_ = {};
+        rowStart_ = {};
+        ordered_ = {};
+        distance_ = {};
+    }
+
+    std::size_t degree_(Index elemIdx) const
+    { return rowStart_[elemIdx + 1] - rowStart_[elemIdx]; }
+
+    // find a node of large eccentricity in the connected component of a node using the
+    // algorithm of George and Liu
+    Index pseudoPeripheralNode_(Index seed)
+    {
+        Index node = seed;
+        int eccentricity = breadthFirstSearch_(node);
+        for (unsigned iter = 0; iter < maxPeripheralIterations_; ++iter) {
+            const Index candidate = lastLevelNode_;
+            const int candidateEccentricity = breadthFirstSearch_(candidate);
+            if (candidateEccentricity <= eccentricity)
+                break;
+
+            node = candidate;
+            eccentricity = candidateEccentricity;
+        }
+
+        return node;
+    }
+
+    // determine the distances of all nodes of a connected component from a node. The
+    // node of the last level which has the smallest degree is kept in lastLevelNode_.
+    int breadthFirstSearch_(Index start)
+    {
+        queue_.clear();
+        queue_.push_back(start);
+        distance_[start] = 0;
+        for (std::size_t head = 0; head < queue_.size(); ++head) {
+            const Index node = queue_[head];
+            for (std::size_t k = rowStart_[node]; k < rowStart_[node + 1]; ++k) {
+                const Index neighbor = neighbors_[k];
+                if (distance_[neighbor] < 0) {
+                    distance_[neighbor] = distance_[node] + 1;
+                    queue_.push_back(neighbor);
+                }
+            }
+        }
+
+        const int eccentricity = distance_[queue_.back()];
+        lastLevelNode_ = queue_.back();
+        for (Index node : queue_) {
+            if (distance_[node] == eccentricity && degree_(node) < degree_(lastLevelNode_))
+                lastLevelNode_ = node;
+            distance_[node] = -1;
+        }
+
+        return eccentricity;
+    }
+
+    // append the nodes of a connected component in Cuthill-McKee order
+    void cuthillMcKee_(Index start)
+    {
+        std::size_t head = oldIndex_.size();
+        oldIndex_.push_back(start);
+        ordered_[start] = true;
+        for (; head < oldIndex_.size(); ++head) {
+            const Index node = oldIndex_[head];
+            const std::size_t firstNew = oldIndex_.size();
+            for (std::size_t k = rowStart_[node]; k < rowStart_[node + 1]; ++k) {
+                const Index neighbor = neighbors_[k];
+                if (!ordered_[neighbor]) {
+                    ordered_[neighbor] = true;
+                    oldIndex_.push_back(neighbor);
+                }
+            }
+
+            std::stable_sort(oldIndex_.begin() + firstNew, oldIndex_.end(),
+                             [this](Index a, Index b) { return degree_(a) < degree_(b); });
+        }
+    }
+
+    static constexpr unsigned maxPeripheralIterations_ = 8;
+
+    GridView gridView_;
+    GridMapper gridMapper_;
+
+    std::vector<Index> newIndex_;
+    std::vector<Index> oldIndex_;
+
+    // scratch data which is only used while the ordering is computed
+    std::vector<std::size_t> rowStart_;
+    std::vector<Index> neighbors_;
+    std::vector<bool> ordered_;
+    std::vector<int> distance_;
+    std::vector<Index> queue_;
+    Index lastLevelNode_{};
+};
+
+} // namespace Opm
+
+#endif
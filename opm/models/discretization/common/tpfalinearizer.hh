@@ -37,24 +37,52 @@
 
 #include <opm/grid/utility/SparseTable.hpp>
 
-#include <opm/input/eclipse/EclipseState/Grid/FaceDir.hpp>
-#include <opm/input/eclipse/Schedule/BCProp.hpp>
+#include <opm/material/common/MathToolbox.hpp>
 
 #include <opm/models/discretization/common/baseauxiliarymodule.hh>
 #include <opm/models/discretization/common/fvbaseproperties.hh>
 #include <opm/models/discretization/common/linearizationtype.hh>
+#include <opm/models/parallel/threadmanager.hh>
+#include <opm/simulators/linalg/sparsitypattern.hh>
 
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
 #include <exception>   // current_exception, rethrow_exception
 #include <iostream>
+#include <memory>
 #include <numeric>
-#include <set>
+#include <stdexcept>
+#include <tuple>
 #include <type_traits>
+#include <utility>
 #include <vector>
 
 namespace Opm::Parameters {
 
 struct SeparateSparseSourceTerms { static constexpr bool value = false; };
 
+/*!
+ * \brief Only re-linearize the interior fluxes of the cells which are affected by
+ *        changes of the primary variables since the previous Newton iteration.
+ */
+struct EnableSelectiveLinearization { static constexpr bool value = false; };
+
+/*!
+ * \brief The weighted change of the primary variables of a cell up to which the cell
+ *        is considered to be unchanged by the selective linearization.
+ */
+template<class Scalar>
+struct SelectiveLinearizationThreshold { static constexpr Scalar value = 0.0; };
+
+/*!
+ * \brief The fraction of re-linearized cells above which the selective linearization
+ *        falls back to linearizing the whole domain.
+ */
+template<class Scalar>
+struct SelectiveLinearizationMaxFraction { static constexpr Scalar value = 0.5; };
+
 } // namespace Opm::Parameters
 
 namespace Opm {
@@ -71,6 +99,19 @@ class EcfvDiscretization;
  * This class assumes that these system of equations to be linearized are stemming from
  * models that use an finite volume scheme for spatial discretization and an Euler
  * scheme for time discretization.
+ *
+ * The model-specific parts are provided by static methods of the local residual, see
+ * BlackOilLocalResidualTPFA and ImmiscibleLocalResidualTPFA: Besides computeStorage(),
+ * computeFlux(), computeFluxValues(), computeSource(), computeSourceDense() and
+ * computeBoundaryFlux(), these are the ResidualNBInfo and BoundaryConditionData
+ * types, computeNeighborInfo(), updateNeighborInfo(), moduleParams(),
+ * needsVelocityInfo(), addSparseSourceTerms(), nonTrivialBoundaryConditions(),
+ * boundaryConditionData(), updateBoundaryConditionData(), hasBoundaryFlux(),
+ * flowsOutput(), anyFlowsOutput(), outputNncIndices() and cartesianIndex().
+ *
+ * The local residual obtains the geometry of the faces from the stencil, which is
+ * passed to computeNeighborInfo() and boundaryConditionData(). The intensive
+ * quantities are taken from the cache of the model, i.e., it must be enabled.
  */
 template<class TypeTag>
 class TpfaLinearizer
@@ -91,6 +132,7 @@ class TpfaLinearizer
     using Stencil = GetPropType<TypeTag, Properties::Stencil>;
     using LocalResidual = GetPropType<TypeTag, Properties::LocalResidual>;
     using IntensiveQuantities = GetPropType<TypeTag, Properties::IntensiveQuantities>;
+    using PrimaryVariables = GetPropType<TypeTag, Properties::PrimaryVariables>;
 
     using Element = typename GridView::template Codim<0>::Entity;
     using ElementIterator = typename GridView::template Codim<0>::Iterator;
@@ -101,13 +143,13 @@ class TpfaLinearizer
     enum { historySize = getPropValue<TypeTag, Properties::TimeDiscHistorySize>() };
     enum { dimWorld = GridView::dimensionworld };
 
+    using GlobalPosition = Dune::FieldVector<typename GridView::ctype, dimWorld>;
+
     using MatrixBlock = typename SparseMatrixAdapter::MatrixBlock;
     using VectorBlock = Dune::FieldVector<Scalar, numEq>;
     using ADVectorBlock = GetPropType<TypeTag, Properties::RateVector>;
 
     static const bool linearizeNonLocalElements = getPropValue<TypeTag, Properties::LinearizeNonLocalElements>();
-    static const bool enableEnergy = getPropValue<TypeTag, Properties::EnableEnergy>();
-    static const bool enableDiffusion = getPropValue<TypeTag, Properties::EnableDiffusion>();
 
     // copying the linearizer is not a good idea
     TpfaLinearizer(const TpfaLinearizer&) = delete;
@@ -119,6 +161,11 @@ public:
     {
         simulatorPtr_ = 0;
         separateSparseSourceTerms_ = Parameters::Get<Parameters::SeparateSparseSourceTerms>();
+        enableSelectiveLinearization_ = Parameters::Get<Parameters::EnableSelectiveLinearization>();
+        selectiveLinearizationThreshold_ =
+            Parameters::Get<Parameters::SelectiveLinearizationThreshold<Scalar>>();
+        selectiveLinearizationMaxFraction_ =
+            Parameters::Get<Parameters::SelectiveLinearizationMaxFraction<Scalar>>();
     }
 
     ~TpfaLinearizer()
@@ -132,6 +179,16 @@ public:
     {
         Parameters::Register<Parameters::SeparateSparseSourceTerms>
             ("Treat well source terms all in one go, instead of on a cell by cell basis.");
+        Parameters::Register<Parameters::EnableSelectiveLinearization>
+            ("Only re-linearize the fluxes of cells whose own or whose neighbors' primary "
+             "variables changed since the previous Newton iteration. This requires that "
+             "the Jacobian is not modified outside of the linearizer.");
+        Parameters::Register<Parameters::SelectiveLinearizationThreshold<Scalar>>
+            ("The maximum weighted change of the primary variables of a cell for which "
+             "the cell is considered to be unchanged by the selective linearization");
+        Parameters::Register<Parameters::SelectiveLinearizationMaxFraction<Scalar>>
+            ("The fraction of re-linearized cells above which the selective "
+             "linearization assembles the whole domain");
     }
 
     /*!
@@ -159,6 +216,7 @@ public:
     void eraseMatrix()
     {
         jacobian_.reset();
+        fluxCacheValid_ = false;
     }
 
     /*!
@@ -236,14 +294,61 @@ public:
         // Called here because it is no longer called from linearize_().
         if (domain.cells.size() == model_().numTotalDof()) {
             // We are on the full domain.
-            resetSystem_();
+            prepareFlowsCapture_(/*fullDomain=*/true);
+            reuseFluxes_ = enableSelectiveLinearization_ && markChangedCells_();
+            if (reuseFluxes_) {
+                numReusedCells_ += model_().numTotalDof() - numDirtyCells_;
+                resetChangedCells_();
+            }
+            else
+                resetSystem_();
         } else {
+            // the rows of the domain are cleared, which includes off-diagonal blocks
+            // which are owned by cells outside of the domain
+            fluxCacheValid_ = false;
+            prepareFlowsCapture_(/*fullDomain=*/false);
             resetSystem_(domain);
         }
 
         linearize_(domain);
     }
 
+    /*!
+     * \brief Evaluate the residual of the spatial domain for the current solution
+     *        without updating the Jacobian matrix.
+     *
+     * This assumes that the Jacobian has been linearized at least once, and that the
+     * caller keeps using its previous values.
+     */
+    void linearizeResidual()
+    {
+        int succeeded;
+        try {
+            if (!jacobian_)
+                initFirstIteration_();
+            linearizeResidual_();
+            succeeded = 1;
+        }
+        catch (const std::exception& e)
+        {
+            std::cout << "rank " << simulator_().gridView().comm().rank()
+                      << " caught an exception while evaluating the residual:" << e.what()
+                      << "\n"  << std::flush;
+            succeeded = 0;
+        }
+        catch (...)
+        {
+            std::cout << "rank " << simulator_().gridView().comm().rank()
+                      << " caught an exception while evaluating the residual"
+                      << "\n"  << std::flush;
+            succeeded = 0;
+        }
+        succeeded = simulator_().gridView().comm().min(succeeded);
+
+        if (!succeeded)
+            throw NumericalProblem("A process did not succeed in evaluating the residual");
+    }
+
     void finalize()
     { jacobian_->finalize(); }
 
@@ -259,8 +364,8 @@ public:
 
         auto& model = model_();
         const auto& comm = simulator_().gridView().comm();
+        bool succeeded = true;
         for (unsigned auxModIdx = 0; auxModIdx < model.numAuxiliaryModules(); ++auxModIdx) {
-            bool succeeded = true;
             try {
                 model.auxiliaryModule(auxModIdx)->linearize(*jacobian_, residual_);
             }
@@ -271,7 +376,11 @@ public:
                           << " caught an exception while linearizing:" << e.what()
                           << "\n"  << std::flush;
             }
+        }
 
+        // the auxiliary modules are linearized independently of each other, so their
+        // status only needs to be communicated once
+        if (model.numAuxiliaryModules() > 0) {
             succeeded = comm.min(succeeded);
 
             if (!succeeded)
@@ -342,19 +451,8 @@ public:
 
     void updateBoundaryConditionData() {
         for (auto& bdyInfo : boundaryInfo_) {
-            const auto [type, massrateAD] = problem_().boundaryCondition(bdyInfo.cell, bdyInfo.dir);
-
-            // Strip the unnecessary (and zero anyway) derivatives off massrate.
-            VectorBlock massrate(0.0);
-            for (size_t ii = 0; ii < massrate.size(); ++ii) {
-                massrate[ii] = massrateAD[ii].value();
-            }
-            if (type != BCType::NONE) {
-                const auto& exFluidState = problem_().boundaryFluidState(bdyInfo.cell, bdyInfo.dir);
-                bdyInfo.bcdata.type = type;
-                bdyInfo.bcdata.massRate = massrate;
-                bdyInfo.bcdata.exFluidState = exFluidState;
-            }
+            LocalResidual::updateBoundaryConditionData(bdyInfo.bcdata, problem_(),
+                                                       bdyInfo.cell, bdyInfo.dir);
         }
     }
 
@@ -366,6 +464,15 @@ public:
     const std::map<unsigned, Constraints> constraintsMap() const
     { return {}; }
 
+    /*!
+     * \brief Returns the number of times that the interior fluxes of a cell were reused
+     *        by the selective linearization instead of being re-linearized.
+     *
+     * The count is accumulated over all linearizations of the full domain.
+     */
+    std::size_t numReusedCells() const
+    { return numReusedCells_; }
+
     template <class SubDomainType>
     void resetSystem_(const SubDomainType& domain)
     {
@@ -414,108 +521,131 @@ private:
     void createMatrix_()
     {
         OPM_TIMEBLOCK(createMatrix);
-        if (!neighborInfo_.empty()) {
+        if (!faceTable_.empty()) {
             // It is ok to call this function multiple times, but it
             // should not do anything if already called.
             return;
         }
         const auto& model = model_();
-        Stencil stencil(gridView_(), model_().dofMapper());
+        const unsigned numCells = model.numTotalDof();
+
+        // the additional neighbors and degrees of freedom caused by the auxiliary
+        // equations
+        std::vector<std::pair<unsigned, unsigned>> auxConnections;
+        size_t numAuxMod = model.numAuxiliaryModules();
+        for (unsigned auxModIdx = 0; auxModIdx < numAuxMod; ++auxModIdx)
+            model.auxiliaryModule(auxModIdx)->addConnections(auxConnections, numCells);
+
+        const unsigned numThreads = ThreadManager::maxThreads();
+        std::vector<std::unique_ptr<Stencil>> stencils(numThreads);
+        for (auto& stencil : stencils)
+            stencil = std::make_unique<Stencil>(gridView_(), model.dofMapper());
 
         // for the main model, find out the global indices of the neighboring degrees of
-        // freedom of each primary degree of freedom
-        using NeighborSet = std::set< unsigned >;
-        std::vector<NeighborSet> sparsityPattern(model.numTotalDof());
-        const Scalar gravity = problem_().gravity()[dimWorld - 1];
-        unsigned numCells = model.numTotalDof();
-        neighborInfo_.reserve(numCells, 6 * numCells);
-        std::vector<NeighborInfo> loc_nbinfo;
-        for (const auto& elem : elements(gridView_())) {
+        // freedom of each primary degree of freedom. the first pass over the elements
+        // counts them, the second one fills the sparsity pattern and the face table.
+        Linear::SparsityPattern sparsityPattern(numCells);
+        faceTable_.offset.assign(numCells + 1, 0);
+        model.elementChunks().forEachParallel([&](const Element& elem, unsigned threadId)
+        {
+            Stencil& stencil = *stencils[threadId];
+            stencil.update(elem);
+            for (unsigned primaryDofIdx = 0; primaryDofIdx < stencil.numPrimaryDof(); ++primaryDofIdx) {
+                const unsigned myIdx = stencil.globalSpaceIndex(primaryDofIdx);
+                sparsityPattern.reserveEntries(myIdx, stencil.numDof());
+                // Do not include the primary dof in the face table. each cell is the
+                // primary dof of exactly one element, so no other thread writes here.
+                faceTable_.offset[myIdx + 1] = stencil.numDof() - 1;
+            }
+        });
+        for (const auto& connection : auxConnections)
+            sparsityPattern.reserveEntries(connection.first, 1);
+
+        // lay out the face table
+        for (unsigned globI = 0; globI < numCells; ++globI)
+            faceTable_.offset[globI + 1] += faceTable_.offset[globI];
+        const std::size_t numTotalFaces = faceTable_.offset[numCells];
+        faceTable_.neighbor.resize(numTotalFaces);
+        faceTable_.nbInfo.resize(numTotalFaces);
+
+        // the boundary faces with a non-trivial condition. their conditions are
+        // obtained from the problem after the parallel loop.
+        struct BoundaryFace
+        {
+            unsigned cell;
+            unsigned bfIndex;
+            typename Stencil::BoundaryFace face;
+            GlobalPosition cellCenter;
+        };
+        std::vector<std::vector<BoundaryFace>> threadBoundaryFaces(numThreads);
+
+        sparsityPattern.allocate();
+        const bool nonTrivialBoundaryConditions = LocalResidual::nonTrivialBoundaryConditions(problem_());
+        model.elementChunks().forEachParallel([&](const Element& elem, unsigned threadId)
+        {
+            Stencil& stencil = *stencils[threadId];
             stencil.update(elem);
 
             for (unsigned primaryDofIdx = 0; primaryDofIdx < stencil.numPrimaryDof(); ++primaryDofIdx) {
                 unsigned myIdx = stencil.globalSpaceIndex(primaryDofIdx);
-                loc_nbinfo.resize(stencil.numDof() - 1); // Do not include the primary dof in neighborInfo_
+                const auto firstFace = faceTable_.begin(myIdx);
 
                 for (unsigned dofIdx = 0; dofIdx < stencil.numDof(); ++dofIdx) {
                     unsigned neighborIdx = stencil.globalSpaceIndex(dofIdx);
-                    sparsityPattern[myIdx].insert(neighborIdx);
+                    sparsityPattern.addEntry(myIdx, neighborIdx);
                     if (dofIdx > 0) {
-                        const Scalar trans = problem_().transmissibility(myIdx, neighborIdx);
                         const auto scvfIdx = dofIdx - 1;
-                        const auto& scvf = stencil.interiorFace(scvfIdx);
-                        const Scalar area = scvf.area();
-                        const Scalar Vin = problem_().model().dofTotalVolume(myIdx);
-                        const Scalar Vex = problem_().model().dofTotalVolume(neighborIdx);
-                        const Scalar zIn = problem_().dofCenterDepth(myIdx);
-                        const Scalar zEx = problem_().dofCenterDepth(neighborIdx);
-                        const Scalar dZg = (zIn - zEx)*gravity;
-                        const Scalar thpres = problem_().thresholdPressure(myIdx, neighborIdx);
-                        Scalar inAlpha {0.};
-                        Scalar outAlpha {0.};
-                        Scalar diffusivity {0.};
-                        Scalar dispersivity {0.};
-                        if constexpr(enableEnergy){
-                            inAlpha = problem_().thermalHalfTransmissibility(myIdx, neighborIdx);
-                            outAlpha = problem_().thermalHalfTransmissibility(neighborIdx, myIdx);
-                        }
-                        if constexpr(enableDiffusion){
-                            diffusivity = problem_().diffusivity(myIdx, neighborIdx);
-                        }
-                        if (simulator_().vanguard().eclState().getSimulationConfig().rock_config().dispersion()) {
-                            dispersivity = problem_().dispersivity(myIdx, neighborIdx);
-                        }
-                        const auto dirId = scvf.dirId();
-                        auto faceDir = dirId < 0 ? FaceDir::DirEnum::Unknown
-                                                 : FaceDir::FromIntersectionIndex(dirId);
-                        loc_nbinfo[dofIdx - 1] = NeighborInfo{neighborIdx, {trans, area, thpres, dZg, faceDir, Vin, Vex, inAlpha, outAlpha, diffusivity, dispersivity}, nullptr};
-
+                        faceTable_.neighbor[firstFace + scvfIdx] = neighborIdx;
+                        faceTable_.nbInfo[firstFace + scvfIdx] =
+                            LocalResidual::computeNeighborInfo(problem_(), myIdx, neighborIdx,
+                                                               stencil, scvfIdx);
                     }
                 }
-                neighborInfo_.appendRow(loc_nbinfo.begin(), loc_nbinfo.end());
-                if (problem_().nonTrivialBoundaryConditions()) {
+                if (nonTrivialBoundaryConditions) {
                     for (unsigned bfIndex = 0; bfIndex < stencil.numBoundaryFaces(); ++bfIndex) {
                         const auto& bf = stencil.boundaryFace(bfIndex);
-                        const int dir_id = bf.dirId();
                         // not for NNCs
-                        if (dir_id < 0)
+                        if (bf.dirId() < 0)
                             continue;
-                        const auto [type, massrateAD] = problem_().boundaryCondition(myIdx, dir_id);
-                        // Strip the unnecessary (and zero anyway) derivatives off massrate.
-                        VectorBlock massrate(0.0);
-                        for (size_t ii = 0; ii < massrate.size(); ++ii) {
-                            massrate[ii] = massrateAD[ii].value();
-                        }
-                        const auto& exFluidState = problem_().boundaryFluidState(myIdx, dir_id);
-                        BoundaryConditionData bcdata{type,
-                                                     massrate,
-                                                     exFluidState.pvtRegionIndex(),
-                                                     bfIndex,
-                                                     bf.area(),
-                                                     bf.integrationPos()[dimWorld - 1],
-                                                     exFluidState};
-                        boundaryInfo_.push_back({myIdx, dir_id, bfIndex, bcdata});
+                        threadBoundaryFaces[threadId].push_back({myIdx, bfIndex, bf,
+                                                                 stencil.subControlVolume(primaryDofIdx).globalPos()});
                     }
                 }
             }
+        });
+        for (const auto& connection : auxConnections)
+            sparsityPattern.addEntry(connection.first, connection.second);
+        sparsityPattern.finalize();
+
+        // the order of the boundary faces must not depend on the scheduling of the
+        // threads
+        std::vector<BoundaryFace> boundaryFaces;
+        for (const auto& faces : threadBoundaryFaces)
+            boundaryFaces.insert(boundaryFaces.end(), faces.begin(), faces.end());
+        std::sort(boundaryFaces.begin(), boundaryFaces.end(),
+                  [](const BoundaryFace& a, const BoundaryFace& b)
+                  { return std::tie(a.cell, a.bfIndex) < std::tie(b.cell, b.bfIndex); });
+        for (const auto& bf : boundaryFaces) {
+            const auto bcdata =
+                LocalResidual::boundaryConditionData(problem_(), bf.cell, bf.bfIndex,
+                                                     bf.face, bf.cellCenter);
+            boundaryInfo_.push_back({bf.cell, bf.face.dirId(), bf.bfIndex, bcdata});
         }
 
-        // add the additional neighbors and degrees of freedom caused by the auxiliary
-        // equations
-        size_t numAuxMod = model.numAuxiliaryModules();
-        for (unsigned auxModIdx = 0; auxModIdx < numAuxMod; ++auxModIdx)
-            model.auxiliaryModule(auxModIdx)->addNeighbors(sparsityPattern);
-
         // allocate raw matrix
         jacobian_.reset(new SparseMatrixAdapter(simulator_()));
         diagMatAddress_.resize(numCells);
+        faceTable_.offDiagBlock.resize(numTotalFaces);
         // create matrix structure based on sparsity pattern
         jacobian_->reserve(sparsityPattern);
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
         for (unsigned globI = 0; globI < numCells; globI++) {
-            const auto& nbInfos = neighborInfo_[globI];
             diagMatAddress_[globI] = jacobian_->blockAddress(globI, globI);
-            for (auto& nbInfo : nbInfos) {
-                nbInfo.matBlockAddress = jacobian_->blockAddress(nbInfo.neighbor, globI);
+            for (auto faceIdx = faceTable_.begin(globI); faceIdx < faceTable_.end(globI); ++faceIdx) {
+                faceTable_.offDiagBlock[faceIdx] =
+                    jacobian_->blockAddress(faceTable_.neighbor[faceIdx], globI);
             }
         }
 
@@ -532,6 +662,100 @@ private:
         jacobian_->clear();
     }
 
+    // Determine the cells whose interior fluxes must be re-linearized because their own
+    // or their neighbors' primary variables changed since they were last linearized.
+    // Returns false if the whole domain needs to be linearized.
+    bool markChangedCells_()
+    {
+        OPM_TIMEBLOCK(markChangedCells);
+        // the stored fluxes are only valid within a time step and for the sparsity
+        // pattern of the reservoir cells. auxiliary modules may write to arbitrary
+        // entries of the Jacobian.
+        if (!fluxCacheValid_ ||
+            model_().numAuxiliaryModules() > 0 ||
+            model_().newtonMethod().numIterations() == 0)
+        {
+            return false;
+        }
+
+        const auto& solution = model_().solution(/*timeIdx=*/0);
+        const unsigned numCells = model_().numTotalDof();
+        cellChanged_.resize(numCells);
+        cellDirty_.resize(numCells);
+
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+        for (unsigned globI = 0; globI < numCells; ++globI) {
+            cellChanged_[globI] = priVarsChanged_(globI, solution[globI]);
+            if (cellChanged_[globI])
+                linearizedSolution_[globI] = solution[globI];
+        }
+
+        unsigned numDirty = 0;
+#ifdef _OPENMP
+#pragma omp parallel for reduction(+:numDirty)
+#endif
+        for (unsigned globI = 0; globI < numCells; ++globI) {
+            bool dirty = cellChanged_[globI];
+            for (auto faceIdx = faceTable_.begin(globI); faceIdx < faceTable_.end(globI); ++faceIdx)
+                dirty = dirty || cellChanged_[faceTable_.neighbor[faceIdx]];
+            cellDirty_[globI] = dirty;
+            numDirty += dirty;
+        }
+
+        numDirtyCells_ = numDirty;
+        return numDirty <= selectiveLinearizationMaxFraction_*numCells;
+    }
+
+    // Returns true if the primary variables of a cell changed by more than the
+    // threshold since its fluxes were linearized for the last time. Changes of the
+    // meaning of the primary variables always count.
+    bool priVarsChanged_(unsigned globI, const PrimaryVariables& priVars) const
+    {
+        const PrimaryVariables& linearizedPriVars = linearizedSolution_[globI];
+        if (priVars == linearizedPriVars)
+            return false;
+        else if (!(selectiveLinearizationThreshold_ > 0.0))
+            return true;
+
+        // check whether only the values of the primary variables have changed
+        PrimaryVariables sameValues(priVars);
+        for (unsigned pvIdx = 0; pvIdx < numEq; ++pvIdx)
+            sameValues[pvIdx] = linearizedPriVars[pvIdx];
+        if (!(sameValues == linearizedPriVars))
+            return true;
+
+        for (unsigned pvIdx = 0; pvIdx < numEq; ++pvIdx) {
+            const Scalar weight = model_().primaryVarWeight(globI, pvIdx);
+            if (std::abs(priVars[pvIdx] - linearizedPriVars[pvIdx])*weight > selectiveLinearizationThreshold_)
+                return true;
+        }
+
+        return false;
+    }
+
+    // Reset the linear system for a selective linearization. The residual and the
+    // diagonal blocks also contain the cell terms, which are always re-linearized, so
+    // they are cleared for all cells. The off-diagonal blocks of the column of a cell
+    // only contain its interior fluxes and are kept for the cells which are not dirty.
+    void resetChangedCells_()
+    {
+        residual_ = 0.0;
+        const unsigned numCells = model_().numTotalDof();
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+        for (unsigned globI = 0; globI < numCells; ++globI) {
+            *diagMatAddress_[globI] = 0.0;
+            if (!cellDirty_[globI])
+                continue;
+
+            for (auto faceIdx = faceTable_.begin(globI); faceIdx < faceTable_.end(globI); ++faceIdx)
+                *faceTable_.offDiagBlock[faceIdx] = 0.0;
+        }
+    }
+
     // Initialize the flows, flores, and velocity sparse tables
     void createFlows_()
     {
@@ -539,29 +763,21 @@ private:
         // If FLOWS/FLORES is set in any RPTRST in the schedule, then we initializate the sparse tables
         // For now, do the same also if any block flows are requested (TODO: only save requested cells...)
         // If DISPERC is in the deck, we initialize the sparse table here as well.
-        const bool anyFlows = simulator_().problem().eclWriter()->outputModule().anyFlows();
-        const bool anyFlores = simulator_().problem().eclWriter()->outputModule().anyFlores();
-        const bool enableDispersion = simulator_().vanguard().eclState().getSimulationConfig().rock_config().dispersion();
+        const auto [anyFlows, anyFlores] = LocalResidual::anyFlowsOutput(problem_());
+        const bool enableDispersion = LocalResidual::needsVelocityInfo(problem_());
         if (((!anyFlows || !flowsInfo_.empty()) && (!anyFlores || !floresInfo_.empty())) && !enableDispersion) {
             return;
         }
         const auto& model = model_();
-        const auto& nncOutput = simulator_().problem().eclWriter()->getOutputNnc();
         Stencil stencil(gridView_(), model_().dofMapper());
         unsigned numCells = model.numTotalDof();
-        std::unordered_multimap<int, std::pair<int, int>> nncIndices;
+        // Create a nnc structure to use fast lookup
+        const auto nncIndices = LocalResidual::outputNncIndices(problem_());
         std::vector<FlowInfo> loc_flinfo;
         std::vector<VelocityInfo> loc_vlinfo;
         unsigned int nncId = 0;
         VectorBlock flow(0.0);
 
-        // Create a nnc structure to use fast lookup
-        for (unsigned int nncIdx = 0; nncIdx < nncOutput.size(); ++nncIdx) {
-            const int ci1 = nncOutput[nncIdx].cell1;
-            const int ci2 = nncOutput[nncIdx].cell2;
-            nncIndices.emplace(ci1, std::make_pair(ci2, nncIdx));
-        }
-
         if (anyFlows) {
             flowsInfo_.reserve(numCells, 6 * numCells);
         }
@@ -586,8 +802,8 @@ private:
                         const auto scvfIdx = dofIdx - 1;
                         const auto& scvf = stencil.interiorFace(scvfIdx);
                         int faceId = scvf.dirId();
-                        const int cartMyIdx = simulator_().vanguard().cartesianIndex(myIdx);
-                        const int cartNeighborIdx = simulator_().vanguard().cartesianIndex(neighborIdx);
+                        const int cartMyIdx = LocalResidual::cartesianIndex(problem_(), myIdx);
+                        const int cartNeighborIdx = LocalResidual::cartesianIndex(problem_(), neighborIdx);
                         const auto& range = nncIndices.equal_range(cartMyIdx);
                         for (auto it = range.first; it != range.second; ++it) {
                             if (it->second.first == cartNeighborIdx){
@@ -641,65 +857,62 @@ public:
 
     void updateFlowsInfo() {
         OPM_TIMEBLOCK(updateFlows);
-        const bool& enableFlows = simulator_().problem().eclWriter()->outputModule().hasFlows() ||
-                                    simulator_().problem().eclWriter()->outputModule().hasBlockFlows();
-        const bool& enableFlores = simulator_().problem().eclWriter()->outputModule().hasFlores();
+        const auto [enableFlows, enableFlores] = LocalResidual::flowsOutput(problem_());
         if (!enableFlows && !enableFlores) {
             return;
         }
+        // nothing to do if the last linearization has already captured them
+        if (flowsInfoCaptured_ &&
+            (!enableFlows || captureFlows_) &&
+            (!enableFlores || captureFlores_)) {
+            return;
+        }
         const unsigned int numCells = model_().numTotalDof();
 #ifdef _OPENMP
 #pragma omp parallel for
 #endif
         for (unsigned globI = 0; globI < numCells; ++globI) {
             OPM_TIMEBLOCK_LOCAL(linearizationForEachCell);
-            const auto& nbInfos = neighborInfo_[globI];
-            ADVectorBlock adres(0.0);
-            ADVectorBlock darcyFlux(0.0);
+            VectorBlock res(0.0);
+            VectorBlock darcyFlux(0.0);
             const IntensiveQuantities& intQuantsIn = model_().intensiveQuantities(globI, /*timeIdx*/ 0);
-            // Flux term.
+            // Flux term. The derivatives are not needed for the output.
             {
             OPM_TIMEBLOCK_LOCAL(fluxCalculationForEachCell);
-            short loc = 0;
-            for (const auto& nbInfo : nbInfos) {
+            const auto firstFace = faceTable_.begin(globI);
+            for (auto faceIdx = firstFace; faceIdx < faceTable_.end(globI); ++faceIdx) {
                 OPM_TIMEBLOCK_LOCAL(fluxCalculationForEachFace);
-                unsigned globJ = nbInfo.neighbor;
+                const unsigned globJ = faceTable_.neighbor[faceIdx];
+                const auto& nbInfo = faceTable_.nbInfo[faceIdx];
+                const unsigned loc = faceIdx - firstFace;
                 assert(globJ != globI);
-                adres = 0.0;
-                darcyFlux = 0.0;
                 const IntensiveQuantities& intQuantsEx = model_().intensiveQuantities(globJ, /*timeIdx*/ 0);
-                LocalResidual::computeFlux(adres,darcyFlux, globI, globJ, intQuantsIn, intQuantsEx, nbInfo.res_nbinfo, problem_().moduleParams());
-                adres *= nbInfo.res_nbinfo.faceArea;
+                LocalResidual::computeFluxValues(res, darcyFlux, globI, globJ, intQuantsIn, intQuantsEx, nbInfo, LocalResidual::moduleParams(problem_()));
+                res *= nbInfo.faceArea;
                 if (enableFlows) {
-                    for (unsigned eqIdx = 0; eqIdx < numEq; ++ eqIdx) {
-                        flowsInfo_[globI][loc].flow[eqIdx] = adres[eqIdx].value();
-                    }
+                    flowsInfo_[globI][loc].flow = res;
                 }
                 if (enableFlores) {
-                    for (unsigned eqIdx = 0; eqIdx < numEq; ++ eqIdx) {
-                        floresInfo_[globI][loc].flow[eqIdx] = darcyFlux[eqIdx].value();
-                    }
+                    floresInfo_[globI][loc].flow = darcyFlux;
                 }
-                ++loc;
             }
             }
         }
 
         // Boundary terms. Only looping over cells with nontrivial bcs.
         for (const auto& bdyInfo : boundaryInfo_) {
-            if (bdyInfo.bcdata.type == BCType::NONE)
+            if (!LocalResidual::hasBoundaryFlux(bdyInfo.bcdata))
                 continue;
 
             ADVectorBlock adres(0.0);
             const unsigned globI = bdyInfo.cell;
-            const auto& nbInfos = neighborInfo_[globI];
             const IntensiveQuantities& insideIntQuants = model_().intensiveQuantities(globI, /*timeIdx*/ 0);
             LocalResidual::computeBoundaryFlux(adres, problem_(), bdyInfo.bcdata, insideIntQuants, globI);
             adres *= bdyInfo.bcdata.faceArea;
             const unsigned bfIndex = bdyInfo.bfIndex;
             if (enableFlows) {
                 for (unsigned eqIdx = 0; eqIdx < numEq; ++ eqIdx) {
-                    flowsInfo_[globI][nbInfos.size() + bfIndex].flow[eqIdx] = adres[eqIdx].value();
+                    flowsInfo_[globI][faceTable_.numFaces(globI) + bfIndex].flow[eqIdx] = adres[eqIdx].value();
                 }
             }
             // TODO also store Flores?
@@ -707,8 +920,46 @@ public:
     }
 
 private:
-    template <class SubDomainType>
-    void linearize_(const SubDomainType& domain)
+    // The flows and flores of the last time step of a report step are captured by
+    // every linearization of the full domain, so that updateFlowsInfo() does not need
+    // to evaluate the fluxes again. Since this applies to all iterations of such a
+    // time step, the fluxes reused by the selective linearization are captured as
+    // well.
+    void prepareFlowsCapture_(bool fullDomain)
+    {
+        const auto [enableFlows, enableFlores] = LocalResidual::flowsOutput(problem_());
+        const bool reportStep = fullDomain && simulator_().episodeWillBeOver();
+        captureFlows_ = reportStep && !flowsInfo_.empty() && enableFlows;
+        captureFlores_ = reportStep && !floresInfo_.empty() && enableFlores;
+        flowsInfoCaptured_ = false;
+    }
+
+    template <class FluxVector>
+    void storeFlows_(unsigned globI, unsigned loc, const FluxVector& flux, const FluxVector& darcyFlux)
+    {
+        if (captureFlows_) {
+            for (unsigned eqIdx = 0; eqIdx < numEq; ++eqIdx)
+                flowsInfo_[globI][loc].flow[eqIdx] = getValue(flux[eqIdx]);
+        }
+        if (captureFlores_) {
+            for (unsigned eqIdx = 0; eqIdx < numEq; ++eqIdx)
+                floresInfo_[globI][loc].flow[eqIdx] = getValue(darcyFlux[eqIdx]);
+        }
+    }
+
+    // make sure that the intensive quantities which are used by the local residual are
+    // up to date. the model only recalculates the ones whose cache entries have been
+    // invalidated, e.g., by the update of the Newton method.
+    void updateIntensiveQuantities_()
+    {
+        OPM_TIMEBLOCK(updateIntensiveQuantities);
+        model_().updateIntensiveQuantities(/*timeIdx=*/0);
+        if (!model_().enableStorageCache())
+            model_().updateIntensiveQuantities(/*timeIdx=*/1);
+    }
+
+    // make sure that the storage terms of the previous time step are available
+    void prepareStorage_()
     {
         // This check should be removed once this is addressed by
         // for example storing the previous timesteps' values for
@@ -717,26 +968,62 @@ private:
             if (!model_().storeIntensiveQuantities() && !model_().enableStorageCache()) {
                 OPM_THROW(std::runtime_error, "Must have cached either IQs or storage when we cannot recycle.");
             }
+
+            // the storage of the previous time step is usually captured at its end
+            // (see FvBaseDiscretization::captureHistoryStorage()). this is not the case
+            // for the first time step and after a restart.
+            if (model_().enableStorageCache() && !model_().historyStorageUpToDate())
+                model_().updateHistoryStorage();
         }
+    }
+
+    template <class SubDomainType>
+    void linearize_(const SubDomainType& domain)
+    {
+        // the intensive quantities of a subdomain are updated by the code which solves
+        // it locally
+        if (domain.cells.size() == model_().numTotalDof())
+            updateIntensiveQuantities_();
+        prepareStorage_();
 
         OPM_TIMEBLOCK(linearize);
 
         // We do not call resetSystem_() here, since that will set
         // the full system to zero, not just our part.
         // Instead, that must be called before starting the linearization.
-        const bool& enableDispersion = simulator_().vanguard().eclState().getSimulationConfig().rock_config().dispersion();
+        const bool& enableDispersion = LocalResidual::needsVelocityInfo(problem_());
         const unsigned int numCells = domain.cells.size();
         const bool on_full_domain = (numCells == model_().numTotalDof());
 
+        // the interior fluxes of each cell are kept for the selective linearization
+        // of the next iteration
+        const bool reuseFluxes = reuseFluxes_ && on_full_domain;
+        const bool storeFluxes = enableSelectiveLinearization_ && on_full_domain;
+        if (storeFluxes) {
+            fluxCacheValid_ = false;
+            fluxResidual_.resize(numCells);
+            fluxDiagonal_.resize(numCells);
+        }
+
 #ifdef _OPENMP
 #pragma omp parallel for
 #endif
         for (unsigned ii = 0; ii < numCells; ++ii) {
             OPM_TIMEBLOCK_LOCAL(linearizationForEachCell);
             const unsigned globI = domain.cells[ii];
-            const auto& nbInfos = neighborInfo_[globI];
+            if (reuseFluxes && !cellDirty_[globI]) {
+                // neither the cell nor any of its neighbors changed, so the
+                // off-diagonal blocks of its column are still in place
+                residual_[globI] += fluxResidual_[globI];
+                *diagMatAddress_[globI] += fluxDiagonal_[globI];
+                linearizeCellTerms_(globI, on_full_domain);
+                continue;
+            }
+
             VectorBlock res(0.0);
             MatrixBlock bMat(0.0);
+            VectorBlock fluxRes(0.0);
+            MatrixBlock fluxDiag(0.0);
             ADVectorBlock adres(0.0);
             ADVectorBlock darcyFlux(0.0);
             const IntensiveQuantities& intQuantsIn = model_().intensiveQuantities(globI, /*timeIdx*/ 0);
@@ -744,111 +1031,62 @@ private:
             // Flux term.
             {
             OPM_TIMEBLOCK_LOCAL(fluxCalculationForEachCell);
-            short loc = 0;
-            for (const auto& nbInfo : nbInfos) {
+            const auto firstFace = faceTable_.begin(globI);
+            for (auto faceIdx = firstFace; faceIdx < faceTable_.end(globI); ++faceIdx) {
                 OPM_TIMEBLOCK_LOCAL(fluxCalculationForEachFace);
-                unsigned globJ = nbInfo.neighbor;
+                const unsigned globJ = faceTable_.neighbor[faceIdx];
+                const auto& nbInfo = faceTable_.nbInfo[faceIdx];
+                const unsigned loc = faceIdx - firstFace;
                 assert(globJ != globI);
                 res = 0.0;
                 bMat = 0.0;
                 adres = 0.0;
                 darcyFlux = 0.0;
                 const IntensiveQuantities& intQuantsEx = model_().intensiveQuantities(globJ, /*timeIdx*/ 0);
-                LocalResidual::computeFlux(adres,darcyFlux, globI, globJ, intQuantsIn, intQuantsEx, nbInfo.res_nbinfo,  problem_().moduleParams());
-                adres *= nbInfo.res_nbinfo.faceArea;
+                LocalResidual::computeFlux(adres,darcyFlux, globI, globJ, intQuantsIn, intQuantsEx, nbInfo,  LocalResidual::moduleParams(problem_()));
+                adres *= nbInfo.faceArea;
                 if (enableDispersion) {
                     for (unsigned phaseIdx = 0; phaseIdx < numEq; ++ phaseIdx) {
-                        velocityInfo_[globI][loc].velocity[phaseIdx] = darcyFlux[phaseIdx].value() / nbInfo.res_nbinfo.faceArea;
+                        velocityInfo_[globI][loc].velocity[phaseIdx] = darcyFlux[phaseIdx].value() / nbInfo.faceArea;
                     }
                 }
+                storeFlows_(globI, loc, adres, darcyFlux);
                 setResAndJacobi(res, bMat, adres);
-                residual_[globI] += res;
-                //SparseAdapter syntax:  jacobian_->addToBlock(globI, globI, bMat);
-                *diagMatAddress_[globI] += bMat;
+                fluxRes += res;
+                fluxDiag += bMat;
                 bMat *= -1.0;
                 //SparseAdapter syntax: jacobian_->addToBlock(globJ, globI, bMat);
-                *nbInfo.matBlockAddress += bMat;
-                ++loc;
+                *faceTable_.offDiagBlock[faceIdx] += bMat;
             }
             }
 
-            // Accumulation term.
-            double dt = simulator_().timeStepSize();
-            double volume = model_().dofTotalVolume(globI);
-            Scalar storefac = volume / dt;
-            adres = 0.0;
-            {
-                OPM_TIMEBLOCK_LOCAL(computeStorage);
-                LocalResidual::computeStorage(adres, intQuantsIn);
+            residual_[globI] += fluxRes;
+            //SparseAdapter syntax:  jacobian_->addToBlock(globI, globI, fluxDiag);
+            *diagMatAddress_[globI] += fluxDiag;
+            if (storeFluxes) {
+                fluxResidual_[globI] = fluxRes;
+                fluxDiagonal_[globI] = fluxDiag;
             }
-            setResAndJacobi(res, bMat, adres);
-            // Either use cached storage term, or compute it on the fly.
-            if (model_().enableStorageCache()) {
-                // The cached storage for timeIdx 0 (current time) is not
-                // used, but after storage cache is shifted at the end of the
-                // timestep, it will become cached storage for timeIdx 1.
-                model_().updateCachedStorage(globI, /*timeIdx=*/0, res);
-                if (model_().newtonMethod().numIterations() == 0) {
-                    // Need to update the storage cache.
-                    if (problem_().recycleFirstIterationStorage()) {
-                        // Assumes nothing have changed in the system which
-                        // affects masses calculated from primary variables.
-                        if (on_full_domain) {
-                            // This is to avoid resetting the start-of-step storage
-                            // to incorrect numbers when we do local solves, where the iteration
-                            // number will start from 0, but the starting state may not be identical
-                            // to the start-of-step state.
-                            // Note that a full assembly must be done before local solves
-                            // otherwise this will be left un-updated.
-                            model_().updateCachedStorage(globI, /*timeIdx=*/1, res);
-                        }
-                    } else {
-                        Dune::FieldVector<Scalar, numEq> tmp;
-                        IntensiveQuantities intQuantOld = model_().intensiveQuantities(globI, 1);
-                        LocalResidual::computeStorage(tmp, intQuantOld);
-                        model_().updateCachedStorage(globI, /*timeIdx=*/1, tmp);
-                    }
-                }
-                res -= model_().cachedStorage(globI, 1);
-            } else {
-                OPM_TIMEBLOCK_LOCAL(computeStorage0);
-                Dune::FieldVector<Scalar, numEq> tmp;
-                IntensiveQuantities intQuantOld = model_().intensiveQuantities(globI, 1);
-                LocalResidual::computeStorage(tmp, intQuantOld);
-                // assume volume do not change
-                res -= tmp;
-            }
-            res *= storefac;
-            bMat *= storefac;
-            residual_[globI] += res;
-            //SparseAdapter syntax: jacobian_->addToBlock(globI, globI, bMat);
-            *diagMatAddress_[globI] += bMat;
 
-            // Cell-wise source terms.
-            // This will include well sources if SeparateSparseSourceTerms is false.
-            res = 0.0;
-            bMat = 0.0;
-            adres = 0.0;
-            if (separateSparseSourceTerms_) {
-                LocalResidual::computeSourceDense(adres, problem_(), globI, 0);
-            } else {
-                LocalResidual::computeSource(adres, problem_(), globI, 0);
-            }
-            adres *= -volume;
-            setResAndJacobi(res, bMat, adres);
-            residual_[globI] += res;
-            //SparseAdapter syntax: jacobian_->addToBlock(globI, globI, bMat);
-            *diagMatAddress_[globI] += bMat;
+            linearizeCellTerms_(globI, on_full_domain);
         } // end of loop for cell globI.
 
         // Add sparse source terms. For now only wells.
         if (separateSparseSourceTerms_) {
-            problem_().wellModel().addReservoirSourceTerms(residual_, diagMatAddress_);
+            LocalResidual::addSparseSourceTerms(problem_(), residual_, diagMatAddress_);
         }
 
+        if (storeFluxes) {
+            // after a full linearization, all cells are up to date
+            if (!reuseFluxes)
+                linearizedSolution_ = model_().solution(/*timeIdx=*/0);
+            fluxCacheValid_ = true;
+        }
+        reuseFluxes_ = false;
+
         // Boundary terms. Only looping over cells with nontrivial bcs.
         for (const auto& bdyInfo : boundaryInfo_) {
-            if (bdyInfo.bcdata.type == BCType::NONE)
+            if (!LocalResidual::hasBoundaryFlux(bdyInfo.bcdata))
                 continue;
 
             VectorBlock res(0.0);
@@ -862,12 +1100,173 @@ private:
             residual_[globI] += res;
             ////SparseAdapter syntax: jacobian_->addToBlock(globI, globI, bMat);
             *diagMatAddress_[globI] += bMat;
+            if (captureFlows_)
+                flowsInfo_[globI][faceTable_.numFaces(globI) + bdyInfo.bfIndex].flow = res;
+        }
+        flowsInfoCaptured_ = captureFlows_ || captureFlores_;
+    }
+
+    // Accumulation and source terms of a single cell. If only the residual is
+    // requested, the diagonal block of the Jacobian is left alone.
+    void linearizeCellTerms_(unsigned globI, bool on_full_domain, bool residualOnly = false)
+    {
+        VectorBlock res(0.0);
+        MatrixBlock bMat(0.0);
+        ADVectorBlock adres(0.0);
+        const IntensiveQuantities& intQuantsIn = model_().intensiveQuantities(globI, /*timeIdx*/ 0);
+
+        // Accumulation term.
+        double dt = simulator_().timeStepSize();
+        double volume = model_().dofTotalVolume(globI);
+        Scalar storefac = volume / dt;
+        adres = 0.0;
+        {
+            OPM_TIMEBLOCK_LOCAL(computeStorage);
+            if (residualOnly)
+                LocalResidual::computeStorage(res, intQuantsIn);
+            else {
+                LocalResidual::computeStorage(adres, intQuantsIn);
+                setResAndJacobi(res, bMat, adres);
+            }
+        }
+        // Either use cached storage term, or compute it on the fly.
+        if (model_().enableStorageCache()) {
+            // The cached storage for timeIdx 0 (current time) is not
+            // used, but after storage cache is shifted at the end of the
+            // timestep, it will become cached storage for timeIdx 1.
+            model_().updateCachedStorage(globI, /*timeIdx=*/0, res);
+            // If the storage of the first iteration cannot be recycled, the storage
+            // for timeIdx 1 has already been computed from the solution of the
+            // previous time step (see FvBaseDiscretization::captureHistoryStorage()).
+            if (model_().newtonMethod().numIterations() == 0 &&
+                problem_().recycleFirstIterationStorage()) {
+                // Need to update the storage cache.
+                // Assumes nothing have changed in the system which
+                // affects masses calculated from primary variables.
+                if (on_full_domain) {
+                    // This is to avoid resetting the start-of-step storage
+                    // to incorrect numbers when we do local solves, where the iteration
+                    // number will start from 0, but the starting state may not be identical
+                    // to the start-of-step state.
+                    // Note that a full assembly must be done before local solves
+                    // otherwise this will be left un-updated.
+                    model_().updateCachedStorage(globI, /*timeIdx=*/1, res);
+                }
+            }
+            res -= model_().cachedStorage(globI, 1);
+        } else {
+            OPM_TIMEBLOCK_LOCAL(computeStorage0);
+            Dune::FieldVector<Scalar, numEq> tmp;
+            const IntensiveQuantities& intQuantOld = model_().intensiveQuantities(globI, 1);
+            LocalResidual::computeStorage(tmp, intQuantOld);
+            // assume volume do not change
+            res -= tmp;
+        }
+        res *= storefac;
+        residual_[globI] += res;
+        if (!residualOnly) {
+            bMat *= storefac;
+            //SparseAdapter syntax: jacobian_->addToBlock(globI, globI, bMat);
+            *diagMatAddress_[globI] += bMat;
+        }
+
+        // Cell-wise source terms.
+        // This will include well sources if SeparateSparseSourceTerms is false.
+        res = 0.0;
+        bMat = 0.0;
+        adres = 0.0;
+        if (separateSparseSourceTerms_) {
+            LocalResidual::computeSourceDense(adres, problem_(), globI, 0);
+        } else {
+            LocalResidual::computeSource(adres, problem_(), globI, 0);
+        }
+        adres *= -volume;
+        setResAndJacobi(res, bMat, adres);
+        residual_[globI] += res;
+        if (!residualOnly) {
+            //SparseAdapter syntax: jacobian_->addToBlock(globI, globI, bMat);
+            *diagMatAddress_[globI] += bMat;
         }
     }
 
+    // Evaluate the residual of all cells. This is the same as linearize_() on the full
+    // domain, but none of the derivatives are written to the Jacobian matrix.
+    void linearizeResidual_()
+    {
+        updateIntensiveQuantities_();
+        prepareStorage_();
+        prepareFlowsCapture_(/*fullDomain=*/true);
+
+        OPM_TIMEBLOCK(linearizeResidual);
+        residual_ = 0.0;
+
+        const bool& enableDispersion = LocalResidual::needsVelocityInfo(problem_());
+        const unsigned int numCells = model_().numTotalDof();
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+        for (unsigned globI = 0; globI < numCells; ++globI) {
+            OPM_TIMEBLOCK_LOCAL(residualForEachCell);
+            VectorBlock res(0.0);
+            VectorBlock darcyFlux(0.0);
+            const IntensiveQuantities& intQuantsIn = model_().intensiveQuantities(globI, /*timeIdx*/ 0);
+
+            // Flux term. Only the values are needed, i.e., the cheaper scalar kernel
+            // is used.
+            const auto firstFace = faceTable_.begin(globI);
+            for (auto faceIdx = firstFace; faceIdx < faceTable_.end(globI); ++faceIdx) {
+                const unsigned globJ = faceTable_.neighbor[faceIdx];
+                const auto& nbInfo = faceTable_.nbInfo[faceIdx];
+                const unsigned loc = faceIdx - firstFace;
+                assert(globJ != globI);
+                const IntensiveQuantities& intQuantsEx = model_().intensiveQuantities(globJ, /*timeIdx*/ 0);
+                LocalResidual::computeFluxValues(res, darcyFlux, globI, globJ, intQuantsIn, intQuantsEx, nbInfo, LocalResidual::moduleParams(problem_()));
+                res *= nbInfo.faceArea;
+                if (enableDispersion) {
+                    for (unsigned phaseIdx = 0; phaseIdx < numEq; ++ phaseIdx) {
+                        velocityInfo_[globI][loc].velocity[phaseIdx] = darcyFlux[phaseIdx] / nbInfo.faceArea;
+                    }
+                }
+                storeFlows_(globI, loc, res, darcyFlux);
+                residual_[globI] += res;
+            }
+
+            linearizeCellTerms_(globI, /*on_full_domain=*/true, /*residualOnly=*/true);
+        }
+
+        // Add sparse source terms. For now only wells. Their contributions to the
+        // diagonal blocks are discarded.
+        if (separateSparseSourceTerms_) {
+            residualOnlyDiag_.resize(numCells);
+            residualOnlyDiagAddress_.resize(numCells);
+            for (unsigned globI = 0; globI < numCells; ++globI)
+                residualOnlyDiagAddress_[globI] = &residualOnlyDiag_[globI];
+            LocalResidual::addSparseSourceTerms(problem_(), residual_, residualOnlyDiagAddress_);
+        }
+
+        // Boundary terms. Only looping over cells with nontrivial bcs.
+        for (const auto& bdyInfo : boundaryInfo_) {
+            if (!LocalResidual::hasBoundaryFlux(bdyInfo.bcdata))
+                continue;
+
+            ADVectorBlock adres(0.0);
+            const unsigned globI = bdyInfo.cell;
+            const IntensiveQuantities& insideIntQuants = model_().intensiveQuantities(globI, /*timeIdx*/ 0);
+            LocalResidual::computeBoundaryFlux(adres, problem_(), bdyInfo.bcdata, insideIntQuants, globI);
+            adres *= bdyInfo.bcdata.faceArea;
+            for (unsigned eqIdx = 0; eqIdx < numEq; ++eqIdx)
+                residual_[globI][eqIdx] += adres[eqIdx].value();
+            if (captureFlows_) {
+                for (unsigned eqIdx = 0; eqIdx < numEq; ++eqIdx)
+                    flowsInfo_[globI][faceTable_.numFaces(globI) + bdyInfo.bfIndex].flow[eqIdx] = adres[eqIdx].value();
+            }
+        }
+        flowsInfoCaptured_ = captureFlows_ || captureFlores_;
+    }
+
     void updateStoredTransmissibilities()
     {
-        if (neighborInfo_.empty()) {
+        if (faceTable_.empty()) {
             // This function was called before createMatrix_() was called.
             // We call initFirstIteration_(), not createMatrix_(), because
             // that will also initialize the residual consistently.
@@ -878,12 +1277,15 @@ private:
 #pragma omp parallel for
 #endif
         for (unsigned globI = 0; globI < numCells; globI++) {
-            auto nbInfos = neighborInfo_[globI]; // nbInfos will be a SparseTable<...>::mutable_iterator_range.
-            for (auto& nbInfo : nbInfos) {
-                unsigned globJ = nbInfo.neighbor;
-                nbInfo.res_nbinfo.trans = problem_().transmissibility(globI, globJ);
+            for (auto faceIdx = faceTable_.begin(globI); faceIdx < faceTable_.end(globI); ++faceIdx) {
+                LocalResidual::updateNeighborInfo(faceTable_.nbInfo[faceIdx], problem_(),
+                                                  globI, faceTable_.neighbor[faceIdx]);
             }
         }
+
+        // the stored fluxes were computed with the old transmissibilities
+        fluxCacheValid_ = false;
+        flowsInfoCaptured_ = false;
     }
 
 
@@ -898,13 +1300,35 @@ private:
     LinearizationType linearizationType_;
 
     using ResidualNBInfo = typename LocalResidual::ResidualNBInfo;
-    struct NeighborInfo
+
+    // The interior faces of all cells in structure-of-arrays layout. The faces of cell
+    // globI are the entries [offset[globI], offset[globI + 1]) of the other arrays.
+    // The loops only stream through the arrays they need, e.g., finding the changed
+    // cells only reads the neighbor indices and the residual does not touch the
+    // addresses of the Jacobian blocks. ResidualNBInfo itself only contains the fields
+    // of the enabled modules.
+    struct FaceTable
     {
-        unsigned int neighbor;
-        ResidualNBInfo res_nbinfo;
-        MatrixBlock* matBlockAddress;
+        std::vector<std::uint32_t> offset;
+        std::vector<std::uint32_t> neighbor;
+        std::vector<ResidualNBInfo> nbInfo;
+        // the block of the Jacobian for the derivative of the neighbor's residual
+        // with regard to the primary variables of the cell
+        std::vector<MatrixBlock*> offDiagBlock;
+
+        bool empty() const
+        { return offset.empty(); }
+
+        std::uint32_t begin(unsigned globI) const
+        { return offset[globI]; }
+
+        std::uint32_t end(unsigned globI) const
+        { return offset[globI + 1]; }
+
+        unsigned numFaces(unsigned globI) const
+        { return offset[globI + 1] - offset[globI]; }
     };
-    SparseTable<NeighborInfo> neighborInfo_;
+    FaceTable faceTable_;
     std::vector<MatrixBlock*> diagMatAddress_;
 
     struct FlowInfo
@@ -915,6 +1339,9 @@ private:
     };
     SparseTable<FlowInfo> flowsInfo_;
     SparseTable<FlowInfo> floresInfo_;
+    bool captureFlows_ = false;
+    bool captureFlores_ = false;
+    bool flowsInfoCaptured_ = false;
 
     struct VelocityInfo
     {
@@ -922,17 +1349,7 @@ private:
     };
     SparseTable<VelocityInfo> velocityInfo_;
 
-    using ScalarFluidState = typename IntensiveQuantities::ScalarFluidState;
-    struct BoundaryConditionData
-    {
-        BCType type;
-        VectorBlock massRate;
-        unsigned pvtRegionIdx;
-        unsigned boundaryFaceIndex;
-        double faceArea;
-        double faceZCoord;
-        ScalarFluidState exFluidState;
-    };
+    using BoundaryConditionData = typename LocalResidual::BoundaryConditionData;
     struct BoundaryInfo
     {
         unsigned int cell;
@@ -942,6 +1359,28 @@ private:
     };
     std::vector<BoundaryInfo> boundaryInfo_;
     bool separateSparseSourceTerms_ = false;
+
+    // the interior flux contributions of each cell to its residual and to its diagonal
+    // block, and the solution they were computed for. used by the selective
+    // linearization.
+    bool enableSelectiveLinearization_ = false;
+    Scalar selectiveLinearizationThreshold_ = 0.0;
+    Scalar selectiveLinearizationMaxFraction_ = 0.5;
+    bool fluxCacheValid_ = false;
+    bool reuseFluxes_ = false;
+    std::vector<VectorBlock> fluxResidual_;
+    std::vector<MatrixBlock> fluxDiagonal_;
+    SolutionVector linearizedSolution_;
+    std::vector<unsigned char> cellChanged_;
+    std::vector<unsigned char> cellDirty_;
+    unsigned numDirtyCells_ = 0;
+    std::size_t numReusedCells_ = 0;
+
+    // scratch space for the diagonal blocks of the sparse source terms if only the
+    // residual is evaluated
+    std::vector<MatrixBlock> residualOnlyDiag_;
+    std::vector<MatrixBlock*> residualOnlyDiagAddress_;
+
     struct FullDomain
     {
         std::vector<int> cells;
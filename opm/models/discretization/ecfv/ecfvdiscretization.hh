@@ -58,9 +58,14 @@ struct Stencil<TypeTag, TTag::EcfvDiscretization>
 private:
     using Scalar = GetPropType<TypeTag, Properties::Scalar>;
     using GridView = GetPropType<TypeTag, Properties::GridView>;
+    using ElementMapper = GetPropType<TypeTag, Properties::ElementMapper>;
 
 public:
-    using type = EcfvStencil<Scalar, GridView>;
+    using type = EcfvStencil<Scalar,
+                             GridView,
+                             /*needFaceIntegrationPos=*/true,
+                             /*needFaceNormal=*/true,
+                             ElementMapper>;
 };
 
 //! Mapper for the degrees of freedoms.
@@ -199,6 +204,20 @@ public:
         this->gridView().communicate(ghostSync,
                                      Dune::InteriorBorder_All_Interface,
                                      Dune::ForwardCommunication);
+
+        // the Newton method only invalidates the cached intensive quantities of the
+        // degrees of freedom which it changed locally, but the ones of the ghost and
+        // overlap elements have just been overwritten by their owners
+        if (this->storeIntensiveQuantities() && this->gridView().comm().size() > 1) {
+            for (const auto& elem : elements(this->gridView())) {
+                if (elem.partitionType() == Dune::InteriorEntity)
+                    continue;
+
+                this->setIntensiveQuantitiesCacheEntryValidity(asImp_().dofMapper().index(elem),
+                                                               /*timeIdx=*/0,
+                                                               /*valid=*/false);
+            }
+        }
     }
 
     /*!
@@ -56,7 +56,8 @@ namespace Opm {
 template <class Scalar,
           class GridView,
           bool needFaceIntegrationPos = true,
-          bool needFaceNormal = true>
+          bool needFaceNormal = true,
+          class ElementMapper = Dune::MultipleCodimMultipleGeomTypeMapper<GridView>>
 class EcfvStencil
 {
     enum { dimWorld = GridView::dimensionworld };
@@ -65,8 +66,6 @@ class EcfvStencil
     using Intersection = typename GridView::Intersection;
     using Element = typename GridView::template Codim<0>::Entity;
 
-    using ElementMapper = Dune::MultipleCodimMultipleGeomTypeMapper<GridView>;
-
     using GlobalPosition = Dune::FieldVector<CoordScalar, dimWorld>;
 
     using WorldVector = Dune::FieldVector<Scalar, dimWorld>;
@@ -0,0 +1,516 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ *
+ * \copydoc Opm::ImmiscibleLocalResidualTPFA
+ */
+#ifndef EWOMS_IMMISCIBLE_LOCAL_RESIDUAL_TPFA_HH
+#define EWOMS_IMMISCIBLE_LOCAL_RESIDUAL_TPFA_HH
+
+#include "immisciblelocalresidual.hh"
+
+#include <dune/common/fvector.hh>
+
+#include <opm/input/eclipse/Schedule/BCProp.hpp>
+
+#include <opm/material/common/MathToolbox.hpp>
+#include <opm/material/fluidstates/ImmiscibleFluidState.hpp>
+
+#include <array>
+#include <cmath>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <utility>
+
+namespace Opm {
+/*!
+ * \ingroup ImmiscibleModel
+ *
+ * \brief Calculates the local residual of the immiscible multi-phase model for
+ *        TpfaLinearizer.
+ *
+ * The fluxes are the ones of TransFluxModule, i.e., they use the two-point
+ * transmissibilities of a grid-aligned permeability and assume gravity to act along
+ * the last coordinate axis. Contrary to BlackOilLocalResidualTPFA, the geometry of the
+ * faces is taken from the stencil, so the problem only needs to provide the following
+ * methods in addition to the ones of the immiscible model:
+ *
+ * - intrinsicPermeability(globalSpaceIdx, timeIdx)
+ * - materialLawParams(globalSpaceIdx, timeIdx)
+ * - source(rate, globalSpaceIdx, timeIdx)
+ * - boundaryCondition(globalSpaceIdx, facePos, timeIdx), which returns the type of the
+ *   boundary condition of a face and its mass rate for BCType::RATE
+ * - boundaryFluidState(globalSpaceIdx, facePos, timeIdx), which returns the state of
+ *   the fluids outside of the domain for BCType::FREE
+ *
+ * The energy equation is not supported.
+ */
+template <class TypeTag>
+class ImmiscibleLocalResidualTPFA : public ImmiscibleLocalResidual<TypeTag>
+{
+    using ParentType = ImmiscibleLocalResidual<TypeTag>;
+
+    using Scalar = GetPropType<TypeTag, Properties::Scalar>;
+    using Evaluation = GetPropType<TypeTag, Properties::Evaluation>;
+    using IntensiveQuantities = GetPropType<TypeTag, Properties::IntensiveQuantities>;
+    using FluidSystem = GetPropType<TypeTag, Properties::FluidSystem>;
+    using MaterialLaw = GetPropType<TypeTag, Properties::MaterialLaw>;
+    using Indices = GetPropType<TypeTag, Properties::Indices>;
+    using RateVector = GetPropType<TypeTag, Properties::RateVector>;
+    using GridView = GetPropType<TypeTag, Properties::GridView>;
+    using Problem = GetPropType<TypeTag, Properties::Problem>;
+
+    enum { conti0EqIdx = Indices::conti0EqIdx };
+    enum { numEq = getPropValue<TypeTag, Properties::NumEq>() };
+    enum { numPhases = getPropValue<TypeTag, Properties::NumPhases>() };
+    enum { enableEnergy = getPropValue<TypeTag, Properties::EnableEnergy>() };
+    enum { dimWorld = GridView::dimensionworld };
+
+    static_assert(!enableEnergy,
+                  "The energy equation is not supported by ImmiscibleLocalResidualTPFA");
+
+    using GlobalPosition = Dune::FieldVector<typename GridView::ctype, dimWorld>;
+    using Toolbox = MathToolbox<Evaluation>;
+
+public:
+    /*!
+     * \brief The data of an interior face which is required to compute its flux.
+     */
+    struct ResidualNBInfo
+    {
+        Scalar trans; // transmissibility per face area [m]
+        Scalar faceArea;
+        Scalar dZg;
+        Scalar Vin;
+        Scalar Vex;
+    };
+
+    struct ModuleParams
+    {};
+
+    using BoundaryFluidState = ImmiscibleFluidState<Scalar, FluidSystem, /*storeEnthalpy=*/false>;
+    struct BoundaryConditionData
+    {
+        BCType type;
+        Dune::FieldVector<Scalar, numEq> massRate;
+        unsigned boundaryFaceIndex;
+        Scalar faceArea;
+        Scalar trans; // transmissibility per face area [m]
+        Scalar dZg;
+        GlobalPosition facePos;
+        BoundaryFluidState exFluidState;
+        std::array<Scalar, numPhases> exMobility{};
+    };
+
+    using ParentType::computeStorage;
+    using ParentType::computeFlux;
+    using ParentType::computeSource;
+
+    // The methods below are the interface which is used by TpfaLinearizer to obtain
+    // the data of the faces, the boundary conditions, the sparse source terms and
+    // the requested output.
+
+    /*!
+     * \brief Compute the data of an interior face which is kept by the linearizer.
+     */
+    template <class Stencil>
+    static ResidualNBInfo computeNeighborInfo(const Problem& problem,
+                                              unsigned globalIndexIn,
+                                              unsigned globalIndexEx,
+                                              const Stencil& stencil,
+                                              unsigned scvfIdx)
+    {
+        const auto& scvf = stencil.interiorFace(scvfIdx);
+        const auto& posIn = stencil.subControlVolume(scvf.interiorIndex()).globalPos();
+        const auto& posEx = stencil.subControlVolume(scvf.exteriorIndex()).globalPos();
+        const Scalar gravity = problem.gravity()[dimWorld - 1];
+
+        const Scalar transIn =
+            halfTransmissibility_(problem.intrinsicPermeability(globalIndexIn, /*timeIdx=*/0),
+                                  scvf.normal(), scvf.integrationPos() - posIn);
+        const Scalar transEx =
+            halfTransmissibility_(problem.intrinsicPermeability(globalIndexEx, /*timeIdx=*/0),
+                                  scvf.normal(), scvf.integrationPos() - posEx);
+
+        ResidualNBInfo nbInfo;
+        nbInfo.trans = transIn*transEx/(transIn + transEx);
+        nbInfo.faceArea = scvf.area();
+        nbInfo.dZg = (posIn[dimWorld - 1] - posEx[dimWorld - 1])*gravity;
+        nbInfo.Vin = problem.model().dofTotalVolume(globalIndexIn);
+        nbInfo.Vex = problem.model().dofTotalVolume(globalIndexEx);
+        return nbInfo;
+    }
+
+    /*!
+     * \brief Update the parts of the face data which depend on the transmissibilities.
+     *
+     * The transmissibilities only depend on the geometry and on the permeabilities,
+     * which do not change over the course of a simulation.
+     */
+    static void updateNeighborInfo(ResidualNBInfo&,
+                                   const Problem&,
+                                   unsigned,
+                                   unsigned)
+    { }
+
+    /*!
+     * \brief Returns the parameters of the modules which are passed to computeFlux().
+     */
+    static ModuleParams moduleParams(const Problem&)
+    { return ModuleParams{}; }
+
+    /*!
+     * \brief Returns true if the phase velocities of the faces need to be stored.
+     */
+    static bool needsVelocityInfo(const Problem&)
+    { return false; }
+
+    /*!
+     * \brief Add the source terms which are not treated cell by cell.
+     *
+     * There are no such source terms for the immiscible model.
+     */
+    template <class GlobalEqVector, class DiagonalBlockAddresses>
+    static void addSparseSourceTerms(Problem&,
+                                     GlobalEqVector&,
+                                     DiagonalBlockAddresses&)
+    { }
+
+    /*!
+     * \brief Returns true if boundary conditions other than no-flow are possible.
+     */
+    static bool nonTrivialBoundaryConditions(const Problem&)
+    { return true; }
+
+    /*!
+     * \brief Returns the data of the boundary condition of a boundary face.
+     */
+    template <class BoundaryFace>
+    static BoundaryConditionData boundaryConditionData(const Problem& problem,
+                                                       unsigned globalIndex,
+                                                       unsigned bfIndex,
+                                                       const BoundaryFace& face,
+                                                       const GlobalPosition& cellCenter)
+    {
+        const Scalar gravity = problem.gravity()[dimWorld - 1];
+
+        BoundaryConditionData bcdata;
+        bcdata.boundaryFaceIndex = bfIndex;
+        bcdata.faceArea = face.area();
+        bcdata.trans =
+            halfTransmissibility_(problem.intrinsicPermeability(globalIndex, /*timeIdx=*/0),
+                                  face.normal(), face.integrationPos() - cellCenter);
+        bcdata.dZg = (cellCenter[dimWorld - 1] - face.integrationPos()[dimWorld - 1])*gravity;
+        bcdata.facePos = face.integrationPos();
+        updateBoundaryConditionData(bcdata, problem, globalIndex, face.dirId());
+        return bcdata;
+    }
+
+    /*!
+     * \brief Update the boundary condition of a boundary face for the current time.
+     */
+    static void updateBoundaryConditionData(BoundaryConditionData& bcdata,
+                                            const Problem& problem,
+                                            unsigned globalIndex,
+                                            int /*dirId*/)
+    {
+        const auto [type, massRate] = problem.boundaryCondition(globalIndex, bcdata.facePos,
+                                                                /*timeIdx=*/0);
+        bcdata.type = type;
+        for (unsigned eqIdx = 0; eqIdx < numEq; ++eqIdx)
+            bcdata.massRate[eqIdx] = getValue(massRate[eqIdx]);
+
+        if (type != BCType::FREE)
+            return;
+
+        // the mobilities of the fluids outside of the domain are computed using the
+        // material law parameters of the interior cell
+        bcdata.exFluidState = problem.boundaryFluidState(globalIndex, bcdata.facePos,
+                                                         /*timeIdx=*/0);
+        std::array<Scalar, numPhases> kr;
+        MaterialLaw::relativePermeabilities(kr,
+                                            problem.materialLawParams(globalIndex, /*timeIdx=*/0),
+                                            bcdata.exFluidState);
+        for (unsigned phaseIdx = 0; phaseIdx < numPhases; ++phaseIdx)
+            bcdata.exMobility[phaseIdx] = kr[phaseIdx]/bcdata.exFluidState.viscosity(phaseIdx);
+    }
+
+    /*!
+     * \brief Returns true if there is a flux over a boundary face.
+     */
+    static bool hasBoundaryFlux(const BoundaryConditionData& bcdata)
+    { return bcdata.type != BCType::NONE; }
+
+    /*!
+     * \brief Returns whether the flows and the flores are written for the current
+     *        time step.
+     *
+     * The immiscible model does not write any flows.
+     */
+    static std::pair<bool, bool> flowsOutput(const Problem&)
+    { return {false, false}; }
+
+    /*!
+     * \brief Returns whether the flows and the flores are written for any time step.
+     */
+    static std::pair<bool, bool> anyFlowsOutput(const Problem&)
+    { return {false, false}; }
+
+    /*!
+     * \brief Returns the non-neighbor connections for which flows are written.
+     */
+    static std::unordered_multimap<int, std::pair<int, int>> outputNncIndices(const Problem&)
+    { return {}; }
+
+    /*!
+     * \brief Returns the Cartesian index of a cell which is used by outputNncIndices().
+     */
+    static int cartesianIndex(const Problem&, unsigned globalIndex)
+    { return static_cast<int>(globalIndex); }
+
+    /*!
+     * \brief Compute the storage term of a cell per pore volume.
+     */
+    template <class LhsEval>
+    static void computeStorage(Dune::FieldVector<LhsEval, numEq>& storage,
+                               const IntensiveQuantities& intQuants)
+    {
+        const auto& fs = intQuants.fluidState();
+        storage = 0.0;
+        for (unsigned phaseIdx = 0; phaseIdx < numPhases; ++phaseIdx)
+            storage[conti0EqIdx + phaseIdx] =
+                Toolbox::template decay<LhsEval>(intQuants.porosity())
+                * Toolbox::template decay<LhsEval>(fs.saturation(phaseIdx))
+                * Toolbox::template decay<LhsEval>(fs.density(phaseIdx));
+    }
+
+    /*!
+     * \brief Compute the mass fluxes over an interior face per face area.
+     *
+     * Only the quantities of the interior cell are differentiated.
+     */
+    static void computeFlux(RateVector& flux,
+                            RateVector& darcy,
+                            unsigned globalIndexIn,
+                            unsigned globalIndexEx,
+                            const IntensiveQuantities& intQuantsIn,
+                            const IntensiveQuantities& intQuantsEx,
+                            const ResidualNBInfo& nbInfo,
+                            const ModuleParams&)
+    {
+        calculateFluxes_<Evaluation>(flux, darcy, globalIndexIn, globalIndexEx,
+                                     intQuantsIn, intQuantsEx, nbInfo);
+    }
+
+    /*!
+     * \brief Compute the values of the mass fluxes over an interior face per face
+     *        area without their derivatives.
+     */
+    template <class ScalarVector>
+    static void computeFluxValues(ScalarVector& flux,
+                                  ScalarVector& darcy,
+                                  unsigned globalIndexIn,
+                                  unsigned globalIndexEx,
+                                  const IntensiveQuantities& intQuantsIn,
+                                  const IntensiveQuantities& intQuantsEx,
+                                  const ResidualNBInfo& nbInfo,
+                                  const ModuleParams&)
+    {
+        calculateFluxes_<Scalar>(flux, darcy, globalIndexIn, globalIndexEx,
+                                 intQuantsIn, intQuantsEx, nbInfo);
+    }
+
+    /*!
+     * \brief Compute the mass fluxes over a boundary face per face area.
+     */
+    static void computeBoundaryFlux(RateVector& bdyFlux,
+                                    const Problem&,
+                                    const BoundaryConditionData& bcdata,
+                                    const IntensiveQuantities& insideIntQuants,
+                                    unsigned /*globalSpaceIdx*/)
+    {
+        switch (bcdata.type) {
+        case BCType::NONE:
+            bdyFlux = 0.0;
+            break;
+        case BCType::RATE:
+            for (unsigned eqIdx = 0; eqIdx < numEq; ++eqIdx)
+                bdyFlux[eqIdx] = bcdata.massRate[eqIdx];
+            break;
+        case BCType::FREE:
+            computeBoundaryFluxFree_(bdyFlux, bcdata, insideIntQuants);
+            break;
+        default:
+            throw std::logic_error("Unsupported type of boundary condition "
+                                   + std::to_string(static_cast<int>(bcdata.type))
+                                   + " for the immiscible model");
+        }
+    }
+
+    /*!
+     * \brief Compute the source term of a cell per volume.
+     */
+    static void computeSource(RateVector& source,
+                              const Problem& problem,
+                              unsigned globalSpaceIdx,
+                              unsigned timeIdx)
+    { problem.source(source, globalSpaceIdx, timeIdx); }
+
+    /*!
+     * \brief Compute the source term of a cell per volume.
+     *
+     * The immiscible model does not have any sparse source terms, so this is the same
+     * as computeSource().
+     */
+    static void computeSourceDense(RateVector& source,
+                                   const Problem& problem,
+                                   unsigned globalSpaceIdx,
+                                   unsigned timeIdx)
+    { computeSource(source, problem, globalSpaceIdx, timeIdx); }
+
+private:
+    // the transmissibility per face area between the center of a cell and one of its
+    // faces. like TransFluxModule, this only supports permeabilities which are
+    // aligned with the grid.
+    template <class DimMatrix>
+    static Scalar halfTransmissibility_(const DimMatrix& K,
+                                        const GlobalPosition& normal,
+                                        const GlobalPosition& distVec)
+    {
+        unsigned idx = 0;
+        Scalar val = 0.0;
+        for (unsigned i = 0; i < dimWorld; ++i) {
+            if (std::abs(normal[i]) > val) {
+                val = std::abs(normal[i]);
+                idx = i;
+            }
+        }
+
+        return K[idx][idx]*std::abs(normal*distVec)/(distVec*distVec);
+    }
+
+    // if the pressures are equal, the cell with the larger volume is upstream and if
+    // the volumes are equal as well, the one with the smaller global index is.
+    template <class LhsEval>
+    static bool interiorIsUpstream_(const LhsEval& pressureDifference,
+                                    unsigned globalIndexIn,
+                                    unsigned globalIndexEx,
+                                    const ResidualNBInfo& nbInfo)
+    {
+        if (pressureDifference > 0.0)
+            return false;
+        else if (pressureDifference < 0.0)
+            return true;
+        else if (nbInfo.Vin != nbInfo.Vex)
+            return nbInfo.Vin > nbInfo.Vex;
+
+        return globalIndexIn < globalIndexEx;
+    }
+
+    template <class LhsEval, class FluxVector>
+    static void calculateFluxes_(FluxVector& flux,
+                                 FluxVector& darcy,
+                                 unsigned globalIndexIn,
+                                 unsigned globalIndexEx,
+                                 const IntensiveQuantities& intQuantsIn,
+                                 const IntensiveQuantities& intQuantsEx,
+                                 const ResidualNBInfo& nbInfo)
+    {
+        const auto& fsIn = intQuantsIn.fluidState();
+        const auto& fsEx = intQuantsEx.fluidState();
+
+        flux = 0.0;
+        darcy = 0.0;
+        for (unsigned phaseIdx = 0; phaseIdx < numPhases; ++phaseIdx) {
+            // if the phase is immobile in both cells, it does not flow
+            if (intQuantsIn.mobility(phaseIdx) <= 0.0 && intQuantsEx.mobility(phaseIdx) <= 0.0)
+                continue;
+
+            // do the gravity correction: compute the hydrostatic pressure of the
+            // exterior cell at the depth of the interior one
+            const LhsEval rhoIn = Toolbox::template decay<LhsEval>(fsIn.density(phaseIdx));
+            const Scalar rhoEx = Toolbox::value(fsEx.density(phaseIdx));
+            const LhsEval rhoAvg = (rhoIn + rhoEx)/2;
+
+            const LhsEval pressureDifference =
+                Toolbox::value(fsEx.pressure(phaseIdx)) + rhoAvg*nbInfo.dZg
+                - Toolbox::template decay<LhsEval>(fsIn.pressure(phaseIdx));
+
+            LhsEval volumeFlux;
+            if (interiorIsUpstream_(pressureDifference, globalIndexIn, globalIndexEx, nbInfo)) {
+                volumeFlux = pressureDifference
+                    * Toolbox::template decay<LhsEval>(intQuantsIn.mobility(phaseIdx))
+                    * (-nbInfo.trans);
+                flux[conti0EqIdx + phaseIdx] = volumeFlux*rhoIn;
+            }
+            else {
+                volumeFlux = pressureDifference
+                    * (Toolbox::value(intQuantsEx.mobility(phaseIdx))*(-nbInfo.trans));
+                flux[conti0EqIdx + phaseIdx] = volumeFlux*rhoEx;
+            }
+            darcy[conti0EqIdx + phaseIdx] = getValue(volumeFlux)*nbInfo.faceArea;
+        }
+    }
+
+    // the flux over a boundary face to a fluid reservoir, see
+    // ImmiscibleBoundaryRateVector::setFreeFlow()
+    static void computeBoundaryFluxFree_(RateVector& bdyFlux,
+                                         const BoundaryConditionData& bcdata,
+                                         const IntensiveQuantities& insideIntQuants)
+    {
+        const auto& fsIn = insideIntQuants.fluidState();
+        const auto& fsEx = bcdata.exFluidState;
+
+        bdyFlux = 0.0;
+        for (unsigned phaseIdx = 0; phaseIdx < numPhases; ++phaseIdx) {
+            // do the gravity correction: compute the hydrostatic pressure of the
+            // fluid reservoir at the depth of the cell
+            const Evaluation& rhoIn = fsIn.density(phaseIdx);
+            const Scalar rhoEx = fsEx.density(phaseIdx);
+            const Evaluation rhoAvg = (rhoIn + rhoEx)/2;
+
+            const Evaluation& pressureIn = fsIn.pressure(phaseIdx);
+            const Scalar pressureEx = fsEx.pressure(phaseIdx);
+            const Evaluation pressureDifference = pressureEx + rhoAvg*bcdata.dZg - pressureIn;
+
+            Evaluation volumeFlux;
+            if (pressureDifference > 0.0)
+                volumeFlux = pressureDifference*(bcdata.exMobility[phaseIdx]*(-bcdata.trans));
+            else
+                volumeFlux = pressureDifference*insideIntQuants.mobility(phaseIdx)*(-bcdata.trans);
+
+            // the density of the side with the higher pressure is used regardless of
+            // the direction of the flow
+            if (pressureEx > pressureIn)
+                bdyFlux[conti0EqIdx + phaseIdx] = volumeFlux*rhoEx;
+            else
+                bdyFlux[conti0EqIdx + phaseIdx] = volumeFlux*rhoIn;
+        }
+    }
+};
+
+} // namespace Opm
+
+#endif
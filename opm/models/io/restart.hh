@@ -27,18 +27,199 @@
 #ifndef EWOMS_RESTART_HH
 #define EWOMS_RESTART_HH
 
-#include <string>
+#include <opm/models/utils/basicparameters.hh>
+#include <opm/models/utils/parametersystem.hh>
+
+#include <algorithm>
+#include <cassert>
+#include <cctype>
+#include <cstdio>
+#include <cstdint>
+#include <cstring>
 #include <fstream>
 #include <iostream>
 #include <sstream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 namespace Opm {
 
+/*!
+ * \brief Output stream for entity data of binary restart files.
+ *
+ * This exhibits the subset of the std::ostream interface which is used by the
+ * serializeEntity() methods of the models. Floating point values are stored as
+ * doubles and integers as 64 bit integers, both in native byte order. Strings may
+ * only be written as separators, i.e., they must only consist of whitespace.
+ */
+class BinaryRestartOStream
+{
+public:
+    explicit BinaryRestartOStream(std::string& buffer)
+        : buffer_(buffer)
+    {}
+
+    bool good() const
+    { return true; }
+
+    template <class T>
+    BinaryRestartOStream& operator<<(const T& value)
+    {
+        if constexpr (std::is_floating_point_v<T>)
+            write_(static_cast<double>(value));
+        else if constexpr (std::is_integral_v<T> || std::is_enum_v<T>)
+            write_(static_cast<std::int64_t>(value));
+        else {
+            static_assert(std::is_convertible_v<const T&, std::string_view>,
+                          "Only numbers can be written to binary restart files");
+            const std::string_view sep(value);
+            if (!std::all_of(sep.begin(), sep.end(),
+                             [](char c) { return std::isspace(static_cast<unsigned char>(c)); }))
+                throw std::logic_error("Only numbers can be written to binary restart files");
+        }
+
+        return *this;
+    }
+
+private:
+    template <class T>
+    void write_(T value)
+    { buffer_.append(reinterpret_cast<const char*>(&value), sizeof(value)); }
+
+    std::string& buffer_;
+};
+
+/*!
+ * \brief Input stream for entity data of binary restart files.
+ *
+ * This is the counterpart of BinaryRestartOStream. The data is read directly from
+ * memory, i.e., usually from the memory mapped restart file.
+ */
+class BinaryRestartIStream
+{
+public:
+    BinaryRestartIStream(const char* begin, const char* end)
+        : pos_(begin)
+        , end_(end)
+    {}
+
+    /*!
+     * \brief Returns false if an attempt was made to read beyond the end of the data.
+     */
+    bool good() const
+    { return !failed_; }
+
+    /*!
+     * \brief Returns a pointer to the first byte which has not been read yet.
+     */
+    const char* position() const
+    { return pos_; }
+
+    template <class T>
+    BinaryRestartIStream& operator>>(T& value)
+    {
+        if constexpr (std::is_floating_point_v<T>)
+            value = static_cast<T>(read_<double>());
+        else {
+            static_assert(std::is_integral_v<T> || std::is_enum_v<T>,
+                          "Only numbers can be read from binary restart files");
+            value = static_cast<T>(read_<std::int64_t>());
+        }
+
+        return *this;
+    }
+
+private:
+    template <class T>
+    T read_()
+    {
+        T value{};
+        if (failed_ || static_cast<std::size_t>(end_ - pos_) < sizeof(value)) {
+            failed_ = true;
+            return value;
+        }
+
+        std::memcpy(&value, pos_, sizeof(value));
+        pos_ += sizeof(value);
+        return value;
+    }
+
+    const char* pos_;
+    const char* end_;
+    bool failed_ = false;
+};
+
 /*!
  * \brief Load or save a state of a problem to/from the harddisk.
+ *
+ * Two file formats are supported: The text format (file extension <tt>.ers</tt>)
+ * and a binary one (file extension <tt>.erb</tt>). Which one is written is specified
+ * by the RestartFormat parameter. When reading, the file of the configured format is
+ * loaded. Only if it does not exist, the file of the other format is used.
+ *
+ * A binary restart file starts with an eight byte magic number, the format version
+ * and a flags field (all in native byte order). It is followed by the sections of the
+ * file, each consisting of the section name, the size of the section's data, the data
+ * itself and, if the corresponding flag is set, a checksum of the data. The checksums
+ * are written unless the EnableRestartChecksums parameter is false. The first
+ * section is named after the magic cookie of the text format. The data of entity
+ * sections is written contiguously using BinaryRestartOStream. The data of all other
+ * sections is the text written to serializeStream(). Binary files are memory mapped
+ * for reading, so the data is not copied before it is deserialized.
  */
 class Restart
 {
+    static constexpr char binaryMagic_[8] = {'E', 'W', 'O', 'M', 'S', 'R', 'S', 'T'};
+    static constexpr std::uint32_t binaryVersion_ = 1;
+    static constexpr std::uint32_t checksumFlag_ = 1;
+
+    // encodings of the data of entity sections in binary files
+    static constexpr char binaryEntities_ = 'b';
+    static constexpr char textEntities_ = 't';
+
+    // read-only stream buffer on top of a range of memory
+    class MemoryStreamBuf_ : public std::streambuf
+    {
+    public:
+        void setRange(const char* begin, const char* end)
+        { setg(const_cast<char*>(begin), const_cast<char*>(begin), const_cast<char*>(end)); }
+
+        const char* position() const
+        { return gptr(); }
+
+        const char* end() const
+        { return egptr(); }
+    };
+
+    // find out whether a serializer can write entities to binary streams
+    template <class Serializer, class Entity, class = void>
+    struct HasBinaryEntitySerialization_ : std::false_type {};
+
+    template <class Serializer, class Entity>
+    struct HasBinaryEntitySerialization_<Serializer, Entity,
+                                         std::void_t<decltype(std::declval<Serializer&>()
+                                                              .serializeEntity(std::declval<BinaryRestartOStream&>(),
+                                                                               std::declval<const Entity&>()))>>
+        : std::true_type {};
+
+    template <class Deserializer, class Entity, class = void>
+    struct HasBinaryEntityDeserialization_ : std::false_type {};
+
+    template <class Deserializer, class Entity>
+    struct HasBinaryEntityDeserialization_<Deserializer, Entity,
+                                           std::void_t<decltype(std::declval<Deserializer&>()
+                                                                .deserializeEntity(std::declval<BinaryRestartIStream&>(),
+                                                                                   std::declval<const Entity&>()))>>
+        : std::true_type {};
+
     /*!
      * \brief Create a magic cookie for restart files, so that it is
      *        unlikely to load a restart file for an incorrectly.
@@ -73,7 +254,8 @@ class Restart
     static const std::string restartFileName_(const GridView& gridView,
                                               const std::string& outputDir,
                                               const std::string& simName,
-                                              Scalar t)
+                                              Scalar t,
+                                              bool binary = false)
     {
         std::string dir = outputDir;
         if (dir == ".")
@@ -83,32 +265,82 @@ class Restart
 
         int rank = gridView.comm().rank();
         std::ostringstream oss;
-        oss << dir << simName << "_time=" << t << "_rank=" << rank << ".ers";
+        oss << dir << simName << "_time=" << t << "_rank=" << rank
+            << (binary ? ".erb" : ".ers");
         return oss.str();
     }
 
 public:
+    Restart() = default;
+    Restart(const Restart&) = delete;
+
+    ~Restart()
+    { unmapFile_(); }
+
+    /*!
+     * \brief Register all run-time parameters for the restart files.
+     */
+    static void registerParameters()
+    {
+        Parameters::Register<Parameters::RestartFormat>
+            ("The format of the restart files which are written. Possible values: "
+             "'text', 'binary'");
+        Parameters::Register<Parameters::EnableRestartChecksums>
+            ("Store a checksum of each section of binary restart files and verify it "
+             "when the file is read");
+    }
+
     /*!
      * \brief Returns the name of the file which is (de-)serialized.
      */
     const std::string& fileName() const
     { return fileName_; }
 
+    /*!
+     * \brief Returns true if the restart file uses the binary format.
+     */
+    bool isBinary() const
+    { return binary_; }
+
     /*!
      * \brief Write the current state of the model to disk.
+     *
+     * If `staged` is true, the data is collected in memory instead of being written to
+     * disk directly. It is written later by calling writeStagedData().
      */
     template <class Simulator>
-    void serializeBegin(Simulator& simulator)
+    void serializeBegin(Simulator& simulator, bool staged = false)
     {
+        binary_ = binaryFormatRequested_();
+        flags_ = Parameters::Get<Parameters::EnableRestartChecksums>() ? checksumFlag_ : 0;
+
         const std::string magicCookie = magicRestartCookie_(simulator.gridView());
         fileName_ = restartFileName_(simulator.gridView(),
                                      simulator.problem().outputDir(),
                                      simulator.problem().name(),
-                                     simulator.time());
+                                     simulator.time(),
+                                     binary_);
 
         // open output file and write magic cookie
-        outStream_.open(fileName_.c_str());
-        outStream_.precision(20);
+        staged_ = staged;
+        if (staged_) {
+            stagingBuf_.str("");
+            outStream_.rdbuf(&stagingBuf_);
+        }
+        else {
+            outFile_.open(fileName_.c_str(), binary_ ? std::ios::binary : std::ios::out);
+            outStream_.rdbuf(outFile_.rdbuf());
+        }
+
+        if (binary_) {
+            outStream_.write(binaryMagic_, sizeof(binaryMagic_));
+            writeBinary_(binaryVersion_);
+            writeBinary_(flags_);
+
+            sectionOutStream_.precision(20);
+        }
+        else
+            outStream_.precision(20);
 
         serializeSectionBegin(magicCookie);
         serializeSectionEnd();
@@ -118,19 +350,36 @@ public:
      * \brief The output stream to write the serialized data.
      */
     std::ostream& serializeStream()
-    { return outStream_; }
+    {
+        if (binary_)
+            return sectionOutStream_;
+        return outStream_;
+    }
 
     /*!
      * \brief Start a new section in the serialized output.
      */
     void serializeSectionBegin(const std::string& cookie)
-    { outStream_ << cookie << "\n"; }
+    {
+        if (binary_) {
+            sectionName_ = cookie;
+            sectionOutStream_.str("");
+            sectionOutStream_.clear();
+        }
+        else
+            outStream_ << cookie << "\n";
+    }
 
     /*!
      * \brief End of a section in the serialized output.
      */
     void serializeSectionEnd()
-    { outStream_ << "\n"; }
+    {
+        if (binary_)
+            writeSection_(sectionName_, sectionOutStream_.str());
+        else
+            outStream_ << "\n";
+    }
 
     /*!
      * \brief Serialize all leaf entities of a codim in a gridView.
@@ -143,13 +392,39 @@ public:
         std::ostringstream oss;
         oss << "Entities: Codim " << codim;
         std::string cookie = oss.str();
-        serializeSectionBegin(cookie);
 
         // write element data
         using Iterator = typename GridView::template Codim<codim>::Iterator;
+        using Entity = typename GridView::template Codim<codim>::Entity;
 
         Iterator it = gridView.template begin<codim>();
         const Iterator& endIt = gridView.template end<codim>();
+
+        if (binary_) {
+            std::string data;
+            if constexpr (HasBinaryEntitySerialization_<Serializer, Entity>::value) {
+                data.push_back(binaryEntities_);
+                BinaryRestartOStream binStream(data);
+                for (; it != endIt; ++it)
+                    serializer.serializeEntity(binStream, *it);
+            }
+            else {
+                // the serializer only supports text, i.e., embed a text block
+                std::ostringstream textStream;
+                textStream.precision(20);
+                textStream << textEntities_;
+                for (; it != endIt; ++it) {
+                    serializer.serializeEntity(textStream, *it);
+                    textStream << "\n";
+                }
+                data = textStream.str();
+            }
+
+            writeSection_(cookie, data);
+            return;
+        }
+
+        serializeSectionBegin(cookie);
         for (; it != endIt; ++it) {
             serializer.serializeEntity(outStream_, *it);
             outStream_ << "\n";
@@ -162,7 +437,36 @@ public:
      * \brief Finish the restart file.
      */
     void serializeEnd()
-    { outStream_.close(); }
+    {
+        if (!staged_)
+            outFile_.close();
+    }
+
+    /*!
+     * \brief Write the data of a staged restart file to disk.
+     *
+     * The data is written to a temporary file which gets renamed once it is complete,
+     * so an interrupted write does not leave a truncated restart file behind. Since
+     * this method does not access the simulator, it may be called by a worker thread.
+     */
+    void writeStagedData()
+    {
+        assert(staged_);
+
+        const std::string tmpFileName = fileName_ + ".tmp";
+        {
+            std::ofstream file(tmpFileName.c_str(), std::ios::binary);
+            file << &stagingBuf_;
+            if (!file.good())
+                throw std::runtime_error("Could not write restart file '"+fileName_+"'");
+        }
+
+        if (std::rename(tmpFileName.c_str(), fileName_.c_str()) != 0)
+            throw std::runtime_error("Could not rename '"+tmpFileName+"' to '"+fileName_+"'");
+
+        // release the memory of the staged data
+        stagingBuf_.str("");
+    }
 
     /*!
      * \brief Start reading a restart file at a certain simulated
@@ -171,21 +475,39 @@ public:
     template <class Simulator, class Scalar>
     void deserializeBegin(Simulator& simulator, Scalar t)
     {
-        fileName_ = restartFileName_(simulator.gridView(), simulator.problem().outputDir(), simulator.problem().name(), t);
-
-        // open input file and read magic cookie
-        inStream_.open(fileName_.c_str());
-        if (!inStream_.good()) {
-            throw std::runtime_error("Restart file '"+fileName_+"' could not be opened properly");
-        }
+        // use the file of the configured format. a file of the other format is only
+        // considered if it does not exist, so that a stale file of a previous run which
+        // used the other format does not take precedence.
+        const auto fileName = [&simulator, t](bool binary)
+        {
+            return restartFileName_(simulator.gridView(),
+                                    simulator.problem().outputDir(),
+                                    simulator.problem().name(),
+                                    t,
+                                    binary);
+        };
+        binary_ = binaryFormatRequested_();
+        if (!std::ifstream(fileName(binary_)).good() && std::ifstream(fileName(!binary_)).good())
+            binary_ = !binary_;
+
+        fileName_ = fileName(binary_);
+        if (binary_)
+            mapFile_();
+        else {
+            // open input file and read magic cookie
+            inStream_.open(fileName_.c_str());
+            if (!inStream_.good()) {
+                throw std::runtime_error("Restart file '"+fileName_+"' could not be opened properly");
+            }
 
-        // make sure that we don't open an empty file
-        inStream_.seekg(0, std::ios::end);
-        auto pos = inStream_.tellg();
-        if (pos == 0) {
-            throw std::runtime_error("Restart file '"+fileName_+"' is empty");
+            // make sure that we don't open an empty file
+            inStream_.seekg(0, std::ios::end);
+            auto pos = inStream_.tellg();
+            if (pos == 0) {
+                throw std::runtime_error("Restart file '"+fileName_+"' is empty");
+            }
+            inStream_.seekg(0, std::ios::beg);
         }
-        inStream_.seekg(0, std::ios::beg);
 
         const std::string magicCookie = magicRestartCookie_(simulator.gridView());
 
@@ -198,13 +520,22 @@ public:
      *        deserialized.
      */
     std::istream& deserializeStream()
-    { return inStream_; }
+    {
+        if (binary_)
+            return sectionInStream_;
+        return inStream_;
+    }
 
     /*!
      * \brief Start reading a new section of the restart file.
      */
     void deserializeSectionBegin(const std::string& cookie)
     {
+        if (binary_) {
+            readSection_(cookie);
+            return;
+        }
+
         if (!inStream_.good())
             throw std::runtime_error("Encountered unexpected EOF in restart file.");
         std::string buf;
@@ -218,6 +549,14 @@ public:
      */
     void deserializeSectionEnd()
     {
+        if (binary_) {
+            const bool allRead = std::all_of(sectionInBuf_.position(), sectionInBuf_.end(),
+                                             [](char c) { return std::isspace(static_cast<unsigned char>(c)); });
+            if (!allRead)
+                throw std::logic_error("Encountered unread values while deserializing");
+            return;
+        }
+
         std::string dummy;
         std::getline(inStream_, dummy);
         for (unsigned i = 0; i < dummy.length(); ++i) {
@@ -244,14 +583,50 @@ public:
 
         // read entity data
         using Iterator = typename GridView::template Codim<codim>::Iterator;
+        using Entity = typename GridView::template Codim<codim>::Entity;
         Iterator it = gridView.template begin<codim>();
         const Iterator& endIt = gridView.template end<codim>();
+
+        std::istream* textStream = &inStream_;
+        if (binary_) {
+            const char* begin = sectionInBuf_.position();
+            const char* end = sectionInBuf_.end();
+            if (begin == end)
+                throw std::runtime_error("Restart file is corrupted");
+
+            if (*begin == binaryEntities_) {
+                if constexpr (HasBinaryEntityDeserialization_<Deserializer, Entity>::value) {
+                    BinaryRestartIStream binStream(begin + 1, end);
+                    for (; it != endIt; ++it) {
+                        if (!binStream.good())
+                            throw std::runtime_error("Restart file is corrupted");
+
+                        deserializer.deserializeEntity(binStream, *it);
+                    }
+
+                    if (!binStream.good())
+                        throw std::runtime_error("Restart file is corrupted");
+
+                    sectionInBuf_.setRange(binStream.position(), end);
+                    deserializeSectionEnd();
+                    return;
+                }
+                else
+                    throw std::runtime_error("The deserializer does not support binary entity data");
+            }
+            else if (*begin != textEntities_)
+                throw std::runtime_error("Restart file is corrupted");
+
+            sectionInBuf_.setRange(begin + 1, end);
+            textStream = &sectionInStream_;
+        }
+
         for (; it != endIt; ++it) {
-            if (!inStream_.good()) {
+            if (!textStream->good()) {
                 throw std::runtime_error("Restart file is corrupted");
             }
 
-            std::getline(inStream_, curLine);
+            std::getline(*textStream, curLine);
             std::istringstream curLineStream(curLine);
             deserializer.deserializeEntity(curLineStream, *it);
         }
@@ -263,12 +638,161 @@ public:
      * \brief Stop reading the restart file.
      */
     void deserializeEnd()
-    { inStream_.close(); }
+    {
+        if (binary_)
+            unmapFile_();
+        else
+            inStream_.close();
+    }
 
 private:
+    static bool binaryFormatRequested_()
+    {
+        const std::string format = Parameters::Get<Parameters::RestartFormat>();
+        if (format != "text" && format != "binary")
+            throw std::invalid_argument("Unknown restart file format '"+format+"'");
+        return format == "binary";
+    }
+
+    template <class T>
+    void writeBinary_(const T& value)
+    { outStream_.write(reinterpret_cast<const char*>(&value), sizeof(value)); }
+
+    // 64 bit FNV-1a hash of a range of bytes
+    static std::uint64_t checksum_(const char* begin, const char* end)
+    {
+        std::uint64_t hash = 14695981039346656037ULL;
+        for (; begin != end; ++begin) {
+            hash ^= static_cast<unsigned char>(*begin);
+            hash *= 1099511628211ULL;
+        }
+        return hash;
+    }
+
+    void writeSection_(const std::string& name, const std::string& data)
+    {
+        writeBinary_(static_cast<std::uint32_t>(name.size()));
+        outStream_.write(name.data(), static_cast<std::streamsize>(name.size()));
+        writeBinary_(static_cast<std::uint64_t>(data.size()));
+        outStream_.write(data.data(), static_cast<std::streamsize>(data.size()));
+        if (flags_ & checksumFlag_)
+            writeBinary_(checksum_(data.data(), data.data() + data.size()));
+
+        if (!outStream_.good())
+            throw std::runtime_error("Could not write restart file '"+fileName_+"'");
+    }
+
+    template <class T>
+    T readBinary_()
+    {
+        T value;
+        if (static_cast<std::size_t>(mappedEnd_ - readPos_) < sizeof(value))
+            throw std::runtime_error("Encountered unexpected EOF in restart file.");
+
+        std::memcpy(&value, readPos_, sizeof(value));
+        readPos_ += sizeof(value);
+        return value;
+    }
+
+    void readSection_(const std::string& cookie)
+    {
+        const auto nameSize = readBinary_<std::uint32_t>();
+        if (static_cast<std::size_t>(mappedEnd_ - readPos_) < nameSize)
+            throw std::runtime_error("Encountered unexpected EOF in restart file.");
+        const std::string_view name(readPos_, nameSize);
+        readPos_ += nameSize;
+        if (name != cookie)
+            throw std::runtime_error("Could not start section '"+cookie+"'");
+
+        const auto dataSize = readBinary_<std::uint64_t>();
+        if (static_cast<std::uint64_t>(mappedEnd_ - readPos_) < dataSize)
+            throw std::runtime_error("Encountered unexpected EOF in restart file.");
+        const char* data = readPos_;
+        readPos_ += dataSize;
+
+        if (flags_ & checksumFlag_) {
+            const auto checksum = readBinary_<std::uint64_t>();
+            if (checksum != checksum_(data, data + dataSize))
+                throw std::runtime_error("Checksum mismatch in section '"+cookie+"' of "
+                                         "restart file '"+fileName_+"'");
+        }
+
+        sectionInBuf_.setRange(data, data + dataSize);
+        sectionInStream_.clear();
+    }
+
+    void mapFile_()
+    {
+        int fd = ::open(fileName_.c_str(), O_RDONLY);
+        if (fd < 0)
+            throw std::runtime_error("Restart file '"+fileName_+"' could not be opened properly");
+
+        struct stat fileStat;
+        if (::fstat(fd, &fileStat) != 0 || fileStat.st_size == 0) {
+            ::close(fd);
+            throw std::runtime_error("Restart file '"+fileName_+"' is empty");
+        }
+
+        mappedSize_ = static_cast<std::size_t>(fileStat.st_size);
+        void* addr = ::mmap(nullptr, mappedSize_, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (addr == MAP_FAILED) {
+            mappedSize_ = 0;
+            throw std::runtime_error("Restart file '"+fileName_+"' could not be mapped into memory");
+        }
+
+        mappedData_ = static_cast<const char*>(addr);
+        mappedEnd_ = mappedData_ + mappedSize_;
+        readPos_ = mappedData_;
+
+        // check the header
+        if (mappedSize_ < sizeof(binaryMagic_) ||
+            !std::equal(binaryMagic_, binaryMagic_ + sizeof(binaryMagic_), mappedData_))
+            throw std::runtime_error("Restart file '"+fileName_+"' is not a binary restart file");
+        readPos_ += sizeof(binaryMagic_);
+
+        const auto version = readBinary_<std::uint32_t>();
+        if (version != binaryVersion_)
+            throw std::runtime_error("Restart file '"+fileName_+"' uses the unsupported "
+                                     "format version "+std::to_string(version));
+        flags_ = readBinary_<std::uint32_t>();
+    }
+
+    void unmapFile_()
+    {
+        if (mappedData_)
+            ::munmap(const_cast<char*>(mappedData_), mappedSize_);
+
+        mappedData_ = nullptr;
+        mappedEnd_ = nullptr;
+        readPos_ = nullptr;
+        mappedSize_ = 0;
+    }
+
     std::string fileName_;
     std::ifstream inStream_;
-    std::ofstream outStream_;
+
+    // the stream all output goes to. it either writes to the file or to the
+    // staging buffer.
+    std::ofstream outFile_;
+    std::stringbuf stagingBuf_;
+    std::ostream outStream_{nullptr};
+
+    bool binary_ = false;
+    bool staged_ = false;
+
+    // state for writing binary files
+    std::string sectionName_;
+    std::ostringstream sectionOutStream_;
+
+    // state for reading binary files
+    const char* mappedData_ = nullptr;
+    const char* mappedEnd_ = nullptr;
+    const char* readPos_ = nullptr;
+    std::size_t mappedSize_ = 0;
+    std::uint32_t flags_ = 0;
+    MemoryStreamBuf_ sectionInBuf_;
+    std::istream sectionInStream_{&sectionInBuf_};
 };
 } // namespace Opm
 
@@ -50,8 +50,10 @@
 #include <list>
 #include <string>
 #include <limits>
+#include <type_traits>
 #include <sstream>
 #include <fstream>
+#include <vector>
 
 namespace Opm {
 /*!
@@ -98,10 +100,66 @@ class VtkMultiWriter : public BaseOutputWriter
         VtkMultiWriter& multiWriter_;
     };
 
+    // maps the elements to the indices which are used by the element data buffers.
+    // these are the indices of the grid's index set unless the discretization uses a
+    // different element mapper.
+    class ElementMapper
+    {
+        using GridMapper = Dune::MultipleCodimMultipleGeomTypeMapper<GridView>;
+        using Element = typename GridView::template Codim<0>::Entity;
+
+    public:
+        using Index = typename GridMapper::Index;
+
+        explicit ElementMapper(const GridView& gridView)
+            : gridMapper_(gridView, Dune::mcmgElementLayout())
+        {}
+
+        Index index(const Element& element) const
+        { return translate_(gridMapper_.index(element)); }
+
+        Index subIndex(const Element& element, int i, unsigned codim) const
+        { return translate_(gridMapper_.subIndex(element, i, codim)); }
+
+        Index size() const
+        { return gridMapper_.size(); }
+
+        void update(const GridView& gridView)
+        {
+#if DUNE_VERSION_NEWER(DUNE_GRID, 2, 8)
+            gridMapper_.update(gridView);
+#else
+            static_cast<void>(gridView);
+            gridMapper_.update();
+#endif
+            indices_.clear();
+        }
+
+        template <class Mapper>
+        void setIndices(const GridView& gridView, const Mapper& mapper)
+        {
+            if constexpr (std::is_same_v<Mapper, GridMapper>) {
+                // the indices are the same as the ones of the grid's index set
+                indices_.clear();
+                return;
+            }
+
+            indices_.resize(gridMapper_.size());
+            for (const auto& elem : elements(gridView))
+                indices_[gridMapper_.index(elem)] = static_cast<Index>(mapper.index(elem));
+        }
+
+    private:
+        Index translate_(Index gridIdx) const
+        { return indices_.empty() ? gridIdx : indices_[gridIdx]; }
+
+        GridMapper gridMapper_;
+        std::vector<Index> indices_;
+    };
+
     enum { dim = GridView::dimension };
 
     using VertexMapper = Dune::MultipleCodimMultipleGeomTypeMapper<GridView>;
-    using ElementMapper = Dune::MultipleCodimMultipleGeomTypeMapper<GridView>;
 
 public:
     using Scalar = BaseOutputWriter::Scalar;
@@ -120,7 +178,7 @@ public:
                    const std::string& simName = "",
                    std::string multiFileName = "")
         : gridView_(gridView)
-        , elementMapper_(gridView, Dune::mcmgElementLayout())
+        , elementMapper_(gridView)
         , vertexMapper_(gridView, Dune::mcmgVertexLayout())
         , curWriter_(nullptr)
         , curWriterNum_(0)
@@ -164,15 +222,25 @@ public:
      */
     void gridChanged()
     {
-#if DUNE_VERSION_NEWER(DUNE_GRID, 2, 8)
         elementMapper_.update(gridView_);
+#if DUNE_VERSION_NEWER(DUNE_GRID, 2, 8)
         vertexMapper_.update(gridView_);
 #else
-        elementMapper_.update();
         vertexMapper_.update();
 #endif
     }
 
+    /*!
+     * \brief Specifies the mapper which determines the indices of the element data.
+     *
+     * This is only required if the elements are not indexed like the grid's index set,
+     * e.g. if the discretization uses the RcmElementMapper. It must be called again
+     * after each call to gridChanged().
+     */
+    template <class Mapper>
+    void setElementMapper(const Mapper& mapper)
+    { elementMapper_.setIndices(gridView_, mapper); }
+
     /*!
      * \brief Called whenever a new time step must be written.
      */
@@ -85,32 +85,14 @@ protected:
     void preSolve_(const SolutionVector&,
                    const GlobalEqVector& currentResidual)
     {
-        const auto& constraintsMap = this->model().linearizer().constraintsMap();
         this->lastError_ = this->error_;
 
         // calculate the error as the maximum weighted tolerance of
-        // the solution's residual
-        this->error_ = 0;
-        for (unsigned dofIdx = 0; dofIdx < currentResidual.size(); ++dofIdx) {
-            // do not consider auxiliary DOFs for the error
-            if (dofIdx >= this->model().numGridDof() || this->model().dofTotalVolume(dofIdx) <= 0.0)
-                continue;
-
-            // also do not consider DOFs which are constraint
-            if (this->enableConstraints_()) {
-                if (constraintsMap.count(dofIdx) > 0)
-                    continue;
-            }
-
-            const auto& r = currentResidual[dofIdx];
-            for (unsigned eqIdx = 0; eqIdx < r.size(); ++eqIdx) {
-                if (ncp0EqIdx <= eqIdx && eqIdx < Indices::ncp0EqIdx + numPhases)
-                    continue;
-                this->error_ =
-                    std::max(std::abs(r[eqIdx]*this->model().eqWeight(dofIdx, eqIdx)),
-                             this->error_);
-            }
-        }
+        // the solution's residual. the NCP equations are not considered.
+        this->error_ =
+            this->localResidualError_(currentResidual,
+                                      [](unsigned eqIdx)
+                                      { return eqIdx < ncp0EqIdx || eqIdx >= ncp0EqIdx + numPhases; });
 
         // take the other processes into account
         this->error_ = this->comm_.max(this->error_);
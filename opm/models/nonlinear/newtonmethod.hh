@@ -46,8 +46,13 @@
 
 #include <opm/simulators/linalg/linalgproperties.hh>
 
+#include <algorithm>
+#include <cstddef>
+#include <exception>
 #include <iostream>
+#include <mutex>
 #include <sstream>
+#include <vector>
 
 #include <unistd.h>
 
@@ -104,6 +109,7 @@ class NewtonMethod
     using Linearizer = GetPropType<TypeTag, Properties::Linearizer>;
     using LinearSolverBackend = GetPropType<TypeTag, Properties::LinearSolverBackend>;
     using ConvergenceWriter = GetPropType<TypeTag, Properties::NewtonConvergenceWriter>;
+    using ThreadManager = GetPropType<TypeTag, Properties::ThreadManager>;
 
     using Communicator = typename Dune::MPIHelper::MPICommunicator;
     using CollectiveCommunication = typename Dune::Communication<typename Dune::MPIHelper::MPICommunicator>;
@@ -119,8 +125,12 @@ public:
         lastError_ = 1e100;
         error_ = 1e100;
         tolerance_ = Parameters::Get<Parameters::NewtonTolerance<Scalar>>();
+        jacobianRefreshInterval_ = Parameters::Get<Parameters::NewtonJacobianRefreshInterval>();
+        jacobianRefreshRatio_ = Parameters::Get<Parameters::NewtonJacobianRefreshRatio<Scalar>>();
 
         numIterations_ = 0;
+        iterationsSinceRefresh_ = 0;
+        errorReduction_ = 0.0;
     }
 
     /*!
@@ -146,6 +156,12 @@ public:
         Parameters::Register<Parameters::NewtonMaxError<Scalar>>
             ("The maximum error tolerated by the Newton "
              "method to which does not cause an abort");
+        Parameters::Register<Parameters::NewtonJacobianRefreshInterval>
+            ("The maximum number of Newton iterations which use the same Jacobian "
+             "matrix and preconditioner");
+        Parameters::Register<Parameters::NewtonJacobianRefreshRatio<Scalar>>
+            ("The error reduction of a Newton iteration above which the Jacobian "
+             "matrix is updated for the next iteration");
     }
 
     /*!
@@ -281,10 +297,18 @@ public:
                               << std::flush;
                 }
 
-                // do the actual linearization
+                // do the actual linearization. if the Jacobian matrix of a previous
+                // iteration is reused, only the residual needs to be evaluated
+                const bool refreshJacobian = asImp_().refreshJacobian_();
                 linearizeTimer_.start();
-                asImp_().linearizeDomain_();
-                asImp_().linearizeAuxiliaryEquations_();
+                if (refreshJacobian) {
+                    asImp_().linearizeDomain_();
+                    asImp_().linearizeAuxiliaryEquations_();
+                    iterationsSinceRefresh_ = 0;
+                }
+                else
+                    asImp_().linearizeResidual_();
+                ++iterationsSinceRefresh_;
                 linearizeTimer_.stop();
 
                 solveTimer_.start();
@@ -302,6 +326,12 @@ public:
                 asImp_().preSolve_(currentSolution, residual);
                 updateTimer_.stop();
 
+                // remember how much the error was reduced by the previous update
+                if (numIterations_ > 0 && lastError_ > 0.0)
+                    errorReduction_ = error_/lastError_;
+                else
+                    errorReduction_ = 0.0;
+
                 if (!asImp_().proceed_()) {
                     if (asImp_().verbose_() && isatty(fileno(stdout)))
                         std::cout << clearRemainingLine
@@ -324,8 +354,10 @@ public:
 
                 solveTimer_.start();
                 // solve A x = b, where b is the residual, A is its Jacobian and x is the
-                // update of the solution
-                linearSolver_.setMatrix(jacobian);
+                // update of the solution. the linear solver keeps the previous matrix
+                // and its preconditioner if the Jacobian has not been updated.
+                if (refreshJacobian)
+                    linearSolver_.setMatrix(jacobian);
                 solutionUpdate = 0.0;
                 bool converged = linearSolver_.solve(solutionUpdate);
                 solveTimer_.stop();
@@ -569,31 +601,47 @@ protected:
         model().linearizer().finalize();
     }
 
+    /*!
+     * \brief Evaluate the residual of the global non-linear system of equations without
+     *        updating its Jacobian matrix.
+     */
+    void linearizeResidual_()
+    {
+        model().linearizer().linearizeResidual();
+    }
+
+    /*!
+     * \brief Returns true if the Jacobian matrix needs to be linearized for the current
+     *        iteration.
+     *
+     * The Jacobian is always linearized in the first iteration of a time step. Later
+     * iterations reuse it for at most NewtonJacobianRefreshInterval iterations, or until
+     * an iteration did not reduce the error by at least NewtonJacobianRefreshRatio.
+     * Auxiliary equations are linearized together with their Jacobian, so models with
+     * auxiliary modules always use the regular Newton-Raphson method.
+     */
+    bool refreshJacobian_() const
+    {
+        if (jacobianRefreshInterval_ <= 1 ||
+            numIterations_ == 0 ||
+            model().numAuxiliaryModules() > 0)
+        {
+            return true;
+        }
+
+        return iterationsSinceRefresh_ >= jacobianRefreshInterval_ ||
+               errorReduction_ > jacobianRefreshRatio_;
+    }
+
     void preSolve_(const SolutionVector&,
                    const GlobalEqVector& currentResidual)
     {
-        const auto& constraintsMap = model().linearizer().constraintsMap();
         lastError_ = error_;
         Scalar newtonMaxError = Parameters::Get<Parameters::NewtonMaxError<Scalar>>();
 
         // calculate the error as the maximum weighted tolerance of
         // the solution's residual
-        error_ = 0;
-        for (unsigned dofIdx = 0; dofIdx < currentResidual.size(); ++dofIdx) {
-            // do not consider auxiliary DOFs for the error
-            if (dofIdx >= model().numGridDof() || model().dofTotalVolume(dofIdx) <= 0.0)
-                continue;
-
-            // also do not consider DOFs which are constraint
-            if (enableConstraints_()) {
-                if (constraintsMap.count(dofIdx) > 0)
-                    continue;
-            }
-
-            const auto& r = currentResidual[dofIdx];
-            for (unsigned eqIdx = 0; eqIdx < r.size(); ++eqIdx)
-                error_ = max(std::abs(r[eqIdx] * model().eqWeight(dofIdx, eqIdx)), error_);
-        }
+        error_ = localResidualError_(currentResidual, [](unsigned) { return true; });
 
         // take the other processes into account
         error_ = comm_.max(error_);
@@ -606,6 +654,54 @@ protected:
                                    + std::to_string(double(newtonMaxError)));
     }
 
+    /*!
+     * \brief Returns the maximum of the weighted residual of the grid DOFs of the
+     *        local process.
+     *
+     * Auxiliary DOFs, DOFs without volume and constraint DOFs are not considered.
+     * Equations for which considerEq(eqIdx) returns false are ignored as well.
+     */
+    template <class EqPredicate>
+    Scalar localResidualError_(const GlobalEqVector& currentResidual,
+                               const EqPredicate& considerEq) const
+    {
+        const auto& constraintsMap = model().linearizer().constraintsMap();
+        const bool checkConstraints = enableConstraints_() && !constraintsMap.empty();
+        const int numDof = static_cast<int>(std::min<std::size_t>(currentResidual.size(),
+                                                                  model().numGridDof()));
+
+        // each thread writes its maximum only once to avoid false sharing
+        std::vector<Scalar> threadError(ThreadManager::maxThreads(), 0.0);
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+        {
+            Scalar error = 0.0;
+#ifdef _OPENMP
+#pragma omp for
+#endif
+            for (int dofIdx = 0; dofIdx < numDof; ++dofIdx) {
+                if (model().dofTotalVolume(dofIdx) <= 0.0)
+                    continue;
+
+                if (checkConstraints && constraintsMap.count(dofIdx) > 0)
+                    continue;
+
+                const auto& r = currentResidual[dofIdx];
+                Scalar dofError = 0.0;
+                for (unsigned eqIdx = 0; eqIdx < r.size(); ++eqIdx) {
+                    const Scalar weighted = considerEq(eqIdx) ? std::abs(r[eqIdx] * model().eqWeight(dofIdx, eqIdx)) : 0.0;
+                    dofError = std::max(dofError, weighted);
+                }
+                error = std::max(error, dofError);
+            }
+
+            threadError[ThreadManager::threadId()] = error;
+        }
+
+        return *std::max_element(threadError.begin(), threadError.end());
+    }
+
     /*!
      * \brief Update the error of the solution given the previous
      *        iteration.
@@ -626,10 +722,10 @@ protected:
         // vector.
         auto& model = simulator_.model();
         const auto& comm = simulator_.gridView().comm();
+        bool succeeded = true;
         for (unsigned i = 0; i < model.numAuxiliaryModules(); ++i) {
             auto& auxMod = *model.auxiliaryModule(i);
 
-            bool succeeded = true;
             try {
                 auxMod.postSolve(solutionUpdate);
             }
@@ -640,7 +736,10 @@ protected:
                           << " caught an exception while post processing an auxiliary module:" << e.what()
                           << "\n"  << std::flush;
             }
+        }
 
+        // communicate the status of all auxiliary modules at once
+        if (model.numAuxiliaryModules() > 0) {
             succeeded = comm.min(succeeded);
 
             if (!succeeded)
@@ -677,30 +776,43 @@ protected:
         if (!std::isfinite(solutionUpdate.one_norm()))
             throw NumericalProblem("Non-finite update!");
 
+        // the DOFs are updated independently of each other, so the implementation's
+        // updatePrimaryVariables_() method must be thread-safe
+        const bool checkConstraints = enableConstraints_() && !constraintsMap.empty();
+        std::mutex exceptionLock;
+        std::exception_ptr exceptionPtr = nullptr;
+
         size_t numGridDof = model().numGridDof();
-        for (unsigned dofIdx = 0; dofIdx < numGridDof; ++dofIdx) {
-            if (enableConstraints_()) {
-                if (constraintsMap.count(dofIdx) > 0) {
-                    const auto& constraints = constraintsMap.at(dofIdx);
-                    asImp_().updateConstraintDof_(dofIdx,
-                                                  nextSolution[dofIdx],
-                                                  constraints);
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+        for (int dofIdx = 0; dofIdx < static_cast<int>(numGridDof); ++dofIdx) {
+            try {
+                if (checkConstraints) {
+                    const auto constraintsIt = constraintsMap.find(dofIdx);
+                    if (constraintsIt != constraintsMap.end()) {
+                        asImp_().updateConstraintDof_(dofIdx,
+                                                      nextSolution[dofIdx],
+                                                      constraintsIt->second);
+                        continue;
+                    }
                 }
-                else
-                    asImp_().updatePrimaryVariables_(dofIdx,
-                                                     nextSolution[dofIdx],
-                                                     currentSolution[dofIdx],
-                                                     solutionUpdate[dofIdx],
-                                                     currentResidual[dofIdx]);
-            }
-            else
+
                 asImp_().updatePrimaryVariables_(dofIdx,
                                                  nextSolution[dofIdx],
                                                  currentSolution[dofIdx],
                                                  solutionUpdate[dofIdx],
                                                  currentResidual[dofIdx]);
+            }
+            catch (...) {
+                std::lock_guard<std::mutex> take(exceptionLock);
+                exceptionPtr = std::current_exception();
+            }
         }
 
+        if (exceptionPtr)
+            std::rethrow_exception(exceptionPtr);
+
         // update the DOFs of the auxiliary equations
         size_t numDof = model().numTotalDof();
         for (size_t dofIdx = numGridDof; dofIdx < numDof; ++dofIdx) {
@@ -858,6 +970,14 @@ protected:
     // actual number of iterations done so far
     int numIterations_;
 
+    // the reuse of the Jacobian matrix: the maximum number of iterations per Jacobian,
+    // the maximum tolerated error reduction per iteration, the number of iterations
+    // since the Jacobian was linearized and the error reduction of the last iteration
+    int jacobianRefreshInterval_;
+    Scalar jacobianRefreshRatio_;
+    int iterationsSinceRefresh_;
+    Scalar errorReduction_;
+
     // the linear solver
     LinearSolverBackend linearSolver_;
 
@@ -33,6 +33,23 @@ struct NewtonMaxError { static constexpr Scalar value = 1e100; };
 //! Number of maximum iterations for the Newton method.
 struct NewtonMaxIterations { static constexpr int value = 20; };
 
+/*!
+ * \brief The maximum number of Newton iterations which use the same Jacobian matrix.
+ *
+ * In between, only the residual is evaluated and the linear solver reuses its
+ * preconditioner. The default of 1 corresponds to the regular Newton-Raphson method.
+ */
+struct NewtonJacobianRefreshInterval { static constexpr int value = 1; };
+
+/*!
+ * \brief The error reduction of a Newton iteration above which the Jacobian matrix is
+ *        linearized again for the next iteration.
+ *
+ * This only has an effect if NewtonJacobianRefreshInterval is larger than 1.
+ */
+template<class Scalar>
+struct NewtonJacobianRefreshRatio { static constexpr Scalar value = 0.5; };
+
 /*!
  * \brief The number of iterations at which the Newton method
  *        should aim at.
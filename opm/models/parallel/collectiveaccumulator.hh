@@ -0,0 +1,250 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ * \copydoc Opm::CollectiveAccumulator
+ */
+#ifndef EWOMS_COLLECTIVE_ACCUMULATOR_HH
+#define EWOMS_COLLECTIVE_ACCUMULATOR_HH
+
+#if HAVE_MPI
+#include <mpi.h>
+#endif
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <type_traits>
+#include <vector>
+
+namespace Opm {
+
+/*!
+ * \brief Reduces several values over all processes using a single collective
+ *        operation.
+ *
+ * Each value is registered together with the operation which is used to combine it
+ * with the values of the other processes, i.e., the minimum, the maximum or the sum.
+ * Status flags are typically reduced using the minimum and counters using the sum.
+ * All processes must register the same sequence of operations.
+ *
+ * \code
+ * CollectiveAccumulator collectives(gridView.comm());
+ * const auto succeededIdx = collectives.addMin(succeeded);
+ * const auto numSwitchedIdx = collectives.addSum(numSwitched);
+ * collectives.reduce();
+ * if (!collectives[succeededIdx]) ...
+ * \endcode
+ *
+ * The values are reduced as double precision numbers, so integers are represented
+ * exactly as long as their magnitude does not exceed 2^53. If the reduction is started
+ * using reduceBegin(), local computations can be carried out until reduceEnd() is
+ * called.
+ */
+class CollectiveAccumulator
+{
+public:
+    enum class Operation { Min, Max, Sum };
+
+    /*!
+     * \brief Create an accumulator for the processes of a collective communication.
+     *
+     * Communication objects which are not convertible to an MPI communicator are
+     * considered to be sequential.
+     */
+    template <class Communication>
+    explicit CollectiveAccumulator([[maybe_unused]] const Communication& comm)
+    {
+#if HAVE_MPI
+        if constexpr (std::is_convertible_v<Communication, MPI_Comm>) {
+            if (comm.size() > 1)
+                mpiComm_ = static_cast<MPI_Comm>(comm);
+        }
+#endif // HAVE_MPI
+    }
+
+    CollectiveAccumulator(const CollectiveAccumulator&) = delete;
+
+    ~CollectiveAccumulator()
+    {
+        // a reduction must always be finished
+        assert(!inProgress_);
+    }
+
+    /*!
+     * \brief Register a value and return its index.
+     */
+    std::size_t add(Operation op, double value)
+    {
+        assert(!inProgress_);
+        slots_.push_back(static_cast<double>(op));
+        slots_.push_back(value);
+        return slots_.size()/2 - 1;
+    }
+
+    /*!
+     * \brief Register a value which is reduced using the minimum over all processes.
+     */
+    std::size_t addMin(double value)
+    { return add(Operation::Min, value); }
+
+    /*!
+     * \brief Register a value which is reduced using the maximum over all processes.
+     */
+    std::size_t addMax(double value)
+    { return add(Operation::Max, value); }
+
+    /*!
+     * \brief Register a value which is reduced using the sum over all processes.
+     */
+    std::size_t addSum(double value)
+    { return add(Operation::Sum, value); }
+
+    /*!
+     * \brief Returns the number of registered values.
+     */
+    std::size_t size() const
+    { return slots_.size()/2; }
+
+    /*!
+     * \brief Start the reduction of all registered values.
+     *
+     * The values must not be accessed until reduceEnd() has been called.
+     */
+    void reduceBegin()
+    {
+        assert(!inProgress_);
+        inProgress_ = true;
+#if HAVE_MPI
+        if (mpiComm_ != MPI_COMM_NULL && !slots_.empty())
+            MPI_Iallreduce(MPI_IN_PLACE,
+                           slots_.data(),
+                           static_cast<int>(size()),
+                           mpiSlotType_(),
+                           mpiOperation_(),
+                           mpiComm_,
+                           &request_);
+#endif // HAVE_MPI
+    }
+
+    /*!
+     * \brief Wait until the reduction of the registered values is finished.
+     */
+    void reduceEnd()
+    {
+        assert(inProgress_);
+#if HAVE_MPI
+        if (mpiComm_ != MPI_COMM_NULL && !slots_.empty())
+            MPI_Wait(&request_, MPI_STATUS_IGNORE);
+#endif // HAVE_MPI
+        inProgress_ = false;
+    }
+
+    /*!
+     * \brief Reduce all registered values.
+     */
+    void reduce()
+    {
+        reduceBegin();
+        reduceEnd();
+    }
+
+    /*!
+     * \brief Returns a registered value.
+     *
+     * After a reduction, this is the value reduced over all processes.
+     */
+    double operator[](std::size_t idx) const
+    {
+        assert(!inProgress_);
+        assert(idx < size());
+        return slots_[2*idx + 1];
+    }
+
+    /*!
+     * \brief Remove all registered values.
+     */
+    void clear()
+    {
+        assert(!inProgress_);
+        slots_.clear();
+    }
+
+private:
+#if HAVE_MPI
+    // the operation of each value is stored in front of it. Since all processes
+    // register the same operations, these entries are never modified.
+    static void reduceSlots_(void* in, void* inout, int* len, MPI_Datatype*)
+    {
+        const double* inSlots = static_cast<const double*>(in);
+        double* inoutSlots = static_cast<double*>(inout);
+        for (int i = 0; i < *len; ++i) {
+            double& value = inoutSlots[2*i + 1];
+            switch (static_cast<Operation>(inoutSlots[2*i])) {
+            case Operation::Min:
+                value = std::min(value, inSlots[2*i + 1]);
+                break;
+            case Operation::Max:
+                value = std::max(value, inSlots[2*i + 1]);
+                break;
+            case Operation::Sum:
+                value += inSlots[2*i + 1];
+                break;
+            }
+        }
+    }
+
+    // an (operation, value) pair is a single element for MPI, so that the
+    // operation is never separated from its value
+    static MPI_Datatype mpiSlotType_()
+    {
+        static const MPI_Datatype type = [] {
+            MPI_Datatype result;
+            MPI_Type_contiguous(2, MPI_DOUBLE, &result);
+            MPI_Type_commit(&result);
+            return result;
+        }();
+        return type;
+    }
+
+    static MPI_Op mpiOperation_()
+    {
+        static const MPI_Op op = [] {
+            MPI_Op result;
+            MPI_Op_create(&reduceSlots_, /*commute=*/1, &result);
+            return result;
+        }();
+        return op;
+    }
+
+    MPI_Comm mpiComm_ = MPI_COMM_NULL;
+    MPI_Request request_ = MPI_REQUEST_NULL;
+#endif // HAVE_MPI
+
+    std::vector<double> slots_;
+    bool inProgress_ = false;
+};
+
+} // namespace Opm
+
+#endif
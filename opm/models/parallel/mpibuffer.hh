@@ -66,13 +66,17 @@ public:
     MpiBuffer(const MpiBuffer&) = default;
 
     ~MpiBuffer()
-    { delete[] data_; }
+    {
+        freePersistentRequest_();
+        delete[] data_;
+    }
 
     /*!
      * \brief Set the size of the buffer
      */
     void resize(size_t newSize)
     {
+        freePersistentRequest_();
         delete[] data_;
         data_ = new DataType[newSize];
         dataSize_ = newSize;
@@ -85,6 +89,7 @@ public:
     void send([[maybe_unused]] unsigned peerRank)
     {
 #if HAVE_MPI
+        assert(!persistent_);
         MPI_Isend(data_,
                   static_cast<int>(mpiDataSize_),
                   mpiDataType_,
@@ -95,6 +100,61 @@ public:
 #endif
     }
 
+    /*!
+     * \brief Create a persistent request which sends the buffer to a peer process.
+     *
+     * The communication is initiated by each call to start() and completed by wait().
+     * The request remains valid until the buffer is resized or destroyed.
+     */
+    void sendInit([[maybe_unused]] unsigned peerRank)
+    {
+#if HAVE_MPI
+        freePersistentRequest_();
+        MPI_Send_init(data_,
+                      static_cast<int>(mpiDataSize_),
+                      mpiDataType_,
+                      static_cast<int>(peerRank),
+                      0, // tag
+                      MPI_COMM_WORLD,
+                      &mpiRequest_);
+        persistent_ = true;
+#endif // HAVE_MPI
+    }
+
+    /*!
+     * \brief Create a persistent request which receives the buffer from a peer process.
+     *
+     * The communication is initiated by each call to start() and completed by wait().
+     * The request remains valid until the buffer is resized or destroyed.
+     */
+    void receiveInit([[maybe_unused]] unsigned peerRank)
+    {
+#if HAVE_MPI
+        freePersistentRequest_();
+        MPI_Recv_init(data_,
+                      static_cast<int>(mpiDataSize_),
+                      mpiDataType_,
+                      static_cast<int>(peerRank),
+                      0, // tag
+                      MPI_COMM_WORLD,
+                      &mpiRequest_);
+        persistent_ = true;
+#endif // HAVE_MPI
+    }
+
+    /*!
+     * \brief Initiate the communication of a persistent request.
+     *
+     * The request must have been created by sendInit() or receiveInit().
+     */
+    void start()
+    {
+#if HAVE_MPI
+        assert(persistent_);
+        MPI_Start(&mpiRequest_);
+#endif // HAVE_MPI
+    }
+
     /*!
      * \brief Wait until the buffer was send to the peer completely.
      */
@@ -111,6 +171,7 @@ public:
     void receive([[maybe_unused]] unsigned peerRank)
     {
 #if HAVE_MPI
+        assert(!persistent_);
         MPI_Recv(data_,
                  static_cast<int>(mpiDataSize_),
                  mpiDataType_,
@@ -125,14 +186,18 @@ public:
     /*!
      * \brief Returns the current MPI_Request object.
      *
-     * This object is only well defined after the send() method.
+     * This object is only well defined after the send() method or if the buffer
+     * exhibits a persistent request. The handle of a persistent request does not
+     * change if the request is started or completed.
      */
     MPI_Request& request()
     { return mpiRequest_; }
     /*!
      * \brief Returns the current MPI_Request object.
      *
-     * This object is only well defined after the send() method.
+     * This object is only well defined after the send() method or if the buffer
+     * exhibits a persistent request. The handle of a persistent request does not
+     * change if the request is started or completed.
      */
     const MPI_Request& request() const
     { return mpiRequest_; }
@@ -214,6 +279,21 @@ private:
 #endif // HAVE_MPI
     }
 
+    void freePersistentRequest_()
+    {
+#if HAVE_MPI
+        if (!persistent_)
+            return;
+
+        // the buffers may outlive MPI if they are kept by static objects
+        int finalized;
+        MPI_Finalized(&finalized);
+        if (!finalized)
+            MPI_Request_free(&mpiRequest_);
+        persistent_ = false;
+#endif // HAVE_MPI
+    }
+
     void updateMpiDataSize_()
     {
 #if HAVE_MPI
@@ -230,6 +310,7 @@ private:
     MPI_Datatype mpiDataType_;
     MPI_Request mpiRequest_;
     MPI_Status mpiStatus_;
+    bool persistent_ = false;
 #endif // HAVE_MPI
 };
 
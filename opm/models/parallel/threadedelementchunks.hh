@@ -0,0 +1,208 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ * \copydoc Opm::ThreadedElementChunks
+ */
+#ifndef EWOMS_THREADED_ELEMENT_CHUNKS_HH
+#define EWOMS_THREADED_ELEMENT_CHUNKS_HH
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace Opm {
+
+/*!
+ * \brief Partitions the elements of a GridView into chunks which are processed by
+ *        OpenMP threads without any global lock.
+ *
+ * The seeds of the elements are determined once and split into chunks of consecutive
+ * elements. Each thread initially owns a contiguous range of chunks. Once a thread has
+ * processed all of its own chunks, it steals chunks from the ranges of the other
+ * threads. Claiming a chunk only requires a single atomic increment, so in contrast to
+ * ThreadedEntityIterator there is no mutex that must be taken for every element.
+ *
+ * The object itself is not modified by a parallel loop, i.e., it can be kept around
+ * for as long as the grid does not change.
+ */
+template <class GridView>
+class ThreadedElementChunks
+{
+    using Element = typename GridView::template Codim<0>::Entity;
+    using ElementSeed = typename Element::EntitySeed;
+
+    // pad the per-thread counters to avoid false sharing
+    struct alignas(64) ChunkCounter
+    {
+        std::atomic<std::size_t> value{0};
+    };
+
+public:
+    /*!
+     * \brief Create the chunks for all elements of a grid view.
+     *
+     * \param gridView The grid view which is to be iterated over
+     * \param numThreads The number of threads which the chunks are distributed to
+     * \param chunkSize The number of elements which are processed by a thread at a time
+     */
+    ThreadedElementChunks(const GridView& gridView,
+                          unsigned numThreads,
+                          std::size_t chunkSize = 128)
+        : gridView_(gridView)
+        , numThreads_(std::max(numThreads, 1u))
+        , chunkSize_(std::max<std::size_t>(chunkSize, 1))
+    {
+        seeds_.reserve(gridView.size(/*codim=*/0));
+        for (const auto& elem : elements(gridView))
+            seeds_.push_back(elem.seed());
+
+        // distribute the chunks as evenly as possible amongst the threads
+        const std::size_t numChunks = (seeds_.size() + chunkSize_ - 1)/chunkSize_;
+        threadBegin_.resize(numThreads_ + 1);
+        for (unsigned threadId = 0; threadId <= numThreads_; ++threadId)
+            threadBegin_[threadId] = (numChunks*threadId)/numThreads_;
+    }
+
+    /*!
+     * \brief Returns the total number of elements.
+     */
+    std::size_t size() const
+    { return seeds_.size(); }
+
+    /*!
+     * \brief Returns the number of chunks.
+     */
+    std::size_t numChunks() const
+    { return threadBegin_.back(); }
+
+    /*!
+     * \brief Call a functor for all elements using all available threads.
+     *
+     * The functor is called as `f(element, threadId)`, where `threadId` is the index of
+     * the OpenMP thread which processes the element. This allows the functor to use
+     * thread-local objects such as element contexts. If the functor throws in any
+     * thread, the remaining chunks are skipped and one of the exceptions is rethrown
+     * once all threads are finished.
+     *
+     * ATTENTION: This method must be called in a sequential context!
+     */
+    template <class Functor>
+    void forEachParallel(Functor&& f) const
+    { forEachParallel(std::forward<Functor>(f), [](const Element&) {}); }
+
+    /*!
+     * \brief Call a functor for all elements using all available threads and give
+     *        the caller a chance to prefetch the data of the next element.
+     *
+     * Before `f` is called for an element, `prefetch(nextElement)` is called for the
+     * element which the same thread processes next within the current chunk.
+     *
+     * ATTENTION: This method must be called in a sequential context!
+     */
+    template <class Functor, class PrefetchFunctor>
+    void forEachParallel(Functor&& f, PrefetchFunctor&& prefetch) const
+    {
+        std::vector<ChunkCounter> nextChunk(numThreads_);
+        for (unsigned threadId = 0; threadId < numThreads_; ++threadId)
+            nextChunk[threadId].value = threadBegin_[threadId];
+
+        std::atomic<bool> failed{false};
+        std::mutex exceptionLock;
+        std::exception_ptr exceptionPtr = nullptr;
+
+        const auto& grid = gridView_.grid();
+        // the chunks were distributed for numThreads_ threads, so the team must not be
+        // larger than that
+#ifdef _OPENMP
+#pragma omp parallel num_threads(numThreads_)
+#endif
+        {
+            unsigned threadId = 0;
+#ifdef _OPENMP
+            threadId = static_cast<unsigned>(omp_get_thread_num());
+#endif
+            try {
+                std::size_t chunkIdx = claimChunk_(nextChunk, threadId);
+                for (; chunkIdx < numChunks() && !failed; chunkIdx = claimChunk_(nextChunk, threadId)) {
+                    const std::size_t begin = chunkIdx*chunkSize_;
+                    const std::size_t end = std::min(begin + chunkSize_, seeds_.size());
+                    for (std::size_t elemIdx = begin; elemIdx < end; ++elemIdx) {
+                        if (elemIdx + 1 < end)
+                            prefetch(grid.entity(seeds_[elemIdx + 1]));
+
+                        const auto elem = grid.entity(seeds_[elemIdx]);
+                        f(elem, threadId);
+                    }
+                }
+            }
+            catch (...) {
+                std::lock_guard<std::mutex> take(exceptionLock);
+                exceptionPtr = std::current_exception();
+                failed = true;
+            }
+        }
+
+        if (exceptionPtr)
+            std::rethrow_exception(exceptionPtr);
+    }
+
+private:
+    // get the next chunk to be processed by a thread: take the next one of the
+    // thread's own range and steal one from the other threads once it is exhausted.
+    std::size_t claimChunk_(std::vector<ChunkCounter>& nextChunk, unsigned threadId) const
+    {
+        for (unsigned i = 0; i < numThreads_; ++i) {
+            const unsigned victimId = (threadId + i) % numThreads_;
+            auto& counter = nextChunk[victimId].value;
+
+            // avoid the atomic increment if the range is known to be exhausted
+            if (counter.load(std::memory_order_relaxed) >= threadBegin_[victimId + 1])
+                continue;
+
+            const std::size_t chunkIdx = counter.fetch_add(1, std::memory_order_relaxed);
+            if (chunkIdx < threadBegin_[victimId + 1])
+                return chunkIdx;
+        }
+
+        return numChunks();
+    }
+
+    GridView gridView_;
+    unsigned numThreads_;
+    std::size_t chunkSize_;
+    std::vector<ElementSeed> seeds_;
+    std::vector<std::size_t> threadBegin_;
+};
+
+} // namespace Opm
+
+#endif
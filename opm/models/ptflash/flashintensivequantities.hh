@@ -110,9 +110,9 @@ public:
         const auto& priVars = elemCtx.primaryVars(dofIdx, timeIdx);
         const auto& problem = elemCtx.problem();
 
-        const Scalar flashTolerance = Parameters::Get<Parameters::FlashTolerance<Scalar>>();
-        const int flashVerbosity = Parameters::Get<Parameters::FlashVerbosity>();
-        const std::string flashTwoPhaseMethod = Parameters::Get<Parameters::FlashTwoPhaseMethod>();
+        const Scalar flashTolerance = Parameters::GetCached<Parameters::FlashTolerance<Scalar>>();
+        const int flashVerbosity = Parameters::GetCached<Parameters::FlashVerbosity>();
+        const std::string& flashTwoPhaseMethod = Parameters::GetCached<Parameters::FlashTwoPhaseMethod>();
 
         // extract the total molar densities of the components
         ComponentVector z(0.);
@@ -370,6 +370,17 @@ public:
      */
     void updateFailed()
     {
+        // the discretization only compares the values of the primary variables when
+        // deciding which intensive quantities need to be recalculated
+        const auto& curSol = this->solution(/*timeIdx=*/0);
+        const auto& prevSol = this->solution(/*timeIdx=*/1);
+        for (unsigned dofIdx = 0; dofIdx < curSol.size(); ++dofIdx) {
+            if (curSol[dofIdx].phasePresence() != prevSol[dofIdx].phasePresence())
+                this->setIntensiveQuantitiesCacheEntryValidity(dofIdx,
+                                                               /*timeIdx=*/0,
+                                                               /*valid=*/false);
+        }
+
         ParentType::updateFailed();
         numSwitched_ = 0;
     }
@@ -463,8 +474,8 @@ public:
     /*!
      * \copydoc FvBaseDiscretization::serializeEntity
      */
-    template <class DofEntity>
-    void serializeEntity(std::ostream& outstream, const DofEntity& dofEntity)
+    template <class OutStream, class DofEntity>
+    void serializeEntity(OutStream& outstream, const DofEntity& dofEntity)
     {
         // write primary variables
         ParentType::serializeEntity(outstream, dofEntity);
@@ -479,8 +490,8 @@ public:
     /*!
      * \copydoc FvBaseDiscretization::deserializeEntity
      */
-    template <class DofEntity>
-    void deserializeEntity(std::istream& instream, const DofEntity& dofEntity)
+    template <class InStream, class DofEntity>
+    void deserializeEntity(InStream& instream, const DofEntity& dofEntity)
     {
         // read primary variables
         ParentType::deserializeEntity(instream, dofEntity);
@@ -530,11 +541,19 @@ public:
 
                     // evaluate primary variable switch
                     short oldPhasePresence = priVars.phasePresence();
+                    const PrimaryVariables oldPriVars(priVars);
 
                     // set the primary variables and the new phase state
                     // from the current fluid state
                     priVars.assignNaive(intQuants.fluidState());
 
+                    // the Newton method only invalidates the cached intensive
+                    // quantities of the degrees of freedom which it changed
+                    if (oldPhasePresence != priVars.phasePresence() || !(oldPriVars == priVars))
+                        this->setIntensiveQuantitiesCacheEntryValidity(globalIdx,
+                                                                       /*timeIdx=*/0,
+                                                                       /*valid=*/false);
+
                     if (oldPhasePresence != priVars.phasePresence()) {
                         if (verbosity_ > 1)
                             printSwitchedPhases_(elemCtx,
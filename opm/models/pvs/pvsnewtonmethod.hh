@@ -73,6 +73,13 @@ protected:
     friend NewtonMethod<TypeTag>;
     friend ParentType;
 
+    /*!
+     * \copydoc FvBaseNewtonMethod::primaryVarsMeaningChanged_
+     */
+    bool primaryVarsMeaningChanged_(const PrimaryVariables& nextValue,
+                                    const PrimaryVariables& currentValue) const
+    { return nextValue.phasePresence() != currentValue.phasePresence(); }
+
     /*!
      * \copydoc FvBaseNewtonMethod::updatePrimaryVariables_
      */
@@ -78,6 +78,15 @@ struct PrintParameters { static constexpr int value = 2; };
 template<class Scalar>
 struct RestartTime { static constexpr Scalar value = -1e35; };
 
+//! The format of the restart files which are written ("text" or "binary")
+struct RestartFormat { static constexpr auto value = "text"; };
+
+//! Store a checksum of each section of binary restart files
+struct EnableRestartChecksums { static constexpr bool value = true; };
+
+//! Write restart files in a separate thread while the simulation proceeds
+struct EnableAsyncRestartOutput { static constexpr bool value = false; };
+
 } // namespace Opm:Parameters
 
 #endif
@@ -39,12 +39,14 @@
 #include <dune/common/classname.hh>
 #include <dune/common/parametertree.hh>
 
+#include <atomic>
 #include <charconv>
 #include <cstdlib>
 #include <fstream>
 #include <iostream>
 #include <list>
 #include <map>
+#include <mutex>
 #include <set>
 #include <sstream>
 #include <stdexcept>
@@ -121,6 +123,25 @@ struct ParamInfo
 template <class Param>
 auto Get(bool errorIfNotRegistered = true);
 
+/*!
+ * \ingroup Parameter
+ *
+ * \brief Retrieve a runtime parameter from a typed snapshot of the parameter values.
+ *
+ * In contrast to Get(), this does not construct the parameter's name, query the
+ * registry or parse any string if the parameter was already retrieved since the last
+ * time the parameter values were modified. The value is resolved once and then
+ * returned by reference, i.e., this is meant for code which is called for each
+ * degree of freedom or face.
+ *
+ * The snapshot is invalidated whenever the parameter values change via the functions
+ * of the parameter system (parsing the command line or a parameter file, changing
+ * defaults, resetting the parameters). Code which modifies the parameter tree
+ * directly must call invalidateCachedValues().
+ */
+template <class Param>
+const auto& GetCached();
+
 /*!
  * \ingroup Parameter
  *
@@ -177,12 +198,24 @@ struct MetaData
     static bool& registrationOpen()
     { return storage_().registrationOpen; }
 
+    //! The number of times the parameter values were changed so far
+    static unsigned generation()
+    { return storage_().generation; }
+
+    //! Mark all values of the parameter snapshot as out of date
+    static void invalidateCachedValues()
+    { ++storage_().generation; }
+
+    static std::mutex& cacheMutex()
+    { return storage_().cacheMutex; }
+
     static void clear()
     {
         storage_().tree = std::make_unique<Dune::ParameterTree>();
         storage_().finalizers.clear();
         storage_().registrationOpen = true;
         storage_().registry.clear();
+        invalidateCachedValues();
     }
 
 private:
@@ -202,6 +235,9 @@ private:
         std::map<std::string, ParamInfo> registry;
         std::list<std::unique_ptr<ParamRegFinalizerBase_>> finalizers;
         bool registrationOpen;
+        // starts at one because the entries of the snapshot are initialized to zero
+        unsigned generation = 1;
+        std::mutex cacheMutex;
     };
 
     static Storage_& storage_()
@@ -680,6 +716,7 @@ std::string parseCommandLineOptions(int argc,
 
         // Put the key=value pair into the parameter tree
         MetaData::tree()[paramName] = paramValue;
+        MetaData::invalidateCachedValues();
     }
     return "";
 }
@@ -745,6 +782,7 @@ inline void parseParameterFile(const std::string& fileName, bool overwrite = tru
         // all went well, add the parameter to the database object
         if (overwrite || !MetaData::tree().hasKey(canonicalKey)) {
             MetaData::tree()[canonicalKey] = value;
+            MetaData::invalidateCachedValues();
         }
     }
 }
@@ -898,6 +936,57 @@ auto SetDefault(decltype(Param::value) new_value)
     std::ostringstream oss;
     oss << new_value;
     MetaData::mutableRegistry()[paramName].defaultValue = oss.str();
+    MetaData::invalidateCachedValues();
+}
+
+namespace detail {
+
+//! The snapshot entry of a single parameter
+template <class Param>
+struct CachedParam
+{
+    using ParamType = std::conditional_t<std::is_same_v<decltype(Param::value),
+                                                        const char* const>, std::string,
+                                         std::remove_const_t<decltype(Param::value)>>;
+
+    static CachedParam& instance()
+    {
+        static CachedParam obj;
+        return obj;
+    }
+
+    ParamType value{};
+    std::atomic<unsigned> generation{0};
+};
+
+} // namespace detail
+
+template <class Param>
+const auto& GetCached()
+{
+    auto& entry = detail::CachedParam<Param>::instance();
+    const unsigned curGeneration = MetaData::generation();
+    if (entry.generation.load(std::memory_order_acquire) != curGeneration) {
+        // the slow path: resolve the value. since this might be done concurrently by
+        // multiple threads, it needs to be serialized.
+        std::lock_guard<std::mutex> lock(MetaData::cacheMutex());
+        if (entry.generation.load(std::memory_order_relaxed) != curGeneration) {
+            entry.value = Get<Param>();
+            entry.generation.store(curGeneration, std::memory_order_release);
+        }
+    }
+
+    return entry.value;
+}
+
+/*!
+ * \brief Mark all values of the parameter snapshot used by GetCached() as out of date.
+ *
+ * This only needs to be called if the parameter tree is modified directly.
+ */
+inline void invalidateCachedValues()
+{
+    MetaData::invalidateCachedValues();
 }
 
 /*!
@@ -1057,6 +1146,7 @@ inline void endRegistration()
     }
 
     MetaData::registrationOpen() = false;
+    MetaData::invalidateCachedValues();
 
     // loop over all parameters and retrieve their values to make sure
     // that there is no syntax error
@@ -29,6 +29,7 @@
 #define EWOMS_SIMULATOR_HH
 
 #include <opm/models/io/restart.hh>
+#include <opm/models/parallel/tasklets.hh>
 #include <opm/models/utils/parametersystem.hh>
 
 #include <opm/models/utils/basicproperties.hh>
@@ -46,6 +47,7 @@
 #include <vector>
 #include <string>
 #include <memory>
+#include <stdexcept>
 
 namespace Opm
 {
@@ -263,6 +265,10 @@ public:
         Parameters::Register<Parameters::PredeterminedTimeStepsFile>
             ("A file with a list of predetermined time step sizes (one "
              "time step per line)");
+        Parameters::Register<Parameters::EnableAsyncRestartOutput>
+            ("Write restart files in a separate thread while the simulation "
+             "proceeds. At most one restart file is written at a time.");
+        Restart::registerParameters();
 
         Vanguard::registerParameters();
         Model::registerParameters();
@@ -810,6 +816,11 @@ public:
         }
         executionTimer_.stop();
 
+        // make sure that the last restart file has been completely written
+        writeTimer_.start();
+        EWOMS_CATCH_PARALLEL_EXCEPTIONS_FATAL(waitForRestartOutput_());
+        writeTimer_.stop();
+
         EWOMS_CATCH_PARALLEL_EXCEPTIONS_FATAL(problem_->finalize());
     }
 
@@ -905,18 +916,33 @@ public:
      */
     void serialize()
     {
+        const bool asyncOutput = Parameters::Get<Parameters::EnableAsyncRestartOutput>();
+        if (asyncOutput) {
+            // only a single restart file may be in flight at any time
+            waitForRestartOutput_();
+            if (!restartTaskletRunner_)
+                restartTaskletRunner_ = std::make_unique<TaskletRunner>(/*numWorkers=*/1);
+        }
+
         using Restarter = Restart;
-        Restarter res;
-        res.serializeBegin(*this);
+        auto res = std::make_unique<Restarter>();
+        res->serializeBegin(*this, /*staged=*/asyncOutput);
         if (gridView().comm().rank() == 0)
-            std::cout << "Serialize to file '" << res.fileName() << "'"
+            std::cout << "Serialize to file '" << res->fileName() << "'"
                       << ", next time step size: " << timeStepSize()
                       << "\n" << std::flush;
 
-        this->serialize(res);
-        problem_->serialize(res);
-        model_->serialize(res);
-        res.serializeEnd();
+        this->serialize(*res);
+        problem_->serialize(*res);
+        model_->serialize(*res);
+        res->serializeEnd();
+
+        // the state of the simulation has been captured by the restart object, so the
+        // data can be written to disk while the simulation proceeds
+        if (asyncOutput) {
+            pendingRestartTasklet_ = std::make_shared<WriteRestartTasklet_>(std::move(res));
+            restartTaskletRunner_->dispatch(pendingRestartTasklet_);
+        }
     }
 
     /*!
@@ -976,6 +1002,61 @@ public:
     }
 
 private:
+    // writes the data of a staged restart file to disk
+    //
+    // The outcome is kept by the tasklet itself instead of the failure flag of the
+    // tasklet runner: the latter is never cleared, so a single failed write would
+    // otherwise be reported again for every later restart file.
+    class WriteRestartTasklet_ : public TaskletInterface
+    {
+    public:
+        explicit WriteRestartTasklet_(std::unique_ptr<Restart> restart)
+            : restart_(std::move(restart))
+        {}
+
+        void run() final
+        {
+            try {
+                restart_->writeStagedData();
+            }
+            catch (const std::exception& e) {
+                errorMessage_ = e.what();
+                failed_ = true;
+            }
+            catch (...) {
+                errorMessage_ = "unknown error";
+                failed_ = true;
+            }
+        }
+
+        // only valid after the tasklet runner has passed a barrier
+        bool failed() const
+        { return failed_; }
+
+        const std::string& errorMessage() const
+        { return errorMessage_; }
+
+    private:
+        std::unique_ptr<Restart> restart_;
+        std::string errorMessage_;
+        bool failed_ = false;
+    };
+
+    // wait until the restart file which is currently written asynchronously is
+    // complete and report if writing it failed
+    void waitForRestartOutput_()
+    {
+        if (!restartTaskletRunner_)
+            return;
+
+        restartTaskletRunner_->barrier();
+
+        // each write is reported at most once
+        auto tasklet = std::move(pendingRestartTasklet_);
+        if (tasklet && tasklet->failed())
+            throw std::runtime_error("Writing a restart file failed: " + tasklet->errorMessage());
+    }
+
     std::unique_ptr<Vanguard> vanguard_;
     std::unique_ptr<Model> model_;
     std::unique_ptr<Problem> problem_;
@@ -992,6 +1073,9 @@ private:
     Timer updateTimer_;
     Timer writeTimer_;
 
+    std::unique_ptr<TaskletRunner> restartTaskletRunner_;
+    std::shared_ptr<WriteRestartTasklet_> pendingRestartTasklet_;
+
     std::vector<Scalar> forcedTimeSteps_;
     Scalar startTime_;
     Scalar time_;
@@ -38,6 +38,10 @@
 
 #include <iostream>
 #include <algorithm>
+#include <map>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
 
 namespace Opm {
 namespace Linear {
@@ -105,11 +109,12 @@ public:
     void print() const
     {
         std::cout << "my own blacklisted indices:\n";
-        auto idxIt = nativeBlackListedIndices_.begin();
-        const auto& idxEndIt = nativeBlackListedIndices_.end();
-        for (; idxIt != idxEndIt; ++idxIt)
-            std::cout << " (native index: " << *idxIt
-                      << ", domestic index: " << nativeToDomestic(*idxIt) << ")\n";
+        std::vector<Index> blackListedIndices(nativeBlackListedIndices_.begin(),
+                                              nativeBlackListedIndices_.end());
+        std::sort(blackListedIndices.begin(), blackListedIndices.end());
+        for (const Index nativeIdx : blackListedIndices)
+            std::cout << " (native index: " << nativeIdx
+                      << ", domestic index: " << nativeToDomestic(nativeIdx) << ")\n";
         std::cout << "blacklisted indices of the peers in my own domain:\n";
         auto peerListIt = peerBlackLists_.begin();
         const auto& peerListEndIt = peerBlackLists_.end();
@@ -161,6 +166,7 @@ private:
 
         MpiBuffer<Index> globalIdxBuf(2*numIndices);
         globalIdxBuf.receive(peerRank);
+        nativeToDomesticMap_.reserve(nativeToDomesticMap_.size() + numIndices);
         for (unsigned i = 0; i < numIndices; ++i) {
             Index globalIdx = globalIdxBuf[2*i + 0];
             Index nativeIdx = globalIdxBuf[2*i + 1];
@@ -170,8 +176,8 @@ private:
     }
 #endif // HAVE_MPI
 
-    std::set<Index> nativeBlackListedIndices_;
-    std::map<Index, Index> nativeToDomesticMap_;
+    std::unordered_set<Index> nativeBlackListedIndices_;
+    std::unordered_map<Index, Index> nativeToDomesticMap_;
 #if HAVE_MPI
     std::map<ProcessRank, MpiBuffer<unsigned>> numGlobalIdxSendBuff_;
     std::map<ProcessRank, MpiBuffer<Index>> globalIdxSendBuff_;
@@ -38,8 +38,11 @@
 #include <dune/istl/operators.hh>
 
 #include <algorithm>
+#include <cstdint>
 #include <iostream>
 #include <map>
+#include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
 #if HAVE_MPI
@@ -90,14 +93,19 @@ public:
 
         // calculate the set of local indices on the border (beware:
         // _not_ the native ones)
+        isLocalBorder_.resize(numLocal(), false);
         auto it = borderList.begin();
         const auto& endIt = borderList.end();
         for (; it != endIt; ++it) {
+            // the first entry of the border list for a given index and peer
+            // determines the index of the peer
+            peerIndices_.emplace(peerIndexKey_(it->localIdx, it->peerRank), it->peerIdx);
+
             Index localIdx = nativeToLocal(it->localIdx);
             if (localIdx < 0)
                 continue;
 
-            localBorderIndices_.insert(localIdx);
+            isLocalBorder_[static_cast<unsigned>(localIdx)] = true;
         }
 
         // compute the set of processes which are neighbors of the
@@ -147,7 +155,11 @@ public:
      * \brief Returns true iff a local index is a border index.
      */
     bool isBorder(Index localIdx) const
-    { return localBorderIndices_.count(localIdx) > 0; }
+    {
+        return 0 <= localIdx
+            && static_cast<size_t>(localIdx) < isLocalBorder_.size()
+            && isLocalBorder_[static_cast<unsigned>(localIdx)];
+    }
 
     /*!
      * \brief Returns true iff a local index is a border index shared with a
@@ -453,16 +465,17 @@ protected:
 
     Index localToPeerIdx_(Index localIdx, ProcessRank peerRank) const
     {
-        auto it = borderList_.begin();
-        const auto& endIt = borderList_.end();
-        for (; it != endIt; ++it) {
-            if (it->localIdx == localIdx && it->peerRank == peerRank)
-                return it->peerIdx;
-        }
+        const auto it = peerIndices_.find(peerIndexKey_(localIdx, peerRank));
+        if (it == peerIndices_.end())
+            return -1;
 
-        return -1;
+        return it->second;
     }
 
+    // combines an index and a process rank into a single key for hashing
+    static std::uint64_t peerIndexKey_(Index idx, ProcessRank peerRank)
+    { return (static_cast<std::uint64_t>(static_cast<std::uint32_t>(idx)) << 32) | peerRank; }
+
     template <class BCRSMatrix>
     void addNonNeighborOverlapIndices_(const BCRSMatrix&,
                                        [[maybe_unused]] SeedList& seedList,
@@ -542,6 +555,11 @@ protected:
             indicesSendBufs[neighborPeer].send(neighborPeer);
         }
 
+        // the (index, peer rank) pairs which are already in the seed list
+        std::unordered_set<std::uint64_t> seedKeys;
+        for (const auto& seed : seedList)
+            seedKeys.insert(peerIndexKey_(seed.index, seed.peerRank));
+
         // receive all data from the neighbors
         std::map<ProcessRank, MpiBuffer<unsigned> > numIndicesRcvBufs;
         std::map<ProcessRank, MpiBuffer<BorderIndex> > indicesRcvBufs;
@@ -576,16 +594,7 @@ protected:
                     continue;
 
                 // make sure the index is not already in the seed list
-                bool inSeedList = false;
-                auto seedIt = seedList.begin();
-                const auto& seedEndIt = seedList.end();
-                for (; seedIt != seedEndIt; ++seedIt) {
-                    if (seedIt->index == localIdx && seedIt->peerRank == peerRank) {
-                        inSeedList = true;
-                        break;
-                    }
-                }
-                if (inSeedList)
+                if (!seedKeys.insert(peerIndexKey_(localIdx, peerRank)).second)
                     continue;
 
                 IndexRankDist seedEntry;
@@ -679,9 +688,13 @@ protected:
     // index
     std::vector<ProcessRank> masterRank_;
 
-    // set of all local indices which are on the border of some remote
-    // process
-    std::set<Index> localBorderIndices_;
+    // specifies for each local index whether it is on the border of some
+    // remote process
+    std::vector<bool> isLocalBorder_;
+
+    // the index on the peer process for each (index, peer rank) pair of the
+    // border list
+    std::unordered_map<std::uint64_t, Index> peerIndices_;
 
     // stores the set of process ranks which are in the overlap for a
     // given row index "owned" by the current rank. The second value
@@ -0,0 +1,364 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ * \copydoc Opm::Linear::FusedBiCGStabSolver
+ */
+#ifndef EWOMS_FUSED_BICGSTAB_SOLVER_HH
+#define EWOMS_FUSED_BICGSTAB_SOLVER_HH
+
+#include <dune/common/ftraits.hh>
+#include <dune/common/timer.hh>
+#include <dune/common/parallel/mpitraits.hh>
+#include <dune/istl/operators.hh>
+#include <dune/istl/preconditioner.hh>
+#include <dune/istl/solver.hh>
+
+#if HAVE_MPI
+#include <mpi.h>
+#endif
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <complex>
+#include <cstddef>
+#include <iomanip>
+#include <iostream>
+
+namespace Opm {
+namespace Linear {
+
+/*!
+ * \brief A preconditioned stabilized BiCG solver which only waits for two global
+ *        reductions per iteration.
+ *
+ * The textbook BiCGStab algorithm computes four scalar products per iteration, and the
+ * convergence check adds one norm per half step. Each of these is a global reduction,
+ * i.e., a synchronization point for all processes. This solver arranges them such that
+ * only two reductions per iteration need to be waited for:
+ *
+ * - \f$(r, r)\f$ does not depend on the next SpMV, so its reduction is started before
+ *   the preconditioner and the SpMV which compute \f$v\f$. It is the residual norm of
+ *   the previous iteration, which is checked one SpMV late. The approximate solution
+ *   is not modified before this check.
+ * - After this SpMV: \f$(\hat{r}_0, v)\f$.
+ * - Likewise, the reduction of \f$(s, s)\f$ is started before the preconditioner and
+ *   the SpMV which compute \f$t\f$.
+ * - After this SpMV: \f$(t, t)\f$, \f$(t, s)\f$, \f$(\hat{r}_0, s)\f$ and
+ *   \f$(\hat{r}_0, t)\f$. The next \f$\rho\f$ then follows from
+ *   \f$(\hat{r}_0, s - \omega t) = (\hat{r}_0, s) - \omega (\hat{r}_0, t)\f$. The half
+ *   step update of the solution is computed while this reduction is in flight.
+ *
+ * With MPI, all reductions are non-blocking.
+ *
+ * Residual norms are always computed from the actual vectors and not from recurrences,
+ * so the convergence check is as accurate as the one of Dune::BiCGSTABSolver. The
+ * price is one extra preconditioner application and SpMV in the last iteration.
+ *
+ * The scalar product must provide the local part of a scalar product via
+ * `localDot(x, y)` and the collective communication object it sums over via
+ * `communication()`; OverlappingScalarProduct does both.
+ */
+template <class Vector, class ScalarProduct>
+class FusedBiCGStabSolver : public Dune::InverseOperator<Vector, Vector>
+{
+    using field_type = typename Vector::field_type;
+    using real_type = typename Dune::FieldTraits<field_type>::real_type;
+    using LinearOperator = Dune::LinearOperator<Vector, Vector>;
+    using Preconditioner = Dune::Preconditioner<Vector, Vector>;
+
+public:
+    FusedBiCGStabSolver(LinearOperator& linearOperator,
+                        ScalarProduct& scalarProduct,
+                        Preconditioner& preconditioner,
+                        real_type reduction,
+                        int maxIterations,
+                        int verbosity)
+        : linearOperator_(linearOperator)
+        , scalarProduct_(scalarProduct)
+        , preconditioner_(preconditioner)
+        , reduction_(reduction)
+        , maxIterations_(maxIterations)
+        , verbosity_(verbosity)
+    {}
+
+    /*!
+     * \copydoc Dune::InverseOperator::category()
+     */
+    Dune::SolverCategory::Category category() const override
+    { return linearOperator_.category(); }
+
+    /*!
+     * \brief Solve the system Ax = b.
+     *
+     * The right hand side is overwritten by the residual.
+     */
+    void apply(Vector& x, Vector& b, double reduction, Dune::InverseOperatorResult& res) override
+    {
+        const real_type savedReduction = reduction_;
+        reduction_ = static_cast<real_type>(reduction);
+        apply(x, b, res);
+        reduction_ = savedReduction;
+    }
+
+    /*!
+     * \brief Solve the system Ax = b.
+     *
+     * The right hand side is overwritten by the residual.
+     */
+    void apply(Vector& x, Vector& b, Dune::InverseOperatorResult& res) override
+    {
+        res.clear();
+        Dune::Timer watch;
+
+        Vector& r = b;
+        linearOperator_.applyscaleadd(-1.0, x, r); // r = b - Ax
+
+        Vector r0hat(r);
+        Vector p(x);
+        Vector v(x);
+        Vector y(x);
+        Vector s(x);
+        Vector z(x);
+        Vector t(x);
+
+        Reduction_<1> initialSums{{ scalarProduct_.localDot(r, r) }};
+        startReduction_(initialSums);
+        finishReduction_(initialSums);
+
+        const real_type def0 = std::sqrt(std::max<real_type>(std::real(initialSums.values[0]), 0.0));
+        real_type def = def0;
+        if (verbosity_ > 0)
+            std::cout << "=== FusedBiCGStabSolver\n";
+        if (verbosity_ > 1)
+            printDefect_(0, def);
+
+        if (!(def0 > 0.0)) {
+            finish_(res, watch, /*iterations=*/0, def0, def, /*converged=*/true);
+            return;
+        }
+
+        preconditioner_.pre(x, r);
+
+        field_type rho = initialSums.values[0];
+        field_type alpha = 1.0;
+        field_type omega = 1.0;
+
+        int it = 0;
+        for (; it < maxIterations_; ++it) {
+            // the norm of the current residual. it is only needed after the next SpMV,
+            // so the reduction is in flight while the preconditioner and the SpMV are
+            // applied. in the first iteration, it is already known.
+            Reduction_<1> sumsR{{ rho }};
+            if (it > 0) {
+                sumsR.values[0] = scalarProduct_.localDot(r, r);
+                startReduction_(sumsR);
+            }
+
+            // p = r + beta*(p - omega*v)
+            if (it == 0)
+                p = r;
+            else {
+                if (std::abs(rho) < breakdownLimit_(def0)) {
+                    // breakdown: r is orthogonal to r0hat
+                    finishReduction_(sumsR);
+                    break;
+                }
+
+                p.axpy(-omega, v);
+                p *= (rho/rhoOld_)*(alpha/omega);
+                p += r;
+            }
+
+            // v = A K^-1 p
+            y = 0.0;
+            preconditioner_.apply(y, p);
+            linearOperator_.apply(y, v);
+
+            Reduction_<1> sumsV{{ scalarProduct_.localDot(r0hat, v) }};
+            startReduction_(sumsV);
+            finishReduction_(sumsR);
+            finishReduction_(sumsV);
+
+            def = std::sqrt(std::max<real_type>(std::real(sumsR.values[0]), 0.0));
+            if (it > 0 && verbosity_ > 1)
+                printDefect_(it, def);
+            if (def < reduction_*def0) {
+                finish_(res, watch, it, def0, def, /*converged=*/true);
+                preconditioner_.post(x);
+                return;
+            }
+
+            if (std::abs(sumsV.values[0]) < breakdownLimit_(def0)) {
+                // breakdown: (r0hat, v) vanishes
+                break;
+            }
+            alpha = rho/sumsV.values[0];
+
+            // s = r - alpha*v
+            s = r;
+            s.axpy(-alpha, v);
+
+            // like the one of r, the norm of s is reduced while the preconditioner and
+            // the SpMV are applied
+            Reduction_<1> sumsS{{ scalarProduct_.localDot(s, s) }};
+            startReduction_(sumsS);
+
+            // t = A K^-1 s
+            z = 0.0;
+            preconditioner_.apply(z, s);
+            linearOperator_.apply(z, t);
+
+            // the half step of the solution does not depend on the result of the
+            // reduction, so it is computed while the reduction is in flight
+            Reduction_<4> sumsT{{ scalarProduct_.localDot(t, t),
+                                  scalarProduct_.localDot(t, s),
+                                  scalarProduct_.localDot(r0hat, s),
+                                  scalarProduct_.localDot(r0hat, t) }};
+            startReduction_(sumsT);
+            x.axpy(alpha, y);
+            finishReduction_(sumsS);
+            finishReduction_(sumsT);
+
+            def = std::sqrt(std::max<real_type>(std::real(sumsS.values[0]), 0.0));
+            if (verbosity_ > 1)
+                printDefect_(it + 0.5, def);
+            if (def < reduction_*def0) {
+                r = s;
+                finish_(res, watch, it + 1, def0, def, /*converged=*/true);
+                preconditioner_.post(x);
+                return;
+            }
+
+            if (std::abs(sumsT.values[0]) < breakdownLimit_(def0)) {
+                // breakdown: t vanishes although s does not
+                r = s;
+                ++it;
+                break;
+            }
+            omega = sumsT.values[1]/sumsT.values[0];
+
+            // x += omega*z, r = s - omega*t
+            x.axpy(omega, z);
+            r = s;
+            r.axpy(-omega, t);
+
+            rhoOld_ = rho;
+            rho = sumsT.values[2] - omega*sumsT.values[3];
+        }
+
+        // either the maximum number of iterations has been reached or the method broke
+        // down. the true norm of the residual is not known at this point, but the
+        // caller only needs to know that the solver did not converge.
+        finish_(res, watch, it, def0, def, /*converged=*/false);
+        preconditioner_.post(x);
+    }
+
+private:
+    // the local contributions to some scalar products and the request of their
+    // non-blocking global reduction. several reductions may be in flight at once.
+    template <std::size_t n>
+    struct Reduction_
+    {
+        std::array<field_type, n> values;
+#if HAVE_MPI
+        MPI_Request request = MPI_REQUEST_NULL;
+#endif
+    };
+
+    template <std::size_t n>
+    void startReduction_(Reduction_<n>& reduction)
+    {
+#if HAVE_MPI
+        const auto& comm = scalarProduct_.communication();
+        if (comm.size() > 1)
+            MPI_Iallreduce(MPI_IN_PLACE,
+                           reduction.values.data(),
+                           static_cast<int>(n),
+                           Dune::MPITraits<field_type>::getType(),
+                           MPI_SUM,
+                           comm,
+                           &reduction.request);
+#else
+        static_cast<void>(reduction);
+#endif
+    }
+
+    template <std::size_t n>
+    void finishReduction_(Reduction_<n>& reduction)
+    {
+#if HAVE_MPI
+        // waiting for MPI_REQUEST_NULL returns immediately
+        MPI_Wait(&reduction.request, MPI_STATUS_IGNORE);
+#else
+        static_cast<void>(reduction);
+#endif
+    }
+
+    static real_type breakdownLimit_(real_type def0)
+    { return 1e-40*def0*def0; }
+
+    void printDefect_(double it, real_type def) const
+    {
+        std::cout << std::setw(8) << it << " "
+                  << std::setw(12) << std::scientific << def << "\n";
+    }
+
+    void finish_(Dune::InverseOperatorResult& res,
+                 const Dune::Timer& watch,
+                 int iterations,
+                 real_type def0,
+                 real_type def,
+                 bool converged) const
+    {
+        res.iterations = iterations;
+        res.converged = converged;
+        res.reduction = (def0 > 0.0) ? static_cast<double>(def/def0) : 0.0;
+        res.conv_rate = (iterations > 0 && def0 > 0.0)
+            ? std::pow(res.reduction, 1.0/iterations)
+            : 0.0;
+        res.elapsed = watch.elapsed();
+
+        if (verbosity_ > 0)
+            std::cout << "=== rate=" << res.conv_rate
+                      << ", T=" << res.elapsed
+                      << ", TIT=" << res.elapsed/std::max(iterations, 1)
+                      << ", IT=" << iterations
+                      << (converged ? "" : " (not converged)") << "\n";
+    }
+
+    LinearOperator& linearOperator_;
+    ScalarProduct& scalarProduct_;
+    Preconditioner& preconditioner_;
+    real_type reduction_;
+    int maxIterations_;
+    int verbosity_;
+
+    field_type rhoOld_ = 1.0;
+};
+
+} // namespace Linear
+} // namespace Opm
+
+#endif
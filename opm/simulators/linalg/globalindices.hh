@@ -32,11 +32,14 @@
 #include <dune/istl/scalarproducts.hh>
 #include <dune/istl/operators.hh>
 
+#include <opm/models/parallel/mpibuffer.hh>
+
 #include <algorithm>
-#include <set>
-#include <map>
+#include <cassert>
+#include <cstddef>
 #include <iostream>
-#include <tuple>
+#include <unordered_map>
+#include <vector>
 
 #if HAVE_MPI
 #include <mpi.h>
@@ -56,8 +59,8 @@ class GlobalIndices
 {
     GlobalIndices(const GlobalIndices& ) = delete;
 
-    using GlobalToDomesticMap = std::map<Index, Index>;
-    using DomesticToGlobalMap = std::map<Index, Index>;
+    using GlobalToDomesticMap = std::unordered_map<Index, Index>;
+    using DomesticToGlobalMap = std::vector<Index>;
 
 public:
     GlobalIndices(const ForeignOverlap& foreignOverlap)
@@ -87,9 +90,10 @@ public:
      */
     Index domesticToGlobal(Index domesticIdx) const
     {
-        assert(domesticToGlobal_.find(domesticIdx) != domesticToGlobal_.end());
+        assert(0 <= domesticIdx && static_cast<size_t>(domesticIdx) < domesticToGlobal_.size());
+        assert(domesticToGlobal_[static_cast<size_t>(domesticIdx)] >= 0);
 
-        return domesticToGlobal_.find(domesticIdx)->second;
+        return domesticToGlobal_[static_cast<size_t>(domesticIdx)];
     }
 
     /*!
@@ -126,55 +130,20 @@ public:
      */
     void addIndex(Index domesticIdx, Index globalIdx)
     {
-        domesticToGlobal_[domesticIdx] = globalIdx;
-        globalToDomestic_[globalIdx] = domesticIdx;
-        numDomestic_ = domesticToGlobal_.size();
+        assert(domesticIdx >= 0 && globalIdx >= 0);
+        const auto domIdx = static_cast<size_t>(domesticIdx);
+        if (domIdx >= domesticToGlobal_.size())
+            domesticToGlobal_.resize(std::max(domIdx + 1, foreignOverlap_.numLocal()), -1);
 
-        assert(domesticToGlobal_.size() == globalToDomestic_.size());
-    }
+        if (domesticToGlobal_[domIdx] < 0)
+            ++numDomestic_;
+        else
+            globalToDomestic_.erase(domesticToGlobal_[domIdx]);
 
-    /*!
-     * \brief Send a border index to a remote process.
-     */
-    void sendBorderIndex([[maybe_unused]] ProcessRank peerRank,
-                         [[maybe_unused]] Index domesticIdx,
-                         [[maybe_unused]] Index peerLocalIdx)
-    {
-#if HAVE_MPI
-        PeerIndexGlobalIndex sendBuf;
-        sendBuf.peerIdx = peerLocalIdx;
-        sendBuf.globalIdx = domesticToGlobal(domesticIdx);
-        MPI_Send(&sendBuf,                     // buff
-                 sizeof(PeerIndexGlobalIndex), // count
-                 MPI_BYTE,                     // data type
-                 static_cast<int>(peerRank),   // peer process
-                 0,                            // tag
-                 MPI_COMM_WORLD);              // communicator
-#endif
-    }
+        domesticToGlobal_[domIdx] = globalIdx;
+        globalToDomestic_[globalIdx] = domesticIdx;
 
-    /*!
-     * \brief Receive an index on the border from a remote
-     *        process and add it the translation maps.
-     */
-    void receiveBorderIndex([[maybe_unused]] ProcessRank peerRank)
-    {
-#if HAVE_MPI
-        PeerIndexGlobalIndex recvBuf;
-        MPI_Recv(&recvBuf,                     // buff
-                 sizeof(PeerIndexGlobalIndex), // count
-                 MPI_BYTE,                     // data type
-                 static_cast<int>(peerRank),   // peer process
-                 0,                            // tag
-                 MPI_COMM_WORLD,               // communicator
-                 MPI_STATUS_IGNORE);           // status
-
-        Index domesticIdx = foreignOverlap_.nativeToLocal(recvBuf.peerIdx);
-        if (domesticIdx >= 0) {
-            Index globalIdx = recvBuf.globalIdx;
-            addIndex(domesticIdx, globalIdx);
-        }
-#endif // HAVE_MPI
+        assert(numDomestic_ == globalToDomestic_.size());
     }
 
     /*!
@@ -193,8 +162,8 @@ public:
                   << " list for rank " << myRank_ << "\n";
 
         for (size_t domIdx = 0; domIdx < domesticToGlobal_.size(); ++domIdx)
-            std::cout << "(" << domIdx << ", " << domesticToGlobal(domIdx)
-                      << ", " << globalToDomestic(domesticToGlobal(domIdx)) << ") ";
+            std::cout << "(" << domIdx << ", " << domesticToGlobal(static_cast<Index>(domIdx))
+                      << ", " << globalToDomestic(domesticToGlobal(static_cast<Index>(domIdx))) << ") ";
         std::cout << "\n" << std::flush;
     }
 
@@ -210,25 +179,24 @@ protected:
 #endif
 
 #if HAVE_MPI
-        if (myRank_ == 0) {
-            // the first rank starts at index zero
+        // the global indices of all local indices which are mastered by the current
+        // process are consecutive
+        int numMaster = 0;
+        for (unsigned i = 0; i < foreignOverlap_.numLocal(); ++i)
+            if (foreignOverlap_.iAmMasterOf(static_cast<Index>(i)))
+                ++numMaster;
+
+        // the offset is the number of master indices of all lower ranks
+        domesticOffset_ = 0;
+        MPI_Exscan(&numMaster, &domesticOffset_, 1, MPI_INT, MPI_SUM, MPI_COMM_WORLD);
+        if (myRank_ == 0)
+            // the result of MPI_Exscan is undefined for the first rank
             domesticOffset_ = 0;
-        }
-        else {
-            // all other ranks retrieve their offset from the next
-            // lower rank
-            MPI_Recv(&domesticOffset_, // buffer
-                     1,                // count
-                     MPI_INT,          // data type
-                     static_cast<int>(myRank_ - 1), // peer rank
-                     0,                // tag
-                     MPI_COMM_WORLD,   // communicator
-                     MPI_STATUS_IGNORE);
-        }
 
         // create maps for all indices for which the current process
         // is the master
-        int numMaster = 0;
+        globalToDomestic_.reserve(foreignOverlap_.numLocal());
+        numMaster = 0;
         for (unsigned i = 0; i < foreignOverlap_.numLocal(); ++i) {
             if (!foreignOverlap_.iAmMasterOf(static_cast<Index>(i)))
                 continue;
@@ -238,55 +206,29 @@ protected:
             ++numMaster;
         }
 
-        if (myRank_ < mpiSize_ - 1) {
-            // send the domestic offset plus the number of master
-            // indices to the process which is one rank higher
-            int tmp = domesticOffset_ + numMaster;
-            MPI_Send(&tmp,            // buff
-                     1,               // count
-                     MPI_INT,         // data type
-                     static_cast<int>(myRank_ + 1), // peer rank
-                     0,               // tag
-                     MPI_COMM_WORLD); // communicator
-        }
+        // the global indices of the border indices are only known by their master
+        // process. Since all master indices are numbered at this point, the border
+        // indices are exchanged with all peers at once using a single message per
+        // peer.
+        const std::vector<ProcessRank> peerRanks(peerSet_().begin(), peerSet_().end());
+        std::vector<MpiBuffer<PeerIndexGlobalIndex> > sendBuffs(peerRanks.size());
+        for (size_t peerIdx = 0; peerIdx < peerRanks.size(); ++peerIdx)
+            sendBorderTo_(peerRanks[peerIdx], sendBuffs[peerIdx]);
 
-        typename PeerSet::const_iterator peerIt;
-        typename PeerSet::const_iterator peerEndIt = peerSet_().end();
-        // receive the border indices from the lower ranks
-        peerIt = peerSet_().begin();
-        for (; peerIt != peerEndIt; ++peerIt) {
-            if (*peerIt < myRank_)
-                receiveBorderFrom_(*peerIt);
-        }
+        for (const ProcessRank peerRank : peerRanks)
+            receiveBorderFrom_(peerRank);
 
-        // send the border indices to the higher ranks
-        peerIt = peerSet_().begin();
-        for (; peerIt != peerEndIt; ++peerIt) {
-            if (*peerIt > myRank_)
-                sendBorderTo_(*peerIt);
-        }
-
-        // receive the border indices from the higher ranks
-        peerIt = peerSet_().begin();
-        for (; peerIt != peerEndIt; ++peerIt) {
-            if (*peerIt > myRank_)
-                receiveBorderFrom_(*peerIt);
-        }
-
-        // send the border indices to the lower ranks
-        peerIt = peerSet_().begin();
-        for (; peerIt != peerEndIt; ++peerIt) {
-            if (*peerIt < myRank_)
-                sendBorderTo_(*peerIt);
-        }
+        for (auto& sendBuff : sendBuffs)
+            sendBuff.wait();
 #endif // HAVE_MPI
     }
 
-    void sendBorderTo_([[maybe_unused]] ProcessRank peerRank)
-    {
 #if HAVE_MPI
-        // send (local index on myRank, global index) pairs to the
-        // peers
+    // send (local index on the peer, global index) pairs of the border indices
+    // mastered by the current process to a peer
+    void sendBorderTo_(ProcessRank peerRank, MpiBuffer<PeerIndexGlobalIndex>& sendBuff)
+    {
+        std::vector<PeerIndexGlobalIndex> entries;
         BorderList::const_iterator borderIt = borderList_().begin();
         BorderList::const_iterator borderEndIt = borderList_().end();
         for (; borderIt != borderEndIt; ++borderIt) {
@@ -296,20 +238,27 @@ protected:
                 continue;
 
             Index localIdx = foreignOverlap_.nativeToLocal(borderIt->localIdx);
-            Index peerIdx = borderIt->peerIdx;
             assert(localIdx >= 0);
             if (foreignOverlap_.iAmMasterOf(localIdx)) {
-                sendBorderIndex(borderPeer, localIdx, peerIdx);
+                PeerIndexGlobalIndex entry;
+                entry.peerIdx = borderIt->peerIdx;
+                entry.globalIdx = domesticToGlobal(localIdx);
+                entries.push_back(entry);
             }
         }
-#endif // HAVE_MPI
+
+        sendBuff.resize(entries.size());
+        for (size_t i = 0; i < entries.size(); ++i)
+            sendBuff[i] = entries[i];
+        sendBuff.send(peerRank);
     }
 
-    void receiveBorderFrom_([[maybe_unused]] ProcessRank peerRank)
+    // retrieve the global indices of the border indices which are mastered by a peer
+    void receiveBorderFrom_(ProcessRank peerRank)
     {
-#if HAVE_MPI
-        // retrieve the global indices for which we are not master
-        // from the processes with lower rank
+        // the number of indices is known because the peer sends exactly the border
+        // indices for which it is the master
+        size_t numIndices = 0;
         BorderList::const_iterator borderIt = borderList_().begin();
         BorderList::const_iterator borderEndIt = borderList_().end();
         for (; borderIt != borderEndIt; ++borderIt) {
@@ -321,10 +270,18 @@ protected:
             Index nativeIdx = borderIt->localIdx;
             Index localIdx = foreignOverlap_.nativeToLocal(nativeIdx);
             if (localIdx >= 0 && foreignOverlap_.masterRank(localIdx) == borderPeer)
-                receiveBorderIndex(borderPeer);
+                ++numIndices;
+        }
+
+        MpiBuffer<PeerIndexGlobalIndex> recvBuff(numIndices);
+        recvBuff.receive(peerRank);
+        for (size_t i = 0; i < numIndices; ++i) {
+            Index domesticIdx = foreignOverlap_.nativeToLocal(recvBuff[i].peerIdx);
+            if (domesticIdx >= 0)
+                addIndex(domesticIdx, recvBuff[i].globalIdx);
         }
-#endif // HAVE_MPI
     }
+#endif // HAVE_MPI
 
     const PeerSet& peerSet_() const
     { return foreignOverlap_.peerSet(); }
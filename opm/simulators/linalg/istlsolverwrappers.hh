@@ -38,6 +38,8 @@
  * - \c SteepestDescent: The steepest descent solver
  * - \c ConjugatedGradients: A conjugated gradients solver
  * - \c BiCGStab: A stabilized bi-conjugated gradients solver
+ * - \c FusedBiCGStab: A stabilized bi-conjugated gradients solver which batches its
+ *   scalar products into two global reductions per iteration
  * - \c MinRes: A solver based on the  minimized residual algorithm
  * - \c RestartedGMRes: A restarted GMRES solver
  */
@@ -50,6 +52,7 @@
 #include <opm/models/utils/parametersystem.hh>
 
 #include <opm/simulators/linalg/linalgparameters.hh>
+#include <opm/simulators/linalg/fusedbicgstabsolver.hh>
 #include <opm/simulators/linalg/linalgproperties.hh>
 
 namespace Opm::Linear {
@@ -159,6 +162,57 @@ private:
     std::shared_ptr<RawSolver> solver_;
 };
 
+/*!
+ * \brief Solver wrapper for the BiCGStab solver with fused global reductions.
+ *
+ * In contrast to the ISTL solvers, this one needs to know the concrete type of the
+ * scalar product because it computes the local contributions of several scalar
+ * products before it sums them up globally.
+ */
+template <class TypeTag>
+class SolverWrapperFusedBiCGStab
+{
+    using Scalar = GetPropType<TypeTag, Properties::Scalar>;
+    using OverlappingVector = GetPropType<TypeTag, Properties::OverlappingVector>;
+    using OverlappingScalarProduct = GetPropType<TypeTag, Properties::OverlappingScalarProduct>;
+
+public:
+    using RawSolver = FusedBiCGStabSolver<OverlappingVector, OverlappingScalarProduct>;
+
+    SolverWrapperFusedBiCGStab()
+    {}
+
+    static void registerParameters()
+    {}
+
+    template <class LinearOperator, class Preconditioner>
+    std::shared_ptr<RawSolver> get(LinearOperator& parOperator,
+                                   OverlappingScalarProduct& parScalarProduct,
+                                   Preconditioner& parPreCond)
+    {
+        Scalar tolerance = Parameters::Get<Parameters::LinearSolverTolerance<Scalar>>();
+        int maxIter = Parameters::Get<Parameters::LinearSolverMaxIterations>();
+
+        int verbosity = 0;
+        if (parOperator.overlap().myRank() == 0)
+            verbosity = Parameters::Get<Parameters::LinearSolverVerbosity>();
+        solver_ = std::make_shared<RawSolver>(parOperator,
+                                              parScalarProduct,
+                                              parPreCond,
+                                              tolerance,
+                                              maxIter,
+                                              verbosity);
+
+        return solver_;
+    }
+
+    void cleanup()
+    { solver_.reset(); }
+
+private:
+    std::shared_ptr<RawSolver> solver_;
+};
+
 #undef EWOMS_WRAP_ISTL_SOLVER
 
 } // namespace Opm::Linear
@@ -31,6 +31,8 @@
 #include <dune/common/fmatrix.hh>
 #include <dune/common/version.hh>
 
+#include <opm/simulators/linalg/sparsitypattern.hh>
+
 namespace Opm {
 namespace Linear {
 
@@ -100,6 +102,31 @@ public:
         istlMatrix_->endindices();
     }
 
+    /*!
+     * \brief Allocate matrix structure given a sparsity pattern in compressed row
+     *        storage.
+     */
+    void reserve(const SparsityPattern& sparsityPattern)
+    {
+        // allocate raw matrix
+        istlMatrix_.reset(new IstlMatrix(rows_, columns_, IstlMatrix::random));
+
+        // make sure sparsityPattern is consistent with number of rows
+        assert(rows_ == sparsityPattern.size());
+
+        for (size_t dofIdx = 0; dofIdx < rows_; ++ dofIdx)
+            istlMatrix_->setrowsize(dofIdx, sparsityPattern[dofIdx].size());
+        istlMatrix_->endrowsizes();
+
+        // the column indices of the pattern are sorted and unique, so they can be
+        // copied as they are
+        for (size_t dofIdx = 0; dofIdx < rows_; ++ dofIdx) {
+            const auto row = sparsityPattern[dofIdx];
+            istlMatrix_->setIndices(dofIdx, row.begin(), row.end());
+        }
+        istlMatrix_->endindices();
+    }
+
     /*!
      * \brief Return constant reference to matrix implementation.
      */
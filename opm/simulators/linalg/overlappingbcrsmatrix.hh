@@ -37,6 +37,9 @@
 #include <dune/istl/scalarproducts.hh>
 #include <dune/istl/io.hh>
 #include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <limits>
 #include <set>
 #include <map>
 #include <iostream>
@@ -71,6 +74,10 @@ public:
         : ParentType(other)
     {}
 
+    // the native block map and the communication buffers point into the matrix's own
+    // block storage, so assigning them to another object would be wrong
+    OverlappingBCRSMatrix& operator=(const OverlappingBCRSMatrix&) = delete;
+
     template <class NativeBCRSMatrix>
     OverlappingBCRSMatrix(const NativeBCRSMatrix& nativeMatrix,
                           const BorderList& borderList,
@@ -86,6 +93,7 @@ public:
         // build the overlapping matrix from the non-overlapping
         // matrix and the overlap
         build_(nativeMatrix);
+        buildNativeMap_(nativeMatrix);
     }
 
     // this constructor is required to make the class compatible with the SeqILU class of
@@ -219,19 +227,120 @@ public:
     template <class NativeBCRSMatrix>
     void assignFromNative(const NativeBCRSMatrix& nativeMatrix)
     {
-        // first, set everything to 0,
-        BCRSMatrix::operator=(0.0);
+        // the mapping of the native blocks to the blocks of the overlapping matrix only
+        // depends on the sparsity patterns, so it is only determined once
+        if (nativeRowStart_.size() != nativeMatrix.N() + 1
+            || nativeRowStart_.back() != nativeMatrix.nonzeroes())
+            buildNativeMap_(nativeMatrix);
+
+        const long numNativeRows = static_cast<long>(nativeMatrix.N());
+        if (nativeIsIdentity_) {
+            // the overlapping matrix exhibits the same structure as the native one,
+            // i.e., there is no overlap and the blocks can be copied verbatim
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+            for (long rowIdx = 0; rowIdx < numNativeRows; ++rowIdx) {
+                auto nativeColIt = nativeMatrix[rowIdx].begin();
+                const auto& nativeColEndIt = nativeMatrix[rowIdx].end();
+                auto colIt = (*this)[rowIdx].begin();
+                for (; nativeColIt != nativeColEndIt; ++nativeColIt, ++colIt)
+                    assignBlock_(*colIt, *nativeColIt);
+            }
+            return;
+        }
+
+        // first, set the blocks which do not receive a native entry to 0,
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+        for (long i = 0; i < static_cast<long>(unassignedBlocks_.size()); ++i)
+            *unassignedBlocks_[i] = 0.0;
 
         // then copy the domestic entries of the native matrix to the overlapping matrix
-        for (unsigned nativeRowIdx = 0; nativeRowIdx < nativeMatrix.N(); ++nativeRowIdx) {
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+        for (long nativeRowIdx = 0; nativeRowIdx < numNativeRows; ++nativeRowIdx) {
+            std::size_t nativeBlockIdx = nativeRowStart_[nativeRowIdx];
+            auto nativeColIt = nativeMatrix[nativeRowIdx].begin();
+            const auto& nativeColEndIt = nativeMatrix[nativeRowIdx].end();
+            for (; nativeColIt != nativeColEndIt; ++nativeColIt, ++nativeBlockIdx) {
+                block_type* dest = nativeBlockDest_[nativeBlockIdx];
+                if (dest)
+                    assignBlock_(*dest, *nativeColIt);
+            }
+        }
+    }
+
+    // communicates and adds up the contents of overlapping rows
+    void syncAdd()
+    {
+        startReceive_();
+        sendEntries_();
+
+#if HAVE_MPI
+        // the values are added in the order of the peers, so that the result does not
+        // depend on the order in which the messages arrive
+        MPI_Waitall(static_cast<int>(peerRanks_.size()), recvRequests_.data(), MPI_STATUSES_IGNORE);
+        for (std::size_t peerIdx = 0; peerIdx < peerRanks_.size(); ++peerIdx)
+            receiveAddEntries_(peerIdx);
+#endif // HAVE_MPI
+
+        // finally, make sure that everything which we send was
+        // received by the peers
+        waitSendFinished_();
+    }
+
+    // communicates and copies the contents of overlapping rows from
+    // the master
+    void syncCopy()
+    {
+        startReceive_();
+        sendEntries_();
+
+#if HAVE_MPI
+        MPI_Waitall(static_cast<int>(peerRanks_.size()), recvRequests_.data(), MPI_STATUSES_IGNORE);
+        for (std::size_t peerIdx = 0; peerIdx < peerRanks_.size(); ++peerIdx)
+            receiveCopyEntries_(peerIdx);
+#endif // HAVE_MPI
+
+        // finally, make sure that everything which we send was
+        // received by the peers
+        waitSendFinished_();
+    }
+
+private:
+    // determine the block of the overlapping matrix for each block of the native matrix
+    template <class NativeBCRSMatrix>
+    void buildNativeMap_(const NativeBCRSMatrix& nativeMatrix)
+    {
+        // the index of the first block of each row of the overlapping matrix
+        const std::size_t numRows = this->N();
+        std::vector<std::size_t> rowStart(numRows + 1, 0);
+        for (std::size_t rowIdx = 0; rowIdx < numRows; ++rowIdx)
+            rowStart[rowIdx + 1] = rowStart[rowIdx] + (*this)[rowIdx].size();
+
+        const std::size_t numNativeRows = nativeMatrix.N();
+        nativeRowStart_.resize(numNativeRows + 1);
+        nativeRowStart_[0] = 0;
+        for (std::size_t nativeRowIdx = 0; nativeRowIdx < numNativeRows; ++nativeRowIdx)
+            nativeRowStart_[nativeRowIdx + 1] = nativeRowStart_[nativeRowIdx] + nativeMatrix[nativeRowIdx].size();
+
+        static constexpr std::size_t noBlock = std::numeric_limits<std::size_t>::max();
+        std::vector<std::size_t> blockIdx(nativeRowStart_.back(), noBlock);
+        std::vector<std::size_t> nativeSource(rowStart.back(), noBlock);
+        for (std::size_t nativeRowIdx = 0; nativeRowIdx < numNativeRows; ++nativeRowIdx) {
             Index domesticRowIdx = overlap_->nativeToDomestic(static_cast<Index>(nativeRowIdx));
             if (domesticRowIdx < 0) {
                 continue; // row corresponds to a black-listed entry
             }
 
+            const auto& row = (*this)[static_cast<unsigned>(domesticRowIdx)];
+            std::size_t nativeBlockIdx = nativeRowStart_[nativeRowIdx];
             auto nativeColIt = nativeMatrix[nativeRowIdx].begin();
             const auto& nativeColEndIt = nativeMatrix[nativeRowIdx].end();
-            for (; nativeColIt != nativeColEndIt; ++nativeColIt) {
+            for (; nativeColIt != nativeColEndIt; ++nativeColIt, ++nativeBlockIdx) {
                 Index domesticColIdx = overlap_->nativeToDomestic(static_cast<Index>(nativeColIt.index()));
 
                 // make sure to include all off-diagonal entries, even those which belong
@@ -246,82 +355,64 @@ public:
                     // algebraic one...
                     continue;
 
-                // we need to copy the block matrices manually since it seems that (at
-                // least some versions of) Dune have an endless recursion bug when
-                // assigning dense matrices of different field type
-                const auto& src = *nativeColIt;
-                auto& dest = (*this)[static_cast<unsigned>(domesticRowIdx)][static_cast<unsigned>(domesticColIdx)];
-                for (unsigned i = 0; i < src.rows; ++i) {
-                    for (unsigned j = 0; j < src.cols; ++j) {
-                        dest[i][j] = static_cast<field_type>(src[i][j]);
-                    }
-                }
+                // the blocks of a row are stored contiguously
+                const auto colIt = row.find(static_cast<unsigned>(domesticColIdx));
+                assert(colIt != row.end());
+                const std::size_t idx = rowStart[domesticRowIdx] + static_cast<std::size_t>(&*colIt - &*row.begin());
+
+                // if several native blocks map to the same block, the last one wins
+                if (nativeSource[idx] != noBlock)
+                    blockIdx[nativeSource[idx]] = noBlock;
+                nativeSource[idx] = nativeBlockIdx;
+                blockIdx[nativeBlockIdx] = idx;
             }
         }
-    }
-
-    // communicates and adds up the contents of overlapping rows
-    void syncAdd()
-    {
-        // first, send all entries to the peers
-        const PeerSet& peerSet = overlap_->peerSet();
-        typename PeerSet::const_iterator peerIt = peerSet.begin();
-        typename PeerSet::const_iterator peerEndIt = peerSet.end();
-        for (; peerIt != peerEndIt; ++peerIt) {
-            ProcessRank peerRank = *peerIt;
 
-            sendEntries_(peerRank);
+        // without any overlap, the structures of the two matrices are the same
+        nativeIsIdentity_ =
+            overlap_->peerSet().empty()
+            && numRows == numNativeRows
+            && rowStart.back() == nativeRowStart_.back();
+        for (std::size_t i = 0; nativeIsIdentity_ && i < blockIdx.size(); ++i)
+            nativeIsIdentity_ = (blockIdx[i] == i);
+
+        // convert the block indices to addresses
+        std::vector<block_type*> blockAddress(rowStart.back());
+        for (std::size_t rowIdx = 0; rowIdx < numRows; ++rowIdx) {
+            std::size_t idx = rowStart[rowIdx];
+            auto colIt = (*this)[rowIdx].begin();
+            const auto& colEndIt = (*this)[rowIdx].end();
+            for (; colIt != colEndIt; ++colIt, ++idx)
+                blockAddress[idx] = &*colIt;
         }
 
-        // then, receive entries from the peers
-        peerIt = peerSet.begin();
-        for (; peerIt != peerEndIt; ++peerIt) {
-            ProcessRank peerRank = *peerIt;
+        nativeBlockDest_.clear();
+        unassignedBlocks_.clear();
+        if (nativeIsIdentity_)
+            return;
 
-            receiveAddEntries_(peerRank);
-        }
+        nativeBlockDest_.resize(blockIdx.size());
+        for (std::size_t i = 0; i < blockIdx.size(); ++i)
+            nativeBlockDest_[i] = (blockIdx[i] == noBlock) ? nullptr : blockAddress[blockIdx[i]];
 
-        // finally, make sure that everything which we send was
-        // received by the peers
-        peerIt = peerSet.begin();
-        for (; peerIt != peerEndIt; ++peerIt) {
-            ProcessRank peerRank = *peerIt;
-            entryValuesSendBuff_[peerRank]->wait();
-        }
+        for (std::size_t idx = 0; idx < nativeSource.size(); ++idx)
+            if (nativeSource[idx] == noBlock)
+                unassignedBlocks_.push_back(blockAddress[idx]);
     }
 
-    // communicates and copies the contents of overlapping rows from
-    // the master
-    void syncCopy()
+    // we need to copy the block matrices manually since it seems that (at least some
+    // versions of) Dune have an endless recursion bug when assigning dense matrices of
+    // different field type
+    template <class NativeBlock>
+    static void assignBlock_(block_type& dest, const NativeBlock& src)
     {
-        // first, send all entries to the peers
-        const PeerSet& peerSet = overlap_->peerSet();
-        typename PeerSet::const_iterator peerIt = peerSet.begin();
-        typename PeerSet::const_iterator peerEndIt = peerSet.end();
-        for (; peerIt != peerEndIt; ++peerIt) {
-            ProcessRank peerRank = *peerIt;
-
-            sendEntries_(peerRank);
-        }
-
-        // then, receive entries from the peers
-        peerIt = peerSet.begin();
-        for (; peerIt != peerEndIt; ++peerIt) {
-            ProcessRank peerRank = *peerIt;
-
-            receiveCopyEntries_(peerRank);
-        }
-
-        // finally, make sure that everything which we send was
-        // received by the peers
-        peerIt = peerSet.begin();
-        for (; peerIt != peerEndIt; ++peerIt) {
-            ProcessRank peerRank = *peerIt;
-            entryValuesSendBuff_[peerRank]->wait();
+        for (unsigned i = 0; i < src.rows; ++i) {
+            for (unsigned j = 0; j < src.cols; ++j) {
+                dest[i][j] = static_cast<field_type>(src[i][j]);
+            }
         }
     }
 
-private:
     template <class NativeBCRSMatrix>
     void build_(const NativeBCRSMatrix& nativeMatrix)
     {
@@ -443,6 +534,64 @@ private:
 
         // free the memory occupied by the array of the matrix entries
         entries_.clear();
+
+        initValueExchange_();
+    }
+
+    // determine the blocks which are exchanged with the peers and create the
+    // persistent requests which communicate their values
+    void initValueExchange_()
+    {
+#if HAVE_MPI
+        const PeerSet& peerSet = overlap_->peerSet();
+        peerRanks_.assign(peerSet.begin(), peerSet.end());
+        const std::size_t numPeers = peerRanks_.size();
+
+        sendOffsets_.assign(numPeers + 1, 0);
+        recvOffsets_.assign(numPeers + 1, 0);
+        sendBlocks_.clear();
+        recvBlocks_.clear();
+        sendRequests_.resize(numPeers);
+        recvRequests_.resize(numPeers);
+        for (std::size_t peerIdx = 0; peerIdx < numPeers; ++peerIdx) {
+            const ProcessRank peerRank = peerRanks_[peerIdx];
+
+            const auto& rowIndicesSendBuff = *rowIndicesSendBuff_[peerRank];
+            const auto& rowSizesSendBuff = *rowSizesSendBuff_[peerRank];
+            const auto& colIndicesSendBuff = *entryColIndicesSendBuff_[peerRank];
+            unsigned k = 0;
+            for (unsigned i = 0; i < rowIndicesSendBuff.size(); ++i) {
+                const auto domRowIdx = static_cast<unsigned>(rowIndicesSendBuff[i]);
+                for (unsigned j = 0; j < rowSizesSendBuff[i]; ++j, ++k) {
+                    const auto domColIdx = static_cast<unsigned>(colIndicesSendBuff[k]);
+                    sendBlocks_.push_back(&(*this)[domRowIdx][domColIdx]);
+                }
+            }
+            sendOffsets_[peerIdx + 1] = sendBlocks_.size();
+
+            const auto& rowIndicesRecvBuff = *rowIndicesRecvBuff_[peerRank];
+            const auto& rowSizesRecvBuff = *rowSizesRecvBuff_[peerRank];
+            const auto& colIndicesRecvBuff = *entryColIndicesRecvBuff_[peerRank];
+            k = 0;
+            for (unsigned i = 0; i < rowIndicesRecvBuff.size(); ++i) {
+                const auto domRowIdx = static_cast<unsigned>(rowIndicesRecvBuff[i]);
+                for (unsigned j = 0; j < rowSizesRecvBuff[i]; ++j, ++k) {
+                    const Index domColIdx = colIndicesRecvBuff[k];
+
+                    // the matrix for the current process may not know about the DOF
+                    recvBlocks_.push_back(domColIdx < 0
+                                          ? nullptr
+                                          : &(*this)[domRowIdx][static_cast<unsigned>(domColIdx)]);
+                }
+            }
+            recvOffsets_[peerIdx + 1] = recvBlocks_.size();
+
+            entryValuesSendBuff_[peerRank]->sendInit(peerRank);
+            sendRequests_[peerIdx] = entryValuesSendBuff_[peerRank]->request();
+            entryValuesRecvBuff_[peerRank]->receiveInit(peerRank);
+            recvRequests_[peerIdx] = entryValuesRecvBuff_[peerRank]->request();
+        }
+#endif // HAVE_MPI
     }
 
     // send the overlap indices to a peer
@@ -578,88 +727,63 @@ private:
 #endif // HAVE_MPI
     }
 
-    void sendEntries_([[maybe_unused]] ProcessRank peerRank)
+    void startReceive_()
     {
 #if HAVE_MPI
-        auto &mpiSendBuff = *entryValuesSendBuff_[peerRank];
-
-        auto &mpiRowIndicesSendBuff = *rowIndicesSendBuff_[peerRank];
-        auto &mpiRowSizesSendBuff = *rowSizesSendBuff_[peerRank];
-        auto &mpiColIndicesSendBuff = *entryColIndicesSendBuff_[peerRank];
-
-        // fill the send buffer
-        unsigned k = 0;
-        for (unsigned i = 0; i < mpiRowIndicesSendBuff.size(); ++i) {
-            Index domRowIdx = mpiRowIndicesSendBuff[i];
+        if (!peerRanks_.empty())
+            MPI_Startall(static_cast<int>(peerRanks_.size()), recvRequests_.data());
+#endif // HAVE_MPI
+    }
 
-            for (Index j = 0; j < static_cast<Index>(mpiRowSizesSendBuff[i]); ++j)
-            {
-                // move to the next column which is in the overlap
-                Index domColIdx = mpiColIndicesSendBuff[k];
+    void sendEntries_()
+    {
+#if HAVE_MPI
+        if (peerRanks_.empty())
+            return;
 
-                // add the values of this column to the send buffer
-                mpiSendBuff[k] = (*this)[static_cast<unsigned>(domRowIdx)][static_cast<unsigned>(domColIdx)];
-                ++k;
-            }
+        // fill the send buffers
+        for (std::size_t peerIdx = 0; peerIdx < peerRanks_.size(); ++peerIdx) {
+            auto& mpiSendBuff = *entryValuesSendBuff_[peerRanks_[peerIdx]];
+            block_type* const* blocks = sendBlocks_.data() + sendOffsets_[peerIdx];
+            for (std::size_t k = 0; k < mpiSendBuff.size(); ++k)
+                mpiSendBuff[k] = *blocks[k];
         }
 
-        mpiSendBuff.send(peerRank);
+        MPI_Startall(static_cast<int>(peerRanks_.size()), sendRequests_.data());
 #endif // HAVE_MPI
     }
 
-    void receiveAddEntries_([[maybe_unused]] ProcessRank peerRank)
+    void waitSendFinished_()
     {
 #if HAVE_MPI
-        auto &mpiRecvBuff = *entryValuesRecvBuff_[peerRank];
-
-        auto &mpiRowIndicesRecvBuff = *rowIndicesRecvBuff_[peerRank];
-        auto &mpiRowSizesRecvBuff = *rowSizesRecvBuff_[peerRank];
-        auto &mpiColIndicesRecvBuff = *entryColIndicesRecvBuff_[peerRank];
+        if (!peerRanks_.empty())
+            MPI_Waitall(static_cast<int>(peerRanks_.size()), sendRequests_.data(), MPI_STATUSES_IGNORE);
+#endif // HAVE_MPI
+    }
 
-        mpiRecvBuff.receive(peerRank);
+    void receiveAddEntries_([[maybe_unused]] std::size_t peerIdx)
+    {
+#if HAVE_MPI
+        const auto& mpiRecvBuff = *entryValuesRecvBuff_[peerRanks_[peerIdx]];
+        block_type* const* blocks = recvBlocks_.data() + recvOffsets_[peerIdx];
 
         // retrieve the values from the receive buffer
-        unsigned k = 0;
-        for (unsigned i = 0; i < mpiRowIndicesRecvBuff.size(); ++i) {
-            Index domRowIdx = mpiRowIndicesRecvBuff[i];
-            for (unsigned j = 0; j < mpiRowSizesRecvBuff[i]; ++j, ++k) {
-                Index domColIdx = mpiColIndicesRecvBuff[k];
-
-                if (domColIdx < 0)
-                    // the matrix for the current process does not know about this DOF
-                    continue;
-
-                (*this)[static_cast<unsigned>(domRowIdx)][static_cast<unsigned>(domColIdx)] += mpiRecvBuff[k];
-            }
-        }
+        for (std::size_t k = 0; k < mpiRecvBuff.size(); ++k)
+            if (blocks[k])
+                *blocks[k] += mpiRecvBuff[k];
 #endif // HAVE_MPI
     }
 
-    void receiveCopyEntries_([[maybe_unused]] int peerRank)
+    void receiveCopyEntries_([[maybe_unused]] std::size_t peerIdx)
     {
 #if HAVE_MPI
-        MpiBuffer<block_type> &mpiRecvBuff = *entryValuesRecvBuff_[peerRank];
-
-        MpiBuffer<Index> &mpiRowIndicesRecvBuff = *rowIndicesRecvBuff_[peerRank];
-        MpiBuffer<unsigned> &mpiRowSizesRecvBuff = *rowSizesRecvBuff_[peerRank];
-        MpiBuffer<Index> &mpiColIndicesRecvBuff = *entryColIndicesRecvBuff_[peerRank];
-
-        mpiRecvBuff.receive(peerRank);
+        const auto& mpiRecvBuff = *entryValuesRecvBuff_[peerRanks_[peerIdx]];
+        block_type* const* blocks = recvBlocks_.data() + recvOffsets_[peerIdx];
 
         // retrieve the values from the receive buffer
-        unsigned k = 0;
-        for (unsigned i = 0; i < mpiRowIndicesRecvBuff.size(); ++i) {
-            Index domRowIdx = mpiRowIndicesRecvBuff[i];
-            for (unsigned j = 0; j < mpiRowSizesRecvBuff[i]; ++j, ++k) {
-                Index domColIdx = mpiColIndicesRecvBuff[k];
-
-                if (domColIdx < 0)
-                    // the matrix for the current process does not know about this DOF
-                    continue;
-
-                (*this)[static_cast<unsigned>(domRowIdx)][static_cast<unsigned>(domColIdx)] = mpiRecvBuff[k];
-            }
-        }
+        for (std::size_t k = 0; k < mpiRecvBuff.size(); ++k)
+            if (blocks[k])
+                *blocks[k] = mpiRecvBuff[k];
 #endif // HAVE_MPI
     }
 
@@ -673,6 +797,13 @@ private:
     Entries entries_;
     std::shared_ptr<Overlap> overlap_;
 
+    // the first block of each row of the native matrix, the destinations of the
+    // native blocks and the blocks which do not correspond to any native block
+    std::vector<std::size_t> nativeRowStart_;
+    std::vector<block_type*> nativeBlockDest_;
+    std::vector<block_type*> unassignedBlocks_;
+    bool nativeIsIdentity_ = false;
+
     std::map<ProcessRank, MpiBuffer<unsigned> *> numRowsSendBuff_;
     std::map<ProcessRank, MpiBuffer<unsigned> *> rowSizesSendBuff_;
     std::map<ProcessRank, MpiBuffer<Index> *> rowIndicesSendBuff_;
@@ -684,6 +815,19 @@ private:
     std::map<ProcessRank, MpiBuffer<Index> *> rowIndicesRecvBuff_;
     std::map<ProcessRank, MpiBuffer<Index> *> entryColIndicesRecvBuff_;
     std::map<ProcessRank, MpiBuffer<block_type> *> entryValuesRecvBuff_;
+
+    // the peers and the blocks whose values are exchanged with them. The blocks of the
+    // i-th peer are stored in the range [offsets[i], offsets[i + 1]) of the arrays.
+    std::vector<ProcessRank> peerRanks_;
+    std::vector<std::size_t> sendOffsets_;
+    std::vector<block_type*> sendBlocks_;
+    std::vector<std::size_t> recvOffsets_;
+    std::vector<block_type*> recvBlocks_;
+#if HAVE_MPI
+    // the persistent requests for the values of the blocks
+    std::vector<MPI_Request> sendRequests_;
+    std::vector<MPI_Request> recvRequests_;
+#endif // HAVE_MPI
 };
 
 } // namespace Linear
@@ -35,15 +35,21 @@
 #include <dune/istl/bvector.hh>
 #include <dune/common/fvector.hh>
 
+#include <cassert>
+#include <cstddef>
 #include <memory>
-#include <map>
 #include <iostream>
+#include <vector>
 
 namespace Opm {
 namespace Linear {
 
 /*!
  * \brief An overlap aware block vector.
+ *
+ * Copies of a vector share its communication buffers. Hence, while a
+ * synchronization which was started by syncBegin() is in flight, neither the vector
+ * nor any of its copies may be synchronized until syncEnd() has been called.
  */
 template <class FieldVector, class Overlap>
 class OverlappingBlockVector : public Dune::BlockVector<FieldVector>
@@ -65,11 +71,7 @@ public:
      */
     OverlappingBlockVector(const OverlappingBlockVector& obv)
         : ParentType(obv)
-        , numIndicesSendBuff_(obv.numIndicesSendBuff_)
-        , indicesSendBuff_(obv.indicesSendBuff_)
-        , indicesRecvBuff_(obv.indicesRecvBuff_)
-        , valuesSendBuff_(obv.valuesSendBuff_)
-        , valuesRecvBuff_(obv.valuesRecvBuff_)
+        , buffers_(obv.buffers_)
         , overlap_(obv.overlap_)
     {}
 
@@ -92,11 +94,7 @@ public:
     OverlappingBlockVector& operator=(const OverlappingBlockVector& obv)
     {
         ParentType::operator=(obv);
-        numIndicesSendBuff_ = obv.numIndicesSendBuff_;
-        indicesSendBuff_ = obv.indicesSendBuff_;
-        indicesRecvBuff_ = obv.indicesRecvBuff_;
-        valuesSendBuff_ = obv.valuesSendBuff_;
-        valuesRecvBuff_ = obv.valuesRecvBuff_;
+        buffers_ = obv.buffers_;
         overlap_ = obv.overlap_;
         return *this;
     }
@@ -174,13 +172,53 @@ public:
      */
     void sync()
     {
-        // send all entries to all peers
-        for (const auto peerRank: overlap_->peerSet())
-            sendEntries_(peerRank);
+        syncBegin();
+        syncEnd();
+    }
 
-        // recieve all entries to the peers
-        for (const auto peerRank: overlap_->peerSet())
-            receiveFromMaster_(peerRank);
+    /*!
+     * \brief Start synchronizing the values of the block vector from their master
+     *        process.
+     *
+     * This sends the entries of the rows in the foreign overlap to all peers. Only
+     * these rows must be up to date when this method is called, the remaining ones
+     * can be computed before syncEnd() is called.
+     */
+    void syncBegin()
+    {
+        assert(!buffers_->syncInFlight);
+        buffers_->syncInFlight = true;
+
+        startReceive_();
+        sendEntries_();
+    }
+
+    /*!
+     * \brief Finish synchronizing the values of the block vector from their master
+     *        process.
+     */
+    void syncEnd()
+    {
+        assert(buffers_->syncInFlight);
+        buffers_->syncInFlight = false;
+
+#if HAVE_MPI
+        PeerBuffers& buffers = *buffers_;
+        const int numPeers = static_cast<int>(buffers.peerRanks.size());
+        if (numPeers == 0)
+            return;
+
+        // the values of each row are received from a single master process, so the
+        // peers can be processed in the order in which their values arrive
+        while (true) {
+            int peerIdx;
+            MPI_Waitany(numPeers, buffers.recvRequests.data(), &peerIdx, MPI_STATUS_IGNORE);
+            if (peerIdx == MPI_UNDEFINED)
+                break;
+
+            receiveFromMaster_(static_cast<std::size_t>(peerIdx));
+        }
+#endif // HAVE_MPI
 
         // wait until we have send everything
         waitSendFinished_();
@@ -192,13 +230,21 @@ public:
      */
     void syncAdd()
     {
-        // send all entries to all peers
-        for (const auto peerRank: overlap_->peerSet())
-            sendEntries_(peerRank);
+        assert(!buffers_->syncInFlight);
+
+        startReceive_();
+        sendEntries_();
 
-        // recieve all entries to the peers
-        for (const auto peerRank: overlap_->peerSet())
-            receiveAdd_(peerRank);
+        // the values are added in the order of the peers, so that the result does
+        // not depend on the order in which the messages arrive
+        PeerBuffers& buffers = *buffers_;
+#if HAVE_MPI
+        MPI_Waitall(static_cast<int>(buffers.peerRanks.size()),
+                    buffers.recvRequests.data(),
+                    MPI_STATUSES_IGNORE);
+#endif // HAVE_MPI
+        for (std::size_t peerIdx = 0; peerIdx < buffers.peerRanks.size(); ++peerIdx)
+            receiveAdd_(peerIdx);
 
         // wait until we have send everything
         waitSendFinished_();
@@ -213,145 +259,198 @@ public:
     }
 
 private:
+    // the communication buffers for all peers. They are created once for each overlap
+    // and shared by all copies of a vector.
+    struct PeerBuffers
+    {
+        std::vector<ProcessRank> peerRanks;
+
+        // the domestic indices of the rows which are sent to and received from the
+        // peers. The rows of the i-th peer are stored in the range [offsets[i],
+        // offsets[i + 1]) of the respective array.
+        std::vector<std::size_t> sendOffsets;
+        std::vector<Index> sendIndices;
+        std::vector<std::size_t> recvOffsets;
+        std::vector<Index> recvIndices;
+
+        // specifies whether a received row is mastered by the peer which sent it
+        std::vector<char> recvFromMaster;
+
+        std::vector<std::unique_ptr<MpiBuffer<FieldVector> > > sendValues;
+        std::vector<std::unique_ptr<MpiBuffer<FieldVector> > > recvValues;
+
+        // specifies whether a synchronization was started by syncBegin() but not yet
+        // finished by syncEnd()
+        bool syncInFlight = false;
+
+#if HAVE_MPI
+        // the persistent requests of the value buffers
+        std::vector<MPI_Request> sendRequests;
+        std::vector<MPI_Request> recvRequests;
+#endif // HAVE_MPI
+    };
+
     void createBuffers_()
     {
+        buffers_ = std::make_shared<PeerBuffers>();
+
 #if HAVE_MPI
-        // create array for the front indices
-        typename PeerSet::const_iterator peerIt;
-        typename PeerSet::const_iterator peerEndIt = overlap_->peerSet().end();
+        PeerBuffers& buffers = *buffers_;
+        const auto& peerSet = overlap_->peerSet();
+        buffers.peerRanks.assign(peerSet.begin(), peerSet.end());
+        const std::size_t numPeers = buffers.peerRanks.size();
+
+        // collect the rows in the foreign overlap of all peers
+        buffers.sendOffsets.resize(numPeers + 1);
+        buffers.sendOffsets[0] = 0;
+        for (std::size_t peerIdx = 0; peerIdx < numPeers; ++peerIdx) {
+            const ProcessRank peerRank = buffers.peerRanks[peerIdx];
+            buffers.sendOffsets[peerIdx + 1] =
+                buffers.sendOffsets[peerIdx] + overlap_->foreignOverlapSize(peerRank);
+        }
+        buffers.sendIndices.resize(buffers.sendOffsets.back());
 
         // send all indices to the peers
-        peerIt = overlap_->peerSet().begin();
-        for (; peerIt != peerEndIt; ++peerIt) {
-            ProcessRank peerRank = *peerIt;
+        std::vector<std::unique_ptr<MpiBuffer<unsigned> > > numIndicesSendBuff(numPeers);
+        std::vector<std::unique_ptr<MpiBuffer<Index> > > indicesSendBuff(numPeers);
+        for (std::size_t peerIdx = 0; peerIdx < numPeers; ++peerIdx) {
+            const ProcessRank peerRank = buffers.peerRanks[peerIdx];
 
-            size_t numEntries = overlap_->foreignOverlapSize(peerRank);
-            numIndicesSendBuff_[peerRank] = std::make_shared<MpiBuffer<unsigned> >(1);
-            indicesSendBuff_[peerRank] = std::make_shared<MpiBuffer<Index> >(numEntries);
-            valuesSendBuff_[peerRank] = std::make_shared<MpiBuffer<FieldVector> >(numEntries);
+            const std::size_t numEntries = overlap_->foreignOverlapSize(peerRank);
+            numIndicesSendBuff[peerIdx] = std::make_unique<MpiBuffer<unsigned> >(1);
+            indicesSendBuff[peerIdx] = std::make_unique<MpiBuffer<Index> >(numEntries);
 
             // fill the indices buffer with global indices
-            MpiBuffer<Index>& indicesSendBuff = *indicesSendBuff_[peerRank];
+            MpiBuffer<Index>& indices = *indicesSendBuff[peerIdx];
             for (unsigned i = 0; i < numEntries; ++i) {
                 Index domRowIdx = overlap_->foreignOverlapOffsetToDomesticIdx(peerRank, i);
-                indicesSendBuff[i] = overlap_->domesticToGlobal(domRowIdx);
+                buffers.sendIndices[buffers.sendOffsets[peerIdx] + i] = domRowIdx;
+                indices[i] = overlap_->domesticToGlobal(domRowIdx);
             }
 
             // first, send the number of indices
-            (*numIndicesSendBuff_[peerRank])[0] = static_cast<unsigned>(numEntries);
-            numIndicesSendBuff_[peerRank]->send(peerRank);
+            (*numIndicesSendBuff[peerIdx])[0] = static_cast<unsigned>(numEntries);
+            numIndicesSendBuff[peerIdx]->send(peerRank);
 
             // then, send the indices themselfs
-            indicesSendBuff.send(peerRank);
+            indices.send(peerRank);
         }
 
         // receive the indices from the peers
-        peerIt = overlap_->peerSet().begin();
-        for (; peerIt != peerEndIt; ++peerIt) {
-            ProcessRank peerRank = *peerIt;
+        buffers.recvOffsets.resize(numPeers + 1);
+        buffers.recvOffsets[0] = 0;
+        for (std::size_t peerIdx = 0; peerIdx < numPeers; ++peerIdx) {
+            const ProcessRank peerRank = buffers.peerRanks[peerIdx];
 
             // receive size of overlap to peer
             MpiBuffer<unsigned> numRowsRecvBuff(1);
             numRowsRecvBuff.receive(peerRank);
-            unsigned numRows = numRowsRecvBuff[0];
-
-            // then, create the MPI buffers
-            indicesRecvBuff_[peerRank] = std::shared_ptr<MpiBuffer<Index> >(
-                new MpiBuffer<Index>(numRows));
-            valuesRecvBuff_[peerRank] = std::shared_ptr<MpiBuffer<FieldVector> >(
-                new MpiBuffer<FieldVector>(numRows));
-            MpiBuffer<Index>& indicesRecvBuff = *indicesRecvBuff_[peerRank];
+            const unsigned numRows = numRowsRecvBuff[0];
 
             // next, receive the actual indices
+            MpiBuffer<Index> indicesRecvBuff(numRows);
             indicesRecvBuff.receive(peerRank);
 
             // finally, translate the global indices to domestic ones
             for (unsigned i = 0; i != numRows; ++i) {
-                Index globalRowIdx = indicesRecvBuff[i];
-                Index domRowIdx = overlap_->globalToDomestic(globalRowIdx);
-
-                indicesRecvBuff[i] = domRowIdx;
+                const Index domRowIdx = overlap_->globalToDomestic(indicesRecvBuff[i]);
+                buffers.recvIndices.push_back(domRowIdx);
+                buffers.recvFromMaster.push_back(overlap_->masterRank(domRowIdx) == peerRank);
             }
+            buffers.recvOffsets[peerIdx + 1] = buffers.recvIndices.size();
         }
 
         // wait for all send operations to complete
-        peerIt = overlap_->peerSet().begin();
-        for (; peerIt != peerEndIt; ++peerIt) {
-            ProcessRank peerRank = *peerIt;
-            numIndicesSendBuff_[peerRank]->wait();
-            indicesSendBuff_[peerRank]->wait();
-
-            // convert the global indices of the send buffer to
-            // domestic ones
-            MpiBuffer<Index>& indicesSendBuff = *indicesSendBuff_[peerRank];
-            for (unsigned i = 0; i < indicesSendBuff.size(); ++i) {
-                indicesSendBuff[i] = overlap_->globalToDomestic(indicesSendBuff[i]);
-            }
+        for (std::size_t peerIdx = 0; peerIdx < numPeers; ++peerIdx) {
+            numIndicesSendBuff[peerIdx]->wait();
+            indicesSendBuff[peerIdx]->wait();
+        }
+
+        // create the buffers for the values and the persistent requests which
+        // communicate them
+        buffers.sendValues.resize(numPeers);
+        buffers.recvValues.resize(numPeers);
+        buffers.sendRequests.resize(numPeers);
+        buffers.recvRequests.resize(numPeers);
+        for (std::size_t peerIdx = 0; peerIdx < numPeers; ++peerIdx) {
+            const ProcessRank peerRank = buffers.peerRanks[peerIdx];
+
+            const std::size_t numSend = buffers.sendOffsets[peerIdx + 1] - buffers.sendOffsets[peerIdx];
+            buffers.sendValues[peerIdx] = std::make_unique<MpiBuffer<FieldVector> >(numSend);
+            buffers.sendValues[peerIdx]->sendInit(peerRank);
+            buffers.sendRequests[peerIdx] = buffers.sendValues[peerIdx]->request();
+
+            const std::size_t numRecv = buffers.recvOffsets[peerIdx + 1] - buffers.recvOffsets[peerIdx];
+            buffers.recvValues[peerIdx] = std::make_unique<MpiBuffer<FieldVector> >(numRecv);
+            buffers.recvValues[peerIdx]->receiveInit(peerRank);
+            buffers.recvRequests[peerIdx] = buffers.recvValues[peerIdx]->request();
         }
 #endif // HAVE_MPI
     }
 
-    void sendEntries_(ProcessRank peerRank)
+    void startReceive_()
     {
-        // copy the values into the send buffer
-        const MpiBuffer<Index>& indices = *indicesSendBuff_[peerRank];
-        MpiBuffer<FieldVector>& values = *valuesSendBuff_[peerRank];
-        for (unsigned i = 0; i < indices.size(); ++i)
-            values[i] = (*this)[static_cast<unsigned>(indices[i])];
-
-        values.send(peerRank);
+#if HAVE_MPI
+        PeerBuffers& buffers = *buffers_;
+        if (!buffers.peerRanks.empty())
+            MPI_Startall(static_cast<int>(buffers.peerRanks.size()), buffers.recvRequests.data());
+#endif // HAVE_MPI
     }
 
-    void waitSendFinished_()
+    void sendEntries_()
     {
-        typename PeerSet::const_iterator peerIt;
-        typename PeerSet::const_iterator peerEndIt = overlap_->peerSet().end();
-
-        // send all entries to all peers
-        peerIt = overlap_->peerSet().begin();
-        for (; peerIt != peerEndIt; ++peerIt) {
-            ProcessRank peerRank = *peerIt;
-            valuesSendBuff_[peerRank]->wait();
+#if HAVE_MPI
+        PeerBuffers& buffers = *buffers_;
+        if (buffers.peerRanks.empty())
+            return;
+
+        // copy the values into the send buffers
+        for (std::size_t peerIdx = 0; peerIdx < buffers.peerRanks.size(); ++peerIdx) {
+            MpiBuffer<FieldVector>& values = *buffers.sendValues[peerIdx];
+            const Index* indices = buffers.sendIndices.data() + buffers.sendOffsets[peerIdx];
+            for (std::size_t i = 0; i < values.size(); ++i)
+                values[i] = (*this)[static_cast<unsigned>(indices[i])];
         }
+
+        MPI_Startall(static_cast<int>(buffers.peerRanks.size()), buffers.sendRequests.data());
+#endif // HAVE_MPI
     }
 
-    void receiveFromMaster_(ProcessRank peerRank)
+    void waitSendFinished_()
     {
-        const MpiBuffer<Index>& indices = *indicesRecvBuff_[peerRank];
-        MpiBuffer<FieldVector>& values = *valuesRecvBuff_[peerRank];
-
-        // receive the values from the peer
-        values.receive(peerRank);
+#if HAVE_MPI
+        PeerBuffers& buffers = *buffers_;
+        MPI_Waitall(static_cast<int>(buffers.peerRanks.size()),
+                    buffers.sendRequests.data(),
+                    MPI_STATUSES_IGNORE);
+#endif // HAVE_MPI
+    }
 
-        // copy them into the block vector
-        for (unsigned j = 0; j < indices.size(); ++j) {
-            Index domRowIdx = indices[j];
-            if (overlap_->masterRank(domRowIdx) == peerRank) {
-                (*this)[static_cast<unsigned>(domRowIdx)] = values[j];
-            }
+    void receiveFromMaster_(std::size_t peerIdx)
+    {
+        const PeerBuffers& buffers = *buffers_;
+        const MpiBuffer<FieldVector>& values = *buffers.recvValues[peerIdx];
+        const std::size_t offset = buffers.recvOffsets[peerIdx];
+
+        // copy the values of the rows mastered by the peer into the block vector
+        for (std::size_t j = 0; j < values.size(); ++j) {
+            if (buffers.recvFromMaster[offset + j])
+                (*this)[static_cast<unsigned>(buffers.recvIndices[offset + j])] = values[j];
         }
     }
 
-    void receiveAdd_(ProcessRank peerRank)
+    void receiveAdd_(std::size_t peerIdx)
     {
-        const MpiBuffer<Index>& indices = *indicesRecvBuff_[peerRank];
-        MpiBuffer<FieldVector>& values = *valuesRecvBuff_[peerRank];
-
-        // receive the values from the peer
-        values.receive(peerRank);
+        const PeerBuffers& buffers = *buffers_;
+        const MpiBuffer<FieldVector>& values = *buffers.recvValues[peerIdx];
+        const Index* indices = buffers.recvIndices.data() + buffers.recvOffsets[peerIdx];
 
         // add up the values of rows on the shared boundary
-        for (unsigned j = 0; j < indices.size(); ++j) {
-            Index domRowIdx = indices[j];
-            (*this)[static_cast<unsigned>(domRowIdx)] += values[j];
-        }
+        for (std::size_t j = 0; j < values.size(); ++j)
+            (*this)[static_cast<unsigned>(indices[j])] += values[j];
     }
 
-    std::map<ProcessRank, std::shared_ptr<MpiBuffer<unsigned> > > numIndicesSendBuff_;
-    std::map<ProcessRank, std::shared_ptr<MpiBuffer<Index> > > indicesSendBuff_;
-    std::map<ProcessRank, std::shared_ptr<MpiBuffer<Index> > > indicesRecvBuff_;
-    std::map<ProcessRank, std::shared_ptr<MpiBuffer<FieldVector> > > valuesSendBuff_;
-    std::map<ProcessRank, std::shared_ptr<MpiBuffer<FieldVector> > > valuesRecvBuff_;
+    std::shared_ptr<PeerBuffers> buffers_;
 
     const Overlap *overlap_;
 };
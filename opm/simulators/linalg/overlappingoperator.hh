@@ -30,6 +30,9 @@
 #include <dune/istl/operators.hh>
 #include <dune/common/version.hh>
 
+#include <cstddef>
+#include <vector>
+
 namespace Opm {
 namespace Linear {
 
@@ -48,7 +51,7 @@ public:
     using field_type = typename domain_type::field_type;
 
     OverlappingOperator(const OverlappingMatrix& A) : A_(A)
-    {}
+    { classifyRows_(); }
 
     //! the kind of computations supported by the operator. Either overlapping or non-overlapping
     Dune::SolverCategory::Category category() const override
@@ -57,16 +60,44 @@ public:
     //! apply operator to x:  \f$ y = A(x) \f$
     virtual void apply(const DomainVector& x, RangeVector& y) const override
     {
-        A_.mv(x, y);
-        y.sync();
+        if (overlap().peerSet().empty()) {
+            A_.mv(x, y);
+            y.sync();
+            return;
+        }
+
+        // compute the rows which are sent to the peer ranks first, and overlap the
+        // communication with the computation of the remaining rows
+        for (const auto rowIdx : frontRows_) {
+            y[rowIdx] = 0.0;
+            umvRow_(rowIdx, x, y);
+        }
+        y.syncBegin();
+
+        for (const auto rowIdx : interiorRows_) {
+            y[rowIdx] = 0.0;
+            umvRow_(rowIdx, x, y);
+        }
+        y.syncEnd();
     }
 
     //! apply operator to x, scale and add:  \f$ y = y + \alpha A(x) \f$
     virtual void applyscaleadd(field_type alpha, const DomainVector& x,
                                RangeVector& y) const override
     {
-        A_.usmv(alpha, x, y);
-        y.sync();
+        if (overlap().peerSet().empty()) {
+            A_.usmv(alpha, x, y);
+            y.sync();
+            return;
+        }
+
+        for (const auto rowIdx : frontRows_)
+            usmvRow_(alpha, rowIdx, x, y);
+        y.syncBegin();
+
+        for (const auto rowIdx : interiorRows_)
+            usmvRow_(alpha, rowIdx, x, y);
+        y.syncEnd();
     }
 
     //! returns the matrix
@@ -77,7 +108,46 @@ public:
     { return A_.overlap(); }
 
 private:
+    // determine the rows which are sent to other ranks when the result is synchronized
+    // (the "front" rows) and the remaining ones.
+    void classifyRows_()
+    {
+        const Overlap& ovlp = overlap();
+        std::vector<bool> isFrontRow(A_.N(), false);
+        for (const auto peerRank : ovlp.peerSet()) {
+            const std::size_t numEntries = ovlp.foreignOverlapSize(peerRank);
+            for (unsigned i = 0; i < numEntries; ++i)
+                isFrontRow[static_cast<std::size_t>(ovlp.foreignOverlapOffsetToDomesticIdx(peerRank, i))] = true;
+        }
+
+        for (std::size_t rowIdx = 0; rowIdx < isFrontRow.size(); ++rowIdx) {
+            if (isFrontRow[rowIdx])
+                frontRows_.push_back(rowIdx);
+            else
+                interiorRows_.push_back(rowIdx);
+        }
+    }
+
+    void umvRow_(std::size_t rowIdx, const DomainVector& x, RangeVector& y) const
+    {
+        const auto& row = A_[rowIdx];
+        auto& yRow = y[rowIdx];
+        for (auto colIt = row.begin(); colIt != row.end(); ++colIt)
+            colIt->umv(x[colIt.index()], yRow);
+    }
+
+    void usmvRow_(field_type alpha, std::size_t rowIdx, const DomainVector& x, RangeVector& y) const
+    {
+        const auto& row = A_[rowIdx];
+        auto& yRow = y[rowIdx];
+        for (auto colIt = row.begin(); colIt != row.end(); ++colIt)
+            colIt->usmv(alpha, x[colIt.index()], yRow);
+    }
+
     const OverlappingMatrix& A_;
+
+    std::vector<std::size_t> frontRows_;
+    std::vector<std::size_t> interiorRows_;
 };
 
 } // namespace Linear
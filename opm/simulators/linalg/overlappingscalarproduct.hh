@@ -57,6 +57,18 @@ public:
 
     field_type dot(const OverlappingBlockVector& x,
                    const OverlappingBlockVector& y) const override
+    {
+        // return the global sum
+        return comm_.sum( localDot(x, y) );
+    }
+
+    /*!
+     * \brief Returns the contribution of the local process to the scalar product.
+     *
+     * This allows to combine several scalar products into a single global reduction.
+     */
+    field_type localDot(const OverlappingBlockVector& x,
+                        const OverlappingBlockVector& y) const
     {
         field_type sum = 0;
         size_t numLocal = overlap_.numLocal();
@@ -65,10 +77,16 @@ public:
                 sum += x[localIdx] * y[localIdx];
         }
 
-        // return the global sum
-        return comm_.sum( sum );
+        return sum;
     }
 
+    /*!
+     * \brief Returns the collective communication object over which the local
+     *        contributions are summed.
+     */
+    const CollectiveCommunication& communication() const
+    { return comm_; }
+
     real_type norm(const OverlappingBlockVector& x) const override
     { return std::sqrt(dot(x, x)); }
 
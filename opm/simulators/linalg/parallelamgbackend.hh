@@ -164,6 +164,10 @@ protected:
 
     std::shared_ptr<AMG> preparePreconditioner_()
     {
+        // the hierarchy of the previous solve can be reused if the matrix has not changed
+        if (amg_ && this->preconditionerUpToDate_)
+            return amg_;
+
 #if HAVE_MPI
         // create and initialize DUNE's OwnerOverlapCopyCommunication
         // using the domestic overlap
@@ -180,6 +184,7 @@ protected:
 #endif
 
         setupAmg_();
+        this->preconditionerUpToDate_ = true;
 
         return amg_;
     }
@@ -242,11 +242,17 @@ public:
     {
         overlappingMatrix_->assignFromNative(M.istlMatrix());
         overlappingMatrix_->syncAdd();
+
+        // the preconditioner needs to be set up again for the new values
+        preconditionerUpToDate_ = false;
     }
 
     /*!
      * \brief Actually solve the linear system of equations.
      *
+     * The preconditioner is only set up if the matrix has been changed by setMatrix()
+     * since the last call. Otherwise, the one of the previous solve is reused.
+     *
      * \return true if the residual reduction could be achieved, else false.
      */
     bool solve(Vector& x)
@@ -254,9 +260,6 @@ public:
         (*overlappingx_) = 0.0;
 
         auto parPreCond = asImp_().preparePreconditioner_();
-        auto precondCleanupFn = [this]() -> void
-                                { this->asImp_().cleanupPreconditioner_(); };
-        auto precondCleanupGuard = Opm::make_guard(precondCleanupFn);
         // create the parallel scalar product and the parallel operator
         ParallelScalarProduct parScalarProduct(overlappingMatrix_->overlap());
         ParallelOperator parOperator(*overlappingMatrix_);
@@ -298,6 +301,10 @@ protected:
 
     void cleanup_()
     {
+        // the preconditioner refers to the overlapping matrix
+        cleanupPreconditioner_();
+        preconditionerUpToDate_ = false;
+
         // create the overlapping Jacobian matrix and vectors
         delete overlappingMatrix_;
         delete overlappingb_;
@@ -310,10 +317,15 @@ protected:
 
     std::shared_ptr<ParallelPreconditioner> preparePreconditioner_()
     {
+        if (preconditionerUpToDate_)
+            return std::make_shared<ParallelPreconditioner>(precWrapper_.get(), overlappingMatrix_->overlap());
+
         int preconditionerIsReady = 1;
         try {
             // update sequential preconditioner
+            cleanupPreconditioner_();
             precWrapper_.prepare(*overlappingMatrix_);
+            precWrapperPrepared_ = true;
         }
         catch (const Dune::Exception& e) {
             std::cout << "Preconditioner threw exception \"" << e.what()
@@ -327,6 +339,7 @@ protected:
         preconditionerIsReady = simulator_.gridView().comm().min(preconditionerIsReady);
         if (!preconditionerIsReady)
             throw NumericalProblem("Creating the preconditioner failed");
+        preconditionerUpToDate_ = true;
 
         // create the parallel preconditioner
         return std::make_shared<ParallelPreconditioner>(precWrapper_.get(), overlappingMatrix_->overlap());
@@ -334,7 +347,10 @@ protected:
 
     void cleanupPreconditioner_()
     {
-        precWrapper_.cleanup();
+        if (precWrapperPrepared_) {
+            precWrapper_.cleanup();
+            precWrapperPrepared_ = false;
+        }
     }
 
     void writeOverlapToVTK_()
@@ -383,6 +399,10 @@ protected:
     OverlappingVector *overlappingx_;
 
     PreconditionerWrapper precWrapper_;
+    bool precWrapperPrepared_ = false;
+
+    // true if the preconditioner has been set up for the current values of the matrix
+    bool preconditionerUpToDate_ = false;
 };
 }} // namespace Linear, Opm
 
@@ -59,6 +59,7 @@ namespace Opm::Linear {
  * - \c SteepestDescent: The steepest descent solver
  * - \c ConjugatedGradients: A conjugated gradients solver
  * - \c BiCGStab: A stabilized bi-conjugated gradients solver
+ * - \c FusedBiCGStab: BiCGStab with two batched global reductions per iteration
  * - \c MinRes: A solver based on the  minimized residual algorithm
  * - \c RestartedGMRes: A restarted GMRES solver
  *
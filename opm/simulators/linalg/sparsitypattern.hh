@@ -0,0 +1,207 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ * \copydoc Opm::Linear::SparsityPattern
+ */
+#ifndef EWOMS_SPARSITY_PATTERN_HH
+#define EWOMS_SPARSITY_PATTERN_HH
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <vector>
+
+namespace Opm {
+namespace Linear {
+
+/*!
+ * \ingroup Linear
+ *
+ * \brief The sparsity pattern of a matrix in compressed row storage.
+ *
+ * The pattern is built in two passes: First, upper bounds for the number of entries
+ * of the rows are specified using reserveEntries(). After allocate() has been called,
+ * the column indices are added using addEntry(). Both methods may be called
+ * concurrently by multiple threads. Finally, finalize() sorts the column indices of
+ * each row and removes duplicates.
+ *
+ * In contrast to a std::set for each row, this only requires a few large allocations
+ * and no tree node per non-zero entry.
+ */
+class SparsityPattern
+{
+public:
+    /*!
+     * \brief The column indices of a row of the pattern.
+     */
+    class Row
+    {
+    public:
+        Row(const unsigned* begin, const unsigned* end)
+            : begin_(begin)
+            , end_(end)
+        {}
+
+        const unsigned* begin() const
+        { return begin_; }
+
+        const unsigned* end() const
+        { return end_; }
+
+        std::size_t size() const
+        { return static_cast<std::size_t>(end_ - begin_); }
+
+    private:
+        const unsigned* begin_;
+        const unsigned* end_;
+    };
+
+    explicit SparsityPattern(std::size_t numRows = 0)
+    { clear(numRows); }
+
+    /*!
+     * \brief Discard all entries and set the number of rows.
+     */
+    void clear(std::size_t numRows)
+    {
+        rowStart_.assign(numRows + 1, 0);
+        rowFill_ = std::vector<std::atomic<unsigned>>(numRows);
+        columns_.clear();
+        columns_.shrink_to_fit();
+        finalized_ = false;
+    }
+
+    /*!
+     * \brief Returns the number of rows.
+     */
+    std::size_t size() const
+    { return rowStart_.size() - 1; }
+
+    /*!
+     * \brief Returns the number of non-zero entries.
+     */
+    std::size_t numNonZeros() const
+    { return rowStart_.back(); }
+
+    /*!
+     * \brief Reserve space for a number of entries of a row.
+     *
+     * This method is thread-safe. It must not be called after allocate().
+     */
+    void reserveEntries(std::size_t rowIdx, unsigned numEntries)
+    {
+        assert(rowIdx < size());
+        rowFill_[rowIdx].fetch_add(numEntries, std::memory_order_relaxed);
+    }
+
+    /*!
+     * \brief Allocate the space for all reserved entries.
+     */
+    void allocate()
+    {
+        const std::size_t numRows = size();
+        rowStart_[0] = 0;
+        for (std::size_t rowIdx = 0; rowIdx < numRows; ++rowIdx) {
+            rowStart_[rowIdx + 1] = rowStart_[rowIdx] + rowFill_[rowIdx].load(std::memory_order_relaxed);
+            rowFill_[rowIdx].store(0, std::memory_order_relaxed);
+        }
+        columns_.resize(rowStart_[numRows]);
+    }
+
+    /*!
+     * \brief Add an entry to a row.
+     *
+     * This method is thread-safe. The entry may already be present, but the total
+     * number of calls for a row must not exceed the number of reserved entries.
+     */
+    void addEntry(std::size_t rowIdx, unsigned colIdx)
+    {
+        assert(rowIdx < size());
+        const unsigned pos = rowFill_[rowIdx].fetch_add(1, std::memory_order_relaxed);
+        assert(rowStart_[rowIdx] + pos < rowStart_[rowIdx + 1]);
+        columns_[rowStart_[rowIdx] + pos] = colIdx;
+    }
+
+    /*!
+     * \brief Sort the column indices of all rows and remove the duplicates as well as
+     *        the unused reserved entries.
+     */
+    void finalize()
+    {
+        const std::size_t numRows = size();
+        std::vector<std::size_t> rowSize(numRows);
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+        for (long rowIdx = 0; rowIdx < static_cast<long>(numRows); ++rowIdx) {
+            auto begin = columns_.begin() + rowStart_[rowIdx];
+            auto end = begin + rowFill_[rowIdx].load(std::memory_order_relaxed);
+            std::sort(begin, end);
+            rowSize[rowIdx] = static_cast<std::size_t>(std::unique(begin, end) - begin);
+        }
+
+        std::vector<std::size_t> newRowStart(numRows + 1);
+        newRowStart[0] = 0;
+        for (std::size_t rowIdx = 0; rowIdx < numRows; ++rowIdx)
+            newRowStart[rowIdx + 1] = newRowStart[rowIdx] + rowSize[rowIdx];
+
+        std::vector<unsigned> newColumns(newRowStart[numRows]);
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+        for (long rowIdx = 0; rowIdx < static_cast<long>(numRows); ++rowIdx) {
+            std::copy_n(columns_.begin() + rowStart_[rowIdx],
+                        rowSize[rowIdx],
+                        newColumns.begin() + newRowStart[rowIdx]);
+        }
+
+        rowStart_ = std::move(newRowStart);
+        columns_ = std::move(newColumns);
+        rowFill_ = std::vector<std::atomic<unsigned>>();
+        finalized_ = true;
+    }
+
+    /*!
+     * \brief Returns the sorted column indices of a row.
+     *
+     * This method may only be called after finalize().
+     */
+    Row operator[](std::size_t rowIdx) const
+    {
+        assert(finalized_);
+        return Row(columns_.data() + rowStart_[rowIdx], columns_.data() + rowStart_[rowIdx + 1]);
+    }
+
+private:
+    std::vector<std::size_t> rowStart_;
+    std::vector<std::atomic<unsigned>> rowFill_;
+    std::vector<unsigned> columns_;
+    bool finalized_ = false;
+};
+
+} // namespace Linear
+} // namespace Opm
+
+#endif
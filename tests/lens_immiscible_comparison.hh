@@ -0,0 +1,136 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ *
+ * \brief Helpers for the tests which simulate the lens problem several times within
+ *        the same process and compare the results of the runs.
+ */
+#ifndef EWOMS_LENS_IMMISCIBLE_COMPARISON_HH
+#define EWOMS_LENS_IMMISCIBLE_COMPARISON_HH
+
+#include <opm/models/discretization/common/fvbaseproperties.hh>
+#include <opm/models/utils/parametersystem.hh>
+#include <opm/models/utils/start.hh>
+
+#include <dune/grid/common/rangegenerators.hh>
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace Opm::LensComparison {
+
+/*!
+ * \brief Run the simulation and return the primary variables at its end.
+ *
+ * The primary variables are returned in the order of the grid's elements, so results
+ * of runs which number the degrees of freedom differently can be compared directly.
+ * After the simulation has finished, the simulator is passed to the \c inspect
+ * callback.
+ *
+ * \param extraArgs Command line arguments which are appended to the ones of the test
+ */
+template <class TypeTag, class InspectFn>
+std::vector<double> runSimulation(int argc, char **argv,
+                                  const std::vector<std::string>& extraArgs,
+                                  InspectFn inspect)
+{
+    using Simulator = GetPropType<TypeTag, Properties::Simulator>;
+    using ThreadManager = GetPropType<TypeTag, Properties::ThreadManager>;
+
+    // the time step sizes must not depend on the number of Newton iterations, which
+    // may be different for the compared runs
+    std::vector<std::string> args(argv, argv + argc);
+    args.push_back("--end-time=3000");
+    args.push_back("--max-time-step-size=250");
+    args.push_back("--enable-vtk-output=false");
+    args.insert(args.end(), extraArgs.begin(), extraArgs.end());
+
+    std::vector<const char*> cArgs;
+    for (const auto& arg : args)
+        cArgs.push_back(arg.c_str());
+
+    Parameters::reset();
+    if (setupParameters_<TypeTag>(static_cast<int>(cArgs.size()), cArgs.data()) != 0)
+        throw std::runtime_error("Could not set up the parameters");
+
+    ThreadManager::init();
+
+    Simulator simulator(/*verbose=*/false);
+    simulator.run();
+
+    const auto& model = simulator.model();
+    std::vector<double> result;
+    for (const auto& elem : elements(simulator.gridView())) {
+        const auto& priVars = model.solution(/*timeIdx=*/0)[model.dofMapper().index(elem)];
+        result.insert(result.end(), priVars.begin(), priVars.end());
+    }
+
+    inspect(static_cast<const Simulator&>(simulator));
+
+    return result;
+}
+
+/*!
+ * \copydoc runSimulation
+ */
+template <class TypeTag>
+std::vector<double> runSimulation(int argc, char **argv,
+                                  const std::vector<std::string>& extraArgs = {})
+{
+    return runSimulation<TypeTag>(argc, argv, extraArgs, [](const auto&) {});
+}
+
+/*!
+ * \brief Returns true if two results agree within a given relative tolerance.
+ *
+ * The differences are taken relative to the reference, but at least relative to one
+ * so that primary variables close to zero do not dominate the comparison.
+ */
+inline bool resultsAgree(const std::vector<double>& reference,
+                         const std::vector<double>& result,
+                         double tolerance = 1e-4)
+{
+    if (reference.size() != result.size()) {
+        std::cerr << "The number of primary variables differs\n";
+        return false;
+    }
+
+    double maxRelDiff = 0.0;
+    for (std::size_t i = 0; i < result.size(); ++i) {
+        const double scale = std::max(1.0, std::abs(reference[i]));
+        maxRelDiff = std::max(maxRelDiff, std::abs(result[i] - reference[i])/scale);
+    }
+
+    std::cout << "maximum relative difference of the primary variables: " << maxRelDiff << "\n";
+    return maxRelDiff <= tolerance;
+}
+
+} // namespace Opm::LensComparison
+
+#endif // EWOMS_LENS_IMMISCIBLE_COMPARISON_HH
@@ -0,0 +1,75 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ *
+ * \brief Two-phase test for the immiscible model which uses the element-centered finite
+ *        volume discretization with the degrees of freedom numbered in reverse
+ *        Cuthill-McKee order.
+ *
+ * The problem is simulated once with the element numbering of the grid and once with
+ * the reverse Cuthill-McKee numbering. The results of both runs must agree.
+ */
+#include "config.h"
+
+#include "lens_immiscible_comparison.hh"
+#include "lens_immiscible_ecfv_ad.hh"
+
+#include <opm/models/discretization/common/rcmelementmapper.hh>
+#include <opm/simulators/linalg/parallelbicgstabbackend.hh>
+
+#include <iostream>
+#include <vector>
+
+namespace Opm::Properties {
+
+namespace TTag {
+struct LensProblemEcfvAdRcm { using InheritsFrom = std::tuple<LensProblemEcfvAd>; };
+} // end namespace TTag
+
+// number the elements in reverse Cuthill-McKee order
+template<class TypeTag>
+struct ElementMapper<TypeTag, TTag::LensProblemEcfvAdRcm>
+{ using type = Opm::RcmElementMapper<GetPropType<TypeTag, Properties::GridView>>; };
+
+} // namespace Opm::Properties
+
+int main(int argc, char **argv)
+{
+    Dune::MPIHelper::instance(argc, argv);
+
+    using GridOrderTypeTag = Opm::Properties::TTag::LensProblemEcfvAd;
+    using RcmOrderTypeTag = Opm::Properties::TTag::LensProblemEcfvAdRcm;
+
+    const std::vector<double> reference = Opm::LensComparison::runSimulation<GridOrderTypeTag>(argc, argv);
+    const std::vector<double> result = Opm::LensComparison::runSimulation<RcmOrderTypeTag>(argc, argv);
+
+    // the linear systems are solved with different preconditioners, so the results only
+    // agree up to the tolerance of the Newton method
+    if (!Opm::LensComparison::resultsAgree(reference, result)) {
+        std::cerr << "The results of the grid and the reverse Cuthill-McKee ordering differ\n";
+        return 1;
+    }
+
+    return 0;
+}
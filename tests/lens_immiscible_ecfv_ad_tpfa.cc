@@ -0,0 +1,60 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ *
+ * \brief Two-phase test for the immiscible model which uses the element-centered finite
+ *        volume discretization with two-point-flux and TpfaLinearizer.
+ *
+ * The problem is simulated once with the element contexts and TransFluxModule and once
+ * with TpfaLinearizer. The results of both runs must agree.
+ */
+#include "config.h"
+
+#include "lens_immiscible_comparison.hh"
+#include "lens_immiscible_ecfv_ad_tpfa.hh"
+
+#include <opm/simulators/linalg/parallelbicgstabbackend.hh>
+
+#include <iostream>
+#include <vector>
+
+int main(int argc, char **argv)
+{
+    Dune::MPIHelper::instance(argc, argv);
+
+    using ElementContextTypeTag = Opm::Properties::TTag::LensProblemEcfvAdTrans;
+    using TpfaTypeTag = Opm::Properties::TTag::LensProblemEcfvAdTpfa;
+
+    const std::vector<double> reference = Opm::LensComparison::runSimulation<ElementContextTypeTag>(argc, argv);
+    const std::vector<double> result = Opm::LensComparison::runSimulation<TpfaTypeTag>(argc, argv);
+
+    // the fluxes are the same, but the linear systems are assembled in a different
+    // order, so the results only agree up to the tolerance of the Newton method
+    if (!Opm::LensComparison::resultsAgree(reference, result)) {
+        std::cerr << "The results of the element context and the TPFA linearizer differ\n";
+        return 1;
+    }
+
+    return 0;
+}
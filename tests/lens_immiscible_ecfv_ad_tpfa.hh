@@ -0,0 +1,53 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ *
+ * \brief Two-phase test for the immiscible model which uses the element-centered finite
+ *        volume discretization with two-point-flux and TpfaLinearizer.
+ */
+#ifndef EWOMS_LENS_IMMISCIBLE_ECFV_AD_TPFA_HH
+#define EWOMS_LENS_IMMISCIBLE_ECFV_AD_TPFA_HH
+
+#include <opm/models/discretization/common/tpfalinearizer.hh>
+#include <opm/models/immiscible/immisciblelocalresidualtpfa.hh>
+#include "lens_immiscible_ecfv_ad_trans.hh"
+
+namespace Opm::Properties {
+
+namespace TTag {
+struct LensProblemEcfvAdTpfa { using InheritsFrom = std::tuple<LensProblemEcfvAdTrans>; };
+} // end namespace TTag
+
+// linearize the problem without element contexts
+template<class TypeTag>
+struct Linearizer<TypeTag, TTag::LensProblemEcfvAdTpfa>
+{ using type = Opm::TpfaLinearizer<TypeTag>; };
+
+template<class TypeTag>
+struct LocalResidual<TypeTag, TTag::LensProblemEcfvAdTpfa>
+{ using type = Opm::ImmiscibleLocalResidualTPFA<TypeTag>; };
+
+} // namespace Opm::Properties
+
+#endif // EWOMS_LENS_IMMISCIBLE_ECFV_AD_TPFA_HH
@@ -0,0 +1,96 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ *
+ * \brief Test for the selective linearization of TpfaLinearizer.
+ *
+ * The lens problem is simulated with TpfaLinearizer once with a full assembly in
+ * every Newton iteration and twice with the selective linearization: With a threshold
+ * of zero, the fluxes of a cell are only reused if neither its own primary variables
+ * nor the ones of its neighbors changed at all, so the result must be the one of the
+ * full assembly. With a small positive threshold, the fluxes of cells which changed
+ * only slightly are reused as well. The result must still agree with the full
+ * assembly and fluxes must actually have been reused.
+ */
+#include "config.h"
+
+#include "lens_immiscible_comparison.hh"
+#include "lens_immiscible_ecfv_ad_tpfa.hh"
+
+#include <opm/simulators/linalg/parallelbicgstabbackend.hh>
+
+#include <cstddef>
+#include <iostream>
+#include <string>
+#include <vector>
+
+int main(int argc, char **argv)
+{
+    Dune::MPIHelper::instance(argc, argv);
+
+    using TypeTag = Opm::Properties::TTag::LensProblemEcfvAdTpfa;
+
+    const auto countReusedCells = [](std::size_t& numReused)
+    {
+        return [&numReused](const auto& simulator)
+        { numReused = simulator.model().linearizer().numReusedCells(); };
+    };
+
+    const std::vector<double> reference =
+        Opm::LensComparison::runSimulation<TypeTag>(argc, argv);
+
+    std::size_t numReusedExact = 0;
+    const std::vector<double> exactResult =
+        Opm::LensComparison::runSimulation<TypeTag>(argc, argv,
+                                                    {"--enable-selective-linearization=true",
+                                                     "--selective-linearization-threshold=0"},
+                                                    countReusedCells(numReusedExact));
+    std::cout << "cells reused with a threshold of zero: " << numReusedExact << "\n";
+    if (!Opm::LensComparison::resultsAgree(reference, exactResult)) {
+        std::cerr << "The results of the full and the exact selective linearization differ\n";
+        return 1;
+    }
+
+    // the Newton method hardly ever leaves the primary variables of a cell bit for bit
+    // unchanged, so whether the fluxes are reused is checked with a positive threshold
+    std::size_t numReused = 0;
+    const std::vector<double> result =
+        Opm::LensComparison::runSimulation<TypeTag>(argc, argv,
+                                                    {"--enable-selective-linearization=true",
+                                                     "--selective-linearization-threshold=1e-6",
+                                                     "--selective-linearization-max-fraction=1"},
+                                                    countReusedCells(numReused));
+    std::cout << "cells reused with a threshold of 1e-6: " << numReused << "\n";
+    if (!Opm::LensComparison::resultsAgree(reference, result)) {
+        std::cerr << "The results of the full and the selective linearization differ\n";
+        return 1;
+    }
+
+    if (numReused == 0) {
+        std::cerr << "The selective linearization did not reuse the fluxes of any cell\n";
+        return 1;
+    }
+
+    return 0;
+}
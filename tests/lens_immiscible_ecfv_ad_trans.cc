@@ -29,36 +29,11 @@
  */
 #include "config.h"
 
-#include <opm/models/immiscible/immisciblemodel.hh>
+#include "lens_immiscible_ecfv_ad_trans.hh"
+
 #include <opm/models/utils/start.hh>
-#include <opm/models/discretization/ecfv/ecfvdiscretization.hh>
 #include <opm/simulators/linalg/parallelbicgstabbackend.hh>
 
-#include "problems/lensproblem.hh"
-
-namespace Opm::Properties {
-
-// Create new type tags
-namespace TTag {
-struct LensProblemEcfvAdTrans { using InheritsFrom = std::tuple<LensBaseProblem, ImmiscibleTwoPhaseModel>; };
-} // end namespace TTag
-
-// use automatic differentiation for this simulator
-template<class TypeTag>
-struct LocalLinearizerSplice<TypeTag, TTag::LensProblemEcfvAdTrans> { using type = TTag::AutoDiffLocalLinearizer; };
-
-// use the element centered finite volume spatial discretization
-template<class TypeTag>
-struct SpatialDiscretizationSplice<TypeTag, TTag::LensProblemEcfvAdTrans> { using type = TTag::EcfvDiscretization; };
-
-// Set the problem property
-template <class TypeTag>
-struct FluxModule<TypeTag, TTag::LensProblemEcfvAdTrans> {
-    using type = TransFluxModule<TypeTag>;
-};
-
-}
-
 int main(int argc, char **argv)
 {
     using ProblemTypeTag = Opm::Properties::TTag::LensProblemEcfvAdTrans;
@@ -0,0 +1,107 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ *
+ * \brief The distributed grid and the matrix used by the tests of the algebraic
+ *        overlap of the parallel linear solvers.
+ */
+#ifndef EWOMS_OVERLAP_TEST_GRID_HH
+#define EWOMS_OVERLAP_TEST_GRID_HH
+
+#include <dune/common/fmatrix.hh>
+#include <dune/common/fvector.hh>
+#include <dune/grid/common/mcmgmapper.hh>
+#include <dune/grid/common/rangegenerators.hh>
+#include <dune/grid/yaspgrid.hh>
+#include <dune/istl/bcrsmatrix.hh>
+#include <dune/istl/matrixindexset.hh>
+
+#include <opm/simulators/linalg/elementborderlistfromgrid.hh>
+
+#include <array>
+#include <memory>
+
+namespace Opm::OverlapTest {
+
+using Grid = Dune::YaspGrid<2>;
+using GridView = Grid::LeafGridView;
+using ElementMapper = Dune::MultipleCodimMultipleGeomTypeMapper<GridView>;
+using BorderListFromGrid = Opm::Linear::ElementBorderListFromGrid<GridView, ElementMapper>;
+using Matrix = Dune::BCRSMatrix<Dune::FieldMatrix<double, 1, 1>>;
+
+//! The number of elements of the grid in each direction
+constexpr int numCells = 16;
+
+/*!
+ * \brief Create a grid of the unit square which is distributed over all processes.
+ *
+ * The partitions of neighboring processes overlap by one layer of elements.
+ */
+inline std::unique_ptr<Grid> createGrid()
+{
+    return std::make_unique<Grid>(Dune::FieldVector<double, 2>(1.0),
+                                  std::array<int, 2>{numCells, numCells});
+}
+
+/*!
+ * \brief Returns the index of an element in the cartesian grid, which does not depend
+ *        on the partitioning.
+ */
+template <class Element>
+int cartesianIndex(const Element& elem)
+{
+    const auto center = elem.geometry().center();
+    const int i = static_cast<int>(center[0]*numCells);
+    const int j = static_cast<int>(center[1]*numCells);
+    return j*numCells + i;
+}
+
+/*!
+ * \brief Create a matrix which couples each element of the process' partition with
+ *        its neighbors.
+ *
+ * The rows and columns of the matrix are the native indices of the elements, i.e.,
+ * the ones of the element mapper.
+ */
+inline Matrix createMatrix(const GridView& gridView, const ElementMapper& mapper)
+{
+    Dune::MatrixIndexSet pattern(mapper.size(), mapper.size());
+    for (const auto& elem : elements(gridView)) {
+        const auto elemIdx = mapper.index(elem);
+        pattern.add(elemIdx, elemIdx);
+        for (const auto& intersection : intersections(gridView, elem)) {
+            if (intersection.neighbor())
+                pattern.add(elemIdx, mapper.index(intersection.outside()));
+        }
+    }
+
+    Matrix matrix;
+    pattern.exportIdx(matrix);
+    matrix = 0.0;
+    return matrix;
+}
+
+} // namespace Opm::OverlapTest
+
+#endif // EWOMS_OVERLAP_TEST_GRID_HH
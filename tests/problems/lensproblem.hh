@@ -32,6 +32,8 @@
 #include <dune/common/fvector.hh>
 #include <dune/common/version.hh>
 
+#include <opm/input/eclipse/Schedule/BCProp.hpp>
+
 #include <opm/material/components/Dnapl.hpp>
 #include <opm/material/components/SimpleH2O.hpp>
 #include <opm/material/fluidmatrixinteractions/RegularizedVanGenuchten.hpp>
@@ -55,6 +57,8 @@
 #include <iostream>
 #include <sstream>
 #include <string>
+#include <utility>
+#include <vector>
 
 namespace Opm {
 template <class TypeTag>
@@ -183,6 +187,7 @@ class LensProblem : public GetPropType<TypeTag, Properties::BaseProblem>
     using WettingPhase = GetPropType<TypeTag, Properties::WettingPhase>;
     using NonwettingPhase = GetPropType<TypeTag, Properties::NonwettingPhase>;
     using PrimaryVariables = GetPropType<TypeTag, Properties::PrimaryVariables>;
+    using Stencil = GetPropType<TypeTag, Properties::Stencil>;
     using Simulator = GetPropType<TypeTag, Properties::Simulator>;
     using Model = GetPropType<TypeTag, Properties::Model>;
 
@@ -212,6 +217,7 @@ class LensProblem : public GetPropType<TypeTag, Properties::BaseProblem>
     using GlobalPosition = Dune::FieldVector<CoordScalar, dimWorld>;
 
     using DimMatrix = Dune::FieldMatrix<Scalar, dimWorld, dimWorld>;
+    using BoundaryFluidState = ImmiscibleFluidState<Scalar, FluidSystem, /*storeEnthalpy=*/false>;
 
 public:
     /*!
@@ -219,7 +225,9 @@ public:
      */
     LensProblem(Simulator& simulator)
         : ParentType(simulator)
-    { }
+    {
+        dofIsInLens_.resize(simulator.model().numGridDof());
+    }
 
     /*!
      * \copydoc FvBaseProblem::finishInit
@@ -264,6 +272,17 @@ public:
             this->gravity_ = 0;
             this->gravity_[1] = -9.81;
         }
+
+        // determine which degrees of freedom are in the lens
+        Stencil stencil(this->gridView(), this->simulator().model().dofMapper());
+        for (const auto& elem : elements(this->gridView())) {
+            stencil.update(elem);
+            for (unsigned dofIdx = 0; dofIdx < stencil.numPrimaryDof(); ++dofIdx) {
+                unsigned globalDofIdx = stencil.globalSpaceIndex(dofIdx);
+                const auto& dofPos = stencil.subControlVolume(dofIdx).globalPos();
+                dofIsInLens_[globalDofIdx] = isInLens_(dofPos);
+            }
+        }
     }
 
     /*!
@@ -363,6 +382,17 @@ public:
         return outerK_;
     }
 
+    /*!
+     * \brief Returns the intrinsic permeability tensor of a degree of freedom.
+     */
+    const DimMatrix& intrinsicPermeability(unsigned globalSpaceIdx,
+                                           unsigned /*timeIdx*/) const
+    {
+        if (dofIsInLens_[globalSpaceIdx])
+            return lensK_;
+        return outerK_;
+    }
+
     /*!
      * \copydoc FvBaseMultiPhaseProblem::porosity
      */
@@ -386,6 +416,17 @@ public:
         return outerMaterialParams_;
     }
 
+    /*!
+     * \brief Returns the parameters of the material law of a degree of freedom.
+     */
+    const MaterialLawParams& materialLawParams(unsigned globalSpaceIdx,
+                                               unsigned /*timeIdx*/) const
+    {
+        if (dofIsInLens_[globalSpaceIdx])
+            return lensMaterialParams_;
+        return outerMaterialParams_;
+    }
+
     /*!
      * \copydoc FvBaseMultiPhaseProblem::temperature
      */
@@ -474,61 +515,13 @@ public:
         const GlobalPosition& pos = context.pos(spaceIdx, timeIdx);
 
         if (onLeftBoundary_(pos) || onRightBoundary_(pos)) {
-            // free flow boundary. we assume incompressible fluids
-            Scalar densityW = WettingPhase::density(temperature_, /*pressure=*/Scalar(1e5));
-            Scalar densityN = NonwettingPhase::density(temperature_, /*pressure=*/Scalar(1e5));
-
-            Scalar T = temperature(context, spaceIdx, timeIdx);
-            Scalar pw, Sw;
-
-            // set wetting phase pressure and saturation
-            if (onLeftBoundary_(pos)) {
-                Scalar height = this->boundingBoxMax()[1] - this->boundingBoxMin()[1];
-                Scalar depth = this->boundingBoxMax()[1] - pos[1];
-                Scalar alpha = (1 + 1.5 / height);
-
-                // hydrostatic pressure scaled by alpha
-                pw = 1e5 - alpha * densityW * this->gravity()[1] * depth;
-                Sw = 1.0;
-            }
-            else {
-                Scalar depth = this->boundingBoxMax()[1] - pos[1];
-
-                // hydrostatic pressure
-                pw = 1e5 - densityW * this->gravity()[1] * depth;
-                Sw = 1.0;
-            }
-
-            // specify a full fluid state using pw and Sw
-            const MaterialLawParams& matParams = this->materialLawParams(context, spaceIdx, timeIdx);
-
-            Opm::ImmiscibleFluidState<Scalar, FluidSystem,
-                                      /*storeEnthalpy=*/false> fs;
-            fs.setSaturation(wettingPhaseIdx, Sw);
-            fs.setSaturation(nonWettingPhaseIdx, 1 - Sw);
-            fs.setTemperature(T);
-
-            Scalar pC[numPhases];
-            MaterialLaw::capillaryPressures(pC, matParams, fs);
-            fs.setPressure(wettingPhaseIdx, pw);
-            fs.setPressure(nonWettingPhaseIdx, pw + pC[nonWettingPhaseIdx] - pC[wettingPhaseIdx]);
-
-            fs.setDensity(wettingPhaseIdx, densityW);
-            fs.setDensity(nonWettingPhaseIdx, densityN);
-
-            fs.setViscosity(wettingPhaseIdx, WettingPhase::viscosity(temperature_, fs.pressure(wettingPhaseIdx)));
-            fs.setViscosity(nonWettingPhaseIdx, NonwettingPhase::viscosity(temperature_, fs.pressure(nonWettingPhaseIdx)));
-
             // impose an freeflow boundary condition
-            values.setFreeFlow(context, spaceIdx, timeIdx, fs);
+            const MaterialLawParams& matParams = this->materialLawParams(context, spaceIdx, timeIdx);
+            values.setFreeFlow(context, spaceIdx, timeIdx, freeFlowFluidState_(pos, matParams));
         }
         else if (onInlet_(pos)) {
-            RateVector massRate(0.0);
-            massRate = 0.0;
-            massRate[contiNEqIdx] = -0.04; // kg / (m^2 * s)
-
             // impose a forced flow boundary
-            values.setMassRate(massRate);
+            values.setMassRate(inletMassRate_());
         }
         else {
             // no flow boundary
@@ -536,6 +529,37 @@ public:
         }
     }
 
+    /*!
+     * \brief Returns the type of the boundary condition at a boundary face of a degree
+     *        of freedom and the mass rate for BCType::RATE.
+     *
+     * This is the variant of boundary() for linearizers which do not use element
+     * contexts.
+     */
+    std::pair<BCType, RateVector> boundaryCondition(unsigned /*globalSpaceIdx*/,
+                                                    const GlobalPosition& pos,
+                                                    unsigned /*timeIdx*/) const
+    {
+        if (onLeftBoundary_(pos) || onRightBoundary_(pos))
+            return {BCType::FREE, RateVector(0.0)};
+        else if (onInlet_(pos))
+            return {BCType::RATE, inletMassRate_()};
+        return {BCType::NONE, RateVector(0.0)};
+    }
+
+    /*!
+     * \brief Returns the state of the fluids outside of the domain at a boundary face
+     *        of a degree of freedom for which BCType::FREE is imposed.
+     */
+    BoundaryFluidState boundaryFluidState(unsigned /*globalSpaceIdx*/,
+                                          const GlobalPosition& pos,
+                                          unsigned /*timeIdx*/) const
+    {
+        const MaterialLawParams& matParams =
+            isInLens_(pos) ? lensMaterialParams_ : outerMaterialParams_;
+        return freeFlowFluidState_(pos, matParams);
+    }
+
     //! \}
 
     /*!
@@ -594,9 +618,72 @@ public:
                 unsigned /*timeIdx*/) const
     { rate = Scalar(0.0); }
 
+    /*!
+     * \brief Evaluate the source term of a degree of freedom.
+     */
+    void source(RateVector& rate,
+                unsigned /*globalSpaceIdx*/,
+                unsigned /*timeIdx*/) const
+    { rate = Scalar(0.0); }
+
     //! \}
 
 private:
+    // the state of the fluids outside of the left and right boundaries
+    BoundaryFluidState freeFlowFluidState_(const GlobalPosition& pos,
+                                           const MaterialLawParams& matParams) const
+    {
+        // we assume incompressible fluids
+        Scalar densityW = WettingPhase::density(temperature_, /*pressure=*/Scalar(1e5));
+        Scalar densityN = NonwettingPhase::density(temperature_, /*pressure=*/Scalar(1e5));
+
+        Scalar pw, Sw;
+
+        // set wetting phase pressure and saturation
+        if (onLeftBoundary_(pos)) {
+            Scalar height = this->boundingBoxMax()[1] - this->boundingBoxMin()[1];
+            Scalar depth = this->boundingBoxMax()[1] - pos[1];
+            Scalar alpha = (1 + 1.5 / height);
+
+            // hydrostatic pressure scaled by alpha
+            pw = 1e5 - alpha * densityW * this->gravity()[1] * depth;
+            Sw = 1.0;
+        }
+        else {
+            Scalar depth = this->boundingBoxMax()[1] - pos[1];
+
+            // hydrostatic pressure
+            pw = 1e5 - densityW * this->gravity()[1] * depth;
+            Sw = 1.0;
+        }
+
+        // specify a full fluid state using pw and Sw
+        BoundaryFluidState fs;
+        fs.setSaturation(wettingPhaseIdx, Sw);
+        fs.setSaturation(nonWettingPhaseIdx, 1 - Sw);
+        fs.setTemperature(temperature_);
+
+        Scalar pC[numPhases];
+        MaterialLaw::capillaryPressures(pC, matParams, fs);
+        fs.setPressure(wettingPhaseIdx, pw);
+        fs.setPressure(nonWettingPhaseIdx, pw + pC[nonWettingPhaseIdx] - pC[wettingPhaseIdx]);
+
+        fs.setDensity(wettingPhaseIdx, densityW);
+        fs.setDensity(nonWettingPhaseIdx, densityN);
+
+        fs.setViscosity(wettingPhaseIdx, WettingPhase::viscosity(temperature_, fs.pressure(wettingPhaseIdx)));
+        fs.setViscosity(nonWettingPhaseIdx, NonwettingPhase::viscosity(temperature_, fs.pressure(nonWettingPhaseIdx)));
+
+        return fs;
+    }
+
+    RateVector inletMassRate_() const
+    {
+        RateVector massRate(0.0);
+        massRate[contiNEqIdx] = -0.04; // kg / (m^2 * s)
+        return massRate;
+    }
+
     bool isInLens_(const GlobalPosition& pos) const
     {
         for (unsigned i = 0; i < dim; ++i) {
@@ -634,6 +721,8 @@ private:
     MaterialLawParams lensMaterialParams_;
     MaterialLawParams outerMaterialParams_;
 
+    std::vector<bool> dofIsInLens_;
+
     Scalar temperature_;
     Scalar eps_;
 };
@@ -0,0 +1,92 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ *
+ * \brief Makes sure that the collective accumulator reduces each value using its own
+ *        operation.
+ */
+#include "config.h"
+
+#include <dune/common/parallel/mpihelper.hh>
+
+#include <opm/models/parallel/collectiveaccumulator.hh>
+
+#include <cstddef>
+#include <iostream>
+#include <vector>
+
+int main(int argc, char **argv)
+{
+    const auto& mpiHelper = Dune::MPIHelper::instance(argc, argv);
+    const auto comm = mpiHelper.getCommunication();
+    const int rank = comm.rank();
+    const int size = comm.size();
+
+    Opm::CollectiveAccumulator collectives(comm);
+    const auto succeededIdx = collectives.addMin(rank == size - 1 ? 0 : 1);
+    const auto countIdx = collectives.addSum(rank + 1);
+    const auto errorIdx = collectives.addMax(0.5*rank);
+
+    // enough values that an MPI implementation may split the reduction into pieces
+    std::vector<std::size_t> indices;
+    for (int i = 0; i < 10000; ++i)
+        indices.push_back(collectives.addSum(i));
+
+    collectives.reduceBegin();
+    collectives.reduceEnd();
+
+    if (collectives.size() != indices.size() + 3) {
+        std::cerr << "Wrong number of values\n";
+        return 1;
+    }
+    if (collectives[succeededIdx] != 0.0) {
+        std::cerr << "Wrong minimum: " << collectives[succeededIdx] << "\n";
+        return 1;
+    }
+    if (collectives[countIdx] != size*(size + 1)/2) {
+        std::cerr << "Wrong sum: " << collectives[countIdx] << "\n";
+        return 1;
+    }
+    if (collectives[errorIdx] != 0.5*(size - 1)) {
+        std::cerr << "Wrong maximum: " << collectives[errorIdx] << "\n";
+        return 1;
+    }
+    for (std::size_t i = 0; i < indices.size(); ++i) {
+        if (collectives[indices[i]] != static_cast<double>(i)*size) {
+            std::cerr << "Wrong sum for value " << i << "\n";
+            return 1;
+        }
+    }
+
+    // the accumulator can be reused
+    collectives.clear();
+    const auto idx = collectives.addSum(1);
+    collectives.reduce();
+    if (collectives[idx] != size) {
+        std::cerr << "Wrong sum after clear()\n";
+        return 1;
+    }
+
+    return 0;
+}
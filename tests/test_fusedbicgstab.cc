@@ -0,0 +1,156 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ *
+ * \brief Makes sure that the BiCGStab solver with fused reductions solves an
+ *        unsymmetric system of equations.
+ */
+#include "config.h"
+
+#include <dune/common/fmatrix.hh>
+#include <dune/common/fvector.hh>
+#include <dune/common/parallel/mpihelper.hh>
+#include <dune/istl/bcrsmatrix.hh>
+#include <dune/istl/bvector.hh>
+#include <dune/istl/operators.hh>
+#include <dune/istl/preconditioners.hh>
+
+#include <opm/simulators/linalg/fusedbicgstabsolver.hh>
+
+#include <cmath>
+#include <iostream>
+
+namespace {
+
+using Matrix = Dune::BCRSMatrix<Dune::FieldMatrix<double, 1, 1>>;
+using Vector = Dune::BlockVector<Dune::FieldVector<double, 1>>;
+
+// a sequential scalar product which exposes the interface required by the solver
+class SequentialScalarProduct
+{
+public:
+    using CollectiveCommunication = Dune::Communication<Dune::MPIHelper::MPICommunicator>;
+
+    SequentialScalarProduct()
+        : comm_(Dune::MPIHelper::getLocalCommunicator())
+    {}
+
+    double localDot(const Vector& x, const Vector& y) const
+    { return x.dot(y); }
+
+    const CollectiveCommunication& communication() const
+    { return comm_; }
+
+private:
+    CollectiveCommunication comm_;
+};
+
+// central differences for a 1D convection-diffusion operator, i.e., the matrix is
+// not symmetric
+Matrix createMatrix(unsigned n, double peclet)
+{
+    Matrix A(n, n, 3*n, Matrix::row_wise);
+    for (auto row = A.createbegin(); row != A.createend(); ++row) {
+        const unsigned i = row.index();
+        if (i > 0)
+            row.insert(i - 1);
+        row.insert(i);
+        if (i + 1 < n)
+            row.insert(i + 1);
+    }
+
+    for (unsigned i = 0; i < n; ++i) {
+        A[i][i] = 2.0;
+        if (i > 0)
+            A[i][i - 1] = -1.0 - peclet/2;
+        if (i + 1 < n)
+            A[i][i + 1] = -1.0 + peclet/2;
+    }
+
+    return A;
+}
+
+} // anonymous namespace
+
+int main(int argc, char **argv)
+{
+    Dune::MPIHelper::instance(argc, argv);
+
+    const unsigned n = 200;
+    const double reduction = 1e-10;
+    const Matrix A = createMatrix(n, /*peclet=*/0.5);
+
+    Vector xRef(n);
+    for (unsigned i = 0; i < n; ++i)
+        xRef[i] = std::sin(0.1*i) + 1.0;
+
+    Vector b(n);
+    A.mv(xRef, b);
+    const double bNorm = b.two_norm();
+
+    Dune::MatrixAdapter<Matrix, Vector, Vector> op(A);
+    Dune::SeqJac<Matrix, Vector, Vector> preconditioner(A, /*iterations=*/1, /*relaxation=*/1.0);
+    SequentialScalarProduct scalarProduct;
+
+    Opm::Linear::FusedBiCGStabSolver<Vector, SequentialScalarProduct>
+        solver(op, scalarProduct, preconditioner, reduction, /*maxIterations=*/1000, /*verbosity=*/0);
+
+    Vector x(n);
+    x = 0.0;
+    Vector rhs(b);
+    Dune::InverseOperatorResult result;
+    solver.apply(x, rhs, result);
+
+    if (!result.converged) {
+        std::cerr << "The solver did not converge\n";
+        return 1;
+    }
+
+    // the solver overwrites the right hand side by the residual
+    Vector r(b);
+    A.mmv(x, r);
+    if (r.two_norm() > 10*reduction*bNorm) {
+        std::cerr << "The residual is too large: " << r.two_norm() << "\n";
+        return 1;
+    }
+
+    Vector residualDiff(r);
+    residualDiff -= rhs;
+    if (residualDiff.two_norm() > 10*reduction*bNorm) {
+        std::cerr << "The residual returned by the solver is wrong\n";
+        return 1;
+    }
+
+    // a vanishing right hand side must be detected without any iteration
+    Vector xZero(n);
+    xZero = 0.0;
+    rhs = 0.0;
+    solver.apply(xZero, rhs, result);
+    if (!result.converged || result.iterations != 0 || xZero.two_norm() != 0.0) {
+        std::cerr << "The solver did not detect a vanishing right hand side\n";
+        return 1;
+    }
+
+    return 0;
+}
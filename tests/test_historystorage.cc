@@ -0,0 +1,156 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ *
+ * \brief Makes sure that the storage term of the previous time step is the same with
+ *        and without the storage cache if the problem cannot recycle the storage term
+ *        of the first iteration.
+ *
+ * The porosity of the problem depends on state which is updated at the end of each
+ * time step, so the storage term of the previous time step must be evaluated before
+ * the time step is post-processed.
+ */
+#include "config.h"
+
+#include "lens_immiscible_ecfv_ad.hh"
+
+#include <opm/models/utils/start.hh>
+#include <opm/simulators/linalg/parallelbicgstabbackend.hh>
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace Opm {
+
+template <class TypeTag>
+class HistoryDependentLensProblem : public LensProblem<TypeTag>
+{
+    using ParentType = LensProblem<TypeTag>;
+    using Scalar = GetPropType<TypeTag, Properties::Scalar>;
+    using Simulator = GetPropType<TypeTag, Properties::Simulator>;
+
+public:
+    explicit HistoryDependentLensProblem(Simulator& simulator)
+        : ParentType(simulator)
+    { }
+
+    bool recycleFirstIterationStorage() const
+    { return false; }
+
+    template <class Context>
+    Scalar porosity(const Context& context, unsigned spaceIdx, unsigned timeIdx) const
+    { return ParentType::porosity(context, spaceIdx, timeIdx)*(1.0 + 1e-2*numEndedTimeSteps_); }
+
+    void endTimeStep()
+    {
+        ParentType::endTimeStep();
+        ++numEndedTimeSteps_;
+    }
+
+private:
+    int numEndedTimeSteps_ = 0;
+};
+
+} // namespace Opm
+
+namespace Opm::Properties {
+
+namespace TTag {
+struct LensProblemEcfvAdHistory { using InheritsFrom = std::tuple<LensProblemEcfvAd>; };
+} // end namespace TTag
+
+template<class TypeTag>
+struct Problem<TypeTag, TTag::LensProblemEcfvAdHistory>
+{ using type = Opm::HistoryDependentLensProblem<TypeTag>; };
+
+} // namespace Opm::Properties
+
+namespace {
+
+using TypeTag = Opm::Properties::TTag::LensProblemEcfvAdHistory;
+
+// run the simulation and return the primary variables at its end
+std::vector<double> runSimulation(int argc, char **argv, bool enableStorageCache)
+{
+    using Simulator = Opm::GetPropType<TypeTag, Opm::Properties::Simulator>;
+    using ThreadManager = Opm::GetPropType<TypeTag, Opm::Properties::ThreadManager>;
+
+    std::vector<std::string> args(argv, argv + argc);
+    args.push_back("--end-time=3000");
+    args.push_back("--enable-vtk-output=false");
+    args.push_back(std::string("--enable-storage-cache=") + (enableStorageCache ? "true" : "false"));
+
+    std::vector<const char*> cArgs;
+    for (const auto& arg : args)
+        cArgs.push_back(arg.c_str());
+
+    Opm::Parameters::reset();
+    if (Opm::setupParameters_<TypeTag>(static_cast<int>(cArgs.size()), cArgs.data()) != 0)
+        throw std::runtime_error("Could not set up the parameters");
+
+    ThreadManager::init();
+
+    Simulator simulator(/*verbose=*/false);
+    simulator.run();
+
+    std::vector<double> result;
+    for (const auto& priVars : simulator.model().solution(/*timeIdx=*/0))
+        result.insert(result.end(), priVars.begin(), priVars.end());
+
+    return result;
+}
+
+} // anonymous namespace
+
+int main(int argc, char **argv)
+{
+    Dune::MPIHelper::instance(argc, argv);
+
+    const std::vector<double> withoutCache = runSimulation(argc, argv, /*enableStorageCache=*/false);
+    const std::vector<double> withCache = runSimulation(argc, argv, /*enableStorageCache=*/true);
+
+    if (withoutCache.size() != withCache.size()) {
+        std::cerr << "The number of primary variables differs\n";
+        return 1;
+    }
+
+    double maxRelDiff = 0.0;
+    for (std::size_t i = 0; i < withCache.size(); ++i) {
+        const double scale = std::max(1.0, std::abs(withoutCache[i]));
+        maxRelDiff = std::max(maxRelDiff, std::abs(withCache[i] - withoutCache[i])/scale);
+    }
+
+    std::cout << "maximum relative difference of the primary variables: " << maxRelDiff << "\n";
+    if (maxRelDiff > 1e-6) {
+        std::cerr << "The results with and without the storage cache differ\n";
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,276 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ *
+ * \brief Makes sure that only the intensive quantities of the degrees of freedom whose
+ *        primary variables have changed get recalculated.
+ *
+ * This is checked for the model itself and for the updates of the solution by the
+ * Newton method, with and without a threshold for the change of the primary variables.
+ */
+#include "config.h"
+
+#include "lens_immiscible_ecfv_ad.hh"
+
+#include <opm/models/discretization/common/fvbasenewtonmethod.hh>
+#include <opm/models/utils/start.hh>
+#include <opm/simulators/linalg/parallelbicgstabbackend.hh>
+
+#include <atomic>
+#include <cstddef>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace Opm {
+
+//! Intensive quantities which count how often they were recalculated
+template <class TypeTag>
+class CountingIntensiveQuantities : public ImmiscibleIntensiveQuantities<TypeTag>
+{
+    using ParentType = ImmiscibleIntensiveQuantities<TypeTag>;
+    using ElementContext = GetPropType<TypeTag, Properties::ElementContext>;
+
+public:
+    void update(const ElementContext& elemCtx, unsigned dofIdx, unsigned timeIdx)
+    {
+        ParentType::update(elemCtx, dofIdx, timeIdx);
+        if (timeIdx == 0)
+            ++numUpdates;
+    }
+
+    static std::atomic<std::size_t> numUpdates;
+};
+
+template <class TypeTag>
+std::atomic<std::size_t> CountingIntensiveQuantities<TypeTag>::numUpdates{0};
+
+//! Newton method which allows the test to update the solution
+template <class TypeTag>
+class UpdateTestNewtonMethod : public FvBaseNewtonMethod<TypeTag>
+{
+    using ParentType = FvBaseNewtonMethod<TypeTag>;
+
+public:
+    using ParentType::ParentType;
+    using ParentType::update_;
+};
+
+} // namespace Opm
+
+namespace Opm::Properties {
+
+namespace TTag {
+struct LensProblemEcfvAdCountingIq { using InheritsFrom = std::tuple<LensProblemEcfvAd>; };
+} // end namespace TTag
+
+template<class TypeTag>
+struct IntensiveQuantities<TypeTag, TTag::LensProblemEcfvAdCountingIq>
+{ using type = Opm::CountingIntensiveQuantities<TypeTag>; };
+
+template<class TypeTag>
+struct NewtonMethod<TypeTag, TTag::LensProblemEcfvAdCountingIq>
+{ using type = Opm::UpdateTestNewtonMethod<TypeTag>; };
+
+} // namespace Opm::Properties
+
+namespace {
+
+using TypeTag = Opm::Properties::TTag::LensProblemEcfvAdCountingIq;
+using Simulator = Opm::GetPropType<TypeTag, Opm::Properties::Simulator>;
+using ThreadManager = Opm::GetPropType<TypeTag, Opm::Properties::ThreadManager>;
+using IntensiveQuantities = Opm::GetPropType<TypeTag, Opm::Properties::IntensiveQuantities>;
+using SolutionVector = Opm::GetPropType<TypeTag, Opm::Properties::SolutionVector>;
+using GlobalEqVector = Opm::GetPropType<TypeTag, Opm::Properties::GlobalEqVector>;
+using Indices = Opm::GetPropType<TypeTag, Opm::Properties::Indices>;
+
+// the primary variable which is modified by the Newton updates of the tests. the
+// weight of the saturations is one, so the changes are not scaled. the updates are
+// subtracted, so positive values keep the initial wetting saturation below one.
+constexpr unsigned saturationPvIdx = Indices::saturation0Idx;
+
+// let the Newton method apply an update to the solution and return the number of
+// recalculated intensive quantities
+std::size_t applyNewtonUpdate(Simulator& simulator, const GlobalEqVector& solutionUpdate)
+{
+    auto& model = simulator.model();
+    auto& solution = model.solution(/*timeIdx=*/0);
+    const SolutionVector currentSolution(solution);
+    GlobalEqVector residual(solutionUpdate.size());
+    residual = 0.0;
+
+    model.newtonMethod().update_(solution, currentSolution, solutionUpdate, residual);
+
+    auto& numUpdates = IntensiveQuantities::numUpdates;
+    numUpdates = 0;
+    model.updateIntensiveQuantities(/*timeIdx=*/0);
+    return numUpdates;
+}
+
+// check the invalidation of the intensive quantities by the model and by the Newton
+// method without a threshold
+int checkInvalidation(Simulator& simulator)
+{
+    auto& model = simulator.model();
+    model.applyInitialSolution();
+    const std::size_t numDof = model.numGridDof();
+    auto& numUpdates = IntensiveQuantities::numUpdates;
+
+    numUpdates = 0;
+    model.invalidateAndUpdateIntensiveQuantities(/*timeIdx=*/0);
+    if (numUpdates != numDof) {
+        std::cerr << "Recalculated the intensive quantities of " << numUpdates
+                  << " instead of all " << numDof << " degrees of freedom\n";
+        return 1;
+    }
+
+    // nothing has changed, so nothing needs to be recalculated
+    numUpdates = 0;
+    model.updateIntensiveQuantities(/*timeIdx=*/0);
+    if (numUpdates != 0) {
+        std::cerr << "Recalculated " << numUpdates
+                  << " intensive quantities although the solution did not change\n";
+        return 1;
+    }
+
+    // modify a few degrees of freedom the way the Newton method does
+    const std::size_t stride = 7;
+    std::size_t numChanged = 0;
+    auto& solution = model.solution(/*timeIdx=*/0);
+    for (std::size_t dofIdx = 0; dofIdx < numDof; dofIdx += stride) {
+        solution[dofIdx][/*pvIdx=*/0] *= 1.01;
+        model.setIntensiveQuantitiesCacheEntryValidity(dofIdx, /*timeIdx=*/0, /*valid=*/false);
+        ++numChanged;
+    }
+
+    numUpdates = 0;
+    model.updateIntensiveQuantities(/*timeIdx=*/0);
+    if (numUpdates != numChanged) {
+        std::cerr << "Recalculated " << numUpdates << " intensive quantities after "
+                  << numChanged << " degrees of freedom were changed\n";
+        return 1;
+    }
+
+    // a failed update only needs to recalculate the degrees of freedom which are reset
+    numUpdates = 0;
+    model.updateFailed();
+    if (numUpdates != numChanged) {
+        std::cerr << "Recalculated " << numUpdates << " intensive quantities after "
+                  << numChanged << " degrees of freedom were reset\n";
+        return 1;
+    }
+
+    for (std::size_t dofIdx = 0; dofIdx < numDof; ++dofIdx) {
+        if (!model.cachedIntensiveQuantities(dofIdx, /*timeIdx=*/0)) {
+            std::cerr << "The intensive quantities of degree of freedom " << dofIdx
+                      << " are not cached\n";
+            return 1;
+        }
+    }
+
+    // the Newton method invalidates the degrees of freedom which it changed
+    GlobalEqVector solutionUpdate(numDof);
+    solutionUpdate = 0.0;
+    for (std::size_t dofIdx = 0; dofIdx < numDof; dofIdx += stride)
+        solutionUpdate[dofIdx][saturationPvIdx] = 1e-3;
+
+    const std::size_t numNewtonUpdates = applyNewtonUpdate(simulator, solutionUpdate);
+    if (numNewtonUpdates != numChanged) {
+        std::cerr << "Recalculated " << numNewtonUpdates << " intensive quantities after "
+                  << numChanged << " degrees of freedom were updated by the Newton method\n";
+        return 1;
+    }
+
+    return 0;
+}
+
+// check that the Newton method accumulates the changes of the primary variables until
+// they exceed the threshold
+int checkUpdateThreshold(Simulator& simulator, double threshold)
+{
+    auto& model = simulator.model();
+    model.applyInitialSolution();
+    model.invalidateAndUpdateIntensiveQuantities(/*timeIdx=*/0);
+
+    const std::size_t numDof = model.numGridDof();
+    const std::size_t stride = 7;
+    GlobalEqVector solutionUpdate(numDof);
+    solutionUpdate = 0.0;
+    std::size_t numChanged = 0;
+    for (std::size_t dofIdx = 0; dofIdx < numDof; dofIdx += stride) {
+        solutionUpdate[dofIdx][saturationPvIdx] = 0.4*threshold;
+        ++numChanged;
+    }
+
+    // the changes are recalculated in the third iteration and then start to
+    // accumulate again
+    const std::vector<std::size_t> expectedUpdates = {0, 0, numChanged, 0, 0, numChanged};
+    for (std::size_t iterIdx = 0; iterIdx < expectedUpdates.size(); ++iterIdx) {
+        const std::size_t numUpdates = applyNewtonUpdate(simulator, solutionUpdate);
+        if (numUpdates != expectedUpdates[iterIdx]) {
+            std::cerr << "Recalculated " << numUpdates << " instead of "
+                      << expectedUpdates[iterIdx] << " intensive quantities in Newton iteration "
+                      << iterIdx << " with a threshold of " << threshold << "\n";
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+} // anonymous namespace
+
+int main(int argc, char **argv)
+{
+    Dune::MPIHelper::instance(argc, argv);
+
+    const int paramStatus = Opm::setupParameters_<TypeTag>(argc, const_cast<const char**>(argv));
+    if (paramStatus == 1)
+        return 1;
+    if (paramStatus == 2)
+        return 0;
+
+    ThreadManager::init();
+
+    {
+        Simulator simulator(/*verbose=*/false);
+        if (checkInvalidation(simulator) != 0)
+            return 1;
+    }
+
+    // the threshold is read when the Newton method is created
+    const double threshold = 1e-3;
+    std::vector<std::string> args(argv, argv + argc);
+    args.push_back("--intensive-quantity-update-threshold=" + std::to_string(threshold));
+    std::vector<const char*> cArgs;
+    for (const auto& arg : args)
+        cArgs.push_back(arg.c_str());
+
+    Opm::Parameters::reset();
+    if (Opm::setupParameters_<TypeTag>(static_cast<int>(cArgs.size()), cArgs.data()) != 0)
+        return 1;
+
+    Simulator simulator(/*verbose=*/false);
+    return checkUpdateThreshold(simulator, threshold);
+}
@@ -0,0 +1,253 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ *
+ * \brief Makes sure that the halo exchange of the overlapping vectors and matrices,
+ *        which uses persistent requests, yields the same results as exchanging the
+ *        values using blocking messages.
+ */
+#include "config.h"
+
+#include "overlap_test_grid.hh"
+
+#include <dune/common/fvector.hh>
+#include <dune/common/parallel/mpihelper.hh>
+#include <dune/istl/bvector.hh>
+
+#include <opm/models/parallel/mpibuffer.hh>
+#include <opm/simulators/linalg/overlappingbcrsmatrix.hh>
+#include <opm/simulators/linalg/overlappingblockvector.hh>
+#include <opm/simulators/linalg/overlaptypes.hh>
+
+#include <cstddef>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+namespace {
+
+using Opm::Linear::Index;
+using Opm::Linear::ProcessRank;
+
+using OverlappingMatrix = Opm::Linear::OverlappingBCRSMatrix<Opm::OverlapTest::Matrix>;
+using Overlap = OverlappingMatrix::Overlap;
+using Block = Dune::FieldVector<double, 1>;
+using BlockVector = Dune::BlockVector<Block>;
+using OverlappingVector = Opm::Linear::OverlappingBlockVector<Block, Overlap>;
+
+// Synchronizes an overlapping vector the way OverlappingBlockVector did before it used
+// persistent requests: The rows in the foreign overlap of each peer are sent together
+// with their global indices and the values are received in the order of the peers.
+void referenceSync([[maybe_unused]] BlockVector& x,
+                   [[maybe_unused]] const Overlap& overlap,
+                   [[maybe_unused]] bool add)
+{
+#if HAVE_MPI
+    const std::vector<ProcessRank> peerRanks(overlap.peerSet().begin(), overlap.peerSet().end());
+    const std::size_t numPeers = peerRanks.size();
+
+    std::vector<std::unique_ptr<Opm::MpiBuffer<unsigned> > > numRowsSendBuff(numPeers);
+    std::vector<std::unique_ptr<Opm::MpiBuffer<Index> > > indicesSendBuff(numPeers);
+    std::vector<std::unique_ptr<Opm::MpiBuffer<double> > > valuesSendBuff(numPeers);
+    for (std::size_t peerIdx = 0; peerIdx < numPeers; ++peerIdx) {
+        const ProcessRank peerRank = peerRanks[peerIdx];
+        const std::size_t numRows = overlap.foreignOverlapSize(peerRank);
+
+        numRowsSendBuff[peerIdx] = std::make_unique<Opm::MpiBuffer<unsigned> >(1);
+        indicesSendBuff[peerIdx] = std::make_unique<Opm::MpiBuffer<Index> >(numRows);
+        valuesSendBuff[peerIdx] = std::make_unique<Opm::MpiBuffer<double> >(numRows);
+
+        (*numRowsSendBuff[peerIdx])[0] = static_cast<unsigned>(numRows);
+        for (unsigned i = 0; i < numRows; ++i) {
+            const Index domRowIdx = overlap.foreignOverlapOffsetToDomesticIdx(peerRank, i);
+            (*indicesSendBuff[peerIdx])[i] = overlap.domesticToGlobal(domRowIdx);
+            (*valuesSendBuff[peerIdx])[i] = x[static_cast<unsigned>(domRowIdx)][0];
+        }
+
+        numRowsSendBuff[peerIdx]->send(peerRank);
+        indicesSendBuff[peerIdx]->send(peerRank);
+        valuesSendBuff[peerIdx]->send(peerRank);
+    }
+
+    for (const ProcessRank peerRank : peerRanks) {
+        Opm::MpiBuffer<unsigned> numRowsRecvBuff(1);
+        numRowsRecvBuff.receive(peerRank);
+        const unsigned numRows = numRowsRecvBuff[0];
+
+        Opm::MpiBuffer<Index> indicesRecvBuff(numRows);
+        indicesRecvBuff.receive(peerRank);
+        Opm::MpiBuffer<double> valuesRecvBuff(numRows);
+        valuesRecvBuff.receive(peerRank);
+
+        for (unsigned i = 0; i < numRows; ++i) {
+            const Index domRowIdx = overlap.globalToDomestic(indicesRecvBuff[i]);
+            double& value = x[static_cast<unsigned>(domRowIdx)][0];
+            if (add)
+                value += valuesRecvBuff[i];
+            else if (overlap.masterRank(domRowIdx) == peerRank)
+                value = valuesRecvBuff[i];
+        }
+    }
+
+    for (std::size_t peerIdx = 0; peerIdx < numPeers; ++peerIdx) {
+        numRowsSendBuff[peerIdx]->wait();
+        indicesSendBuff[peerIdx]->wait();
+        valuesSendBuff[peerIdx]->wait();
+    }
+#endif // HAVE_MPI
+}
+
+// the vector is synchronized several times to make sure that the persistent requests
+// can be restarted
+bool checkVectorSync(const Overlap& overlap, int rank, bool add)
+{
+    OverlappingVector x(overlap);
+
+    bool success = true;
+    for (int iterIdx = 0; iterIdx < 3; ++iterIdx) {
+        // integer values, so that the sums do not depend on the order of the additions
+        for (unsigned domIdx = 0; domIdx < x.size(); ++domIdx)
+            x[domIdx] = 100000.0*iterIdx + 1000.0*(rank + 1) + domIdx;
+
+        BlockVector reference(x);
+        referenceSync(reference, overlap, add);
+
+        if (add)
+            x.syncAdd();
+        else if (iterIdx == 0)
+            x.sync();
+        else {
+            x.syncBegin();
+            x.syncEnd();
+        }
+
+        for (unsigned domIdx = 0; domIdx < x.size(); ++domIdx) {
+            if (x[domIdx][0] != reference[domIdx][0]) {
+                std::cerr << (add ? "syncAdd()" : "sync()") << " yields " << x[domIdx][0]
+                          << " instead of " << reference[domIdx][0]
+                          << " for domestic index " << domIdx << "\n";
+                success = false;
+                break;
+            }
+        }
+    }
+
+    return success;
+}
+
+// The entries of the native matrix only depend on the cartesian indices of the
+// elements. Only the process which owns an element assembles its row, so both,
+// adding and copying the rows of the peers must reproduce the entries in all rows
+// but the ones on the front of the overlap.
+double entryValue(double scale, double rowCartIdx, double colCartIdx)
+{ return scale*(1000.0*rowCartIdx + colCartIdx + 1.0); }
+
+bool checkMatrixSync(const Opm::OverlapTest::GridView& gridView,
+                     const Opm::OverlapTest::ElementMapper& mapper,
+                     Opm::OverlapTest::Matrix nativeMatrix,
+                     OverlappingMatrix& overlappingMatrix)
+{
+    const Overlap& overlap = overlappingMatrix.overlap();
+
+    BlockVector nativeCartIdx(mapper.size());
+    std::vector<bool> isInterior(mapper.size(), false);
+    for (const auto& elem : elements(gridView)) {
+        const auto elemIdx = mapper.index(elem);
+        nativeCartIdx[elemIdx] = static_cast<double>(Opm::OverlapTest::cartesianIndex(elem));
+        isInterior[elemIdx] = elem.partitionType() == Dune::InteriorEntity;
+    }
+
+    OverlappingVector cartIdx(overlap);
+    cartIdx.assign(nativeCartIdx);
+
+    bool success = true;
+    for (int iterIdx = 0; iterIdx < 3; ++iterIdx) {
+        const double scale = iterIdx + 1.0;
+        for (auto rowIt = nativeMatrix.begin(); rowIt != nativeMatrix.end(); ++rowIt) {
+            const auto rowIdx = rowIt.index();
+            for (auto colIt = rowIt->begin(); colIt != rowIt->end(); ++colIt)
+                *colIt = isInterior[rowIdx]
+                    ? entryValue(scale, nativeCartIdx[rowIdx][0], nativeCartIdx[colIt.index()][0])
+                    : 0.0;
+        }
+
+        if (iterIdx == 1)
+            overlappingMatrix.assignCopy(nativeMatrix);
+        else
+            overlappingMatrix.assignAdd(nativeMatrix);
+
+        for (unsigned rowIdx = 0; rowIdx < overlappingMatrix.N(); ++rowIdx) {
+            if (overlap.isFront(static_cast<Index>(rowIdx)))
+                continue;
+
+            const auto& row = overlappingMatrix[rowIdx];
+            for (auto colIt = row.begin(); colIt != row.end(); ++colIt) {
+                const double expected = entryValue(scale, cartIdx[rowIdx][0], cartIdx[colIt.index()][0]);
+                if ((*colIt)[0][0] != expected) {
+                    // only report the first wrong entry
+                    if (success)
+                        std::cerr << (iterIdx == 1 ? "assignCopy()" : "assignAdd()")
+                                  << " yields " << (*colIt)[0][0] << " instead of " << expected
+                                  << " for the domestic entry (" << rowIdx << ", " << colIt.index() << ")\n";
+                    success = false;
+                }
+            }
+        }
+    }
+
+    return success;
+}
+
+} // anonymous namespace
+
+int main(int argc, char **argv)
+{
+    const auto& mpiHelper = Dune::MPIHelper::instance(argc, argv);
+    const auto comm = mpiHelper.getCommunication();
+
+    const auto grid = Opm::OverlapTest::createGrid();
+    const auto gridView = grid->leafGridView();
+    const Opm::OverlapTest::ElementMapper mapper(gridView, Dune::mcmgElementLayout());
+    const Opm::OverlapTest::BorderListFromGrid borderListFromGrid(gridView, mapper);
+    const auto nativeMatrix = Opm::OverlapTest::createMatrix(gridView, mapper);
+
+    // with an overlap of two layers, the overlap exhibits rows which are neither local
+    // nor on its front
+    OverlappingMatrix overlappingMatrix(nativeMatrix,
+                                        borderListFromGrid.borderList(),
+                                        borderListFromGrid.blackList(),
+                                        /*overlapSize=*/2);
+    const Overlap& overlap = overlappingMatrix.overlap();
+
+    // the checks are not short-circuited because the exchanges are collective
+    bool success = checkVectorSync(overlap, comm.rank(), /*add=*/false);
+    success = checkVectorSync(overlap, comm.rank(), /*add=*/true) && success;
+    success = checkMatrixSync(gridView, mapper, nativeMatrix, overlappingMatrix) && success;
+
+    // a failure on any process lets all of them fail
+    if (comm.min(success ? 1 : 0) == 0)
+        return 1;
+
+    return 0;
+}
@@ -0,0 +1,350 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ *
+ * \brief Makes sure that the setup of the algebraic overlap yields the same global
+ *        indices as the original implementation, and that the black-listed indices
+ *        are mapped to the domestic indices of their elements.
+ */
+#include "config.h"
+
+#include "overlap_test_grid.hh"
+
+#include <dune/common/parallel/mpihelper.hh>
+#include <dune/common/version.hh>
+#include <dune/grid/common/datahandleif.hh>
+#include <dune/grid/common/gridenums.hh>
+
+#include <opm/simulators/linalg/domesticoverlapfrombcrsmatrix.hh>
+#include <opm/simulators/linalg/foreignoverlapfrombcrsmatrix.hh>
+#include <opm/simulators/linalg/globalindices.hh>
+#include <opm/simulators/linalg/overlaptypes.hh>
+
+#include <cstddef>
+#include <iostream>
+#include <map>
+#include <vector>
+
+#if HAVE_MPI
+#include <mpi.h>
+#endif
+
+namespace {
+
+using Opm::Linear::BorderList;
+using Opm::Linear::Index;
+using Opm::Linear::ProcessRank;
+
+#if HAVE_MPI
+// The global indices as they were computed before the overlap setup was rewritten:
+// The offsets of the master indices are passed from rank to rank and each border
+// index is sent using a blocking message of its own.
+template <class ForeignOverlap>
+class ReferenceGlobalIndices
+{
+public:
+    explicit ReferenceGlobalIndices(const ForeignOverlap& foreignOverlap)
+        : foreignOverlap_(foreignOverlap)
+    {
+        int tmp;
+        MPI_Comm_rank(MPI_COMM_WORLD, &tmp);
+        myRank_ = static_cast<ProcessRank>(tmp);
+        MPI_Comm_size(MPI_COMM_WORLD, &tmp);
+        mpiSize_ = static_cast<ProcessRank>(tmp);
+
+        int domesticOffset = 0;
+        if (myRank_ > 0)
+            MPI_Recv(&domesticOffset, 1, MPI_INT, static_cast<int>(myRank_ - 1), 0,
+                     MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+
+        int numMaster = 0;
+        for (unsigned i = 0; i < foreignOverlap_.numLocal(); ++i) {
+            if (!foreignOverlap_.iAmMasterOf(static_cast<Index>(i)))
+                continue;
+
+            addIndex_(static_cast<Index>(i), domesticOffset + numMaster);
+            ++numMaster;
+        }
+
+        if (myRank_ < mpiSize_ - 1) {
+            int nextOffset = domesticOffset + numMaster;
+            MPI_Send(&nextOffset, 1, MPI_INT, static_cast<int>(myRank_ + 1), 0, MPI_COMM_WORLD);
+        }
+
+        const auto& peerSet = foreignOverlap_.peerSet();
+        for (const ProcessRank peerRank : peerSet)
+            if (peerRank < myRank_)
+                receiveBorderFrom_(peerRank);
+        for (const ProcessRank peerRank : peerSet)
+            if (peerRank > myRank_)
+                sendBorderTo_(peerRank);
+        for (const ProcessRank peerRank : peerSet)
+            if (peerRank > myRank_)
+                receiveBorderFrom_(peerRank);
+        for (const ProcessRank peerRank : peerSet)
+            if (peerRank < myRank_)
+                sendBorderTo_(peerRank);
+    }
+
+    const std::map<Index, Index>& domesticToGlobal() const
+    { return domesticToGlobal_; }
+
+    const std::map<Index, Index>& globalToDomestic() const
+    { return globalToDomestic_; }
+
+private:
+    void addIndex_(Index domesticIdx, Index globalIdx)
+    {
+        domesticToGlobal_[domesticIdx] = globalIdx;
+        globalToDomestic_[globalIdx] = domesticIdx;
+    }
+
+    void sendBorderTo_(ProcessRank peerRank)
+    {
+        for (const auto& borderIdx : foreignOverlap_.borderList()) {
+            if (borderIdx.peerRank != peerRank || borderIdx.borderDistance != 0)
+                continue;
+
+            const Index localIdx = foreignOverlap_.nativeToLocal(borderIdx.localIdx);
+            if (localIdx < 0 || !foreignOverlap_.iAmMasterOf(localIdx))
+                continue;
+
+            Opm::Linear::PeerIndexGlobalIndex sendBuf;
+            sendBuf.peerIdx = borderIdx.peerIdx;
+            sendBuf.globalIdx = domesticToGlobal_.at(localIdx);
+            MPI_Send(&sendBuf, sizeof(sendBuf), MPI_BYTE, static_cast<int>(peerRank), 0,
+                     MPI_COMM_WORLD);
+        }
+    }
+
+    void receiveBorderFrom_(ProcessRank peerRank)
+    {
+        for (const auto& borderIdx : foreignOverlap_.borderList()) {
+            if (borderIdx.peerRank != peerRank || borderIdx.borderDistance != 0)
+                continue;
+
+            const Index localIdx = foreignOverlap_.nativeToLocal(borderIdx.localIdx);
+            if (localIdx < 0 || foreignOverlap_.masterRank(localIdx) != peerRank)
+                continue;
+
+            Opm::Linear::PeerIndexGlobalIndex recvBuf;
+            MPI_Recv(&recvBuf, sizeof(recvBuf), MPI_BYTE, static_cast<int>(peerRank), 0,
+                     MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+
+            const Index domesticIdx = foreignOverlap_.nativeToLocal(recvBuf.peerIdx);
+            if (domesticIdx >= 0)
+                addIndex_(domesticIdx, recvBuf.globalIdx);
+        }
+    }
+
+    const ForeignOverlap& foreignOverlap_;
+    ProcessRank myRank_;
+    ProcessRank mpiSize_;
+
+    std::map<Index, Index> domesticToGlobal_;
+    std::map<Index, Index> globalToDomestic_;
+};
+#endif // HAVE_MPI
+
+// Sends the global index of each interior element to the processes which have a
+// copy of it and stores the corresponding domestic index on the receiving side.
+template <class Overlap>
+class ExpectedDomesticIndexHandle
+    : public Dune::CommDataHandleIF<ExpectedDomesticIndexHandle<Overlap>, Index>
+{
+public:
+    ExpectedDomesticIndexHandle(const Opm::OverlapTest::ElementMapper& mapper,
+                                const Overlap& overlap,
+                                std::map<Index, Index>& expected)
+        : mapper_(mapper)
+        , overlap_(overlap)
+        , expected_(expected)
+    {}
+
+    bool contains(int, int codim) const
+    { return codim == 0; }
+
+#if DUNE_VERSION_LT(DUNE_GRID, 2, 8)
+    bool fixedsize(int, int) const
+#else
+    bool fixedSize(int, int) const
+#endif
+    { return true; }
+
+    template <class EntityType>
+    std::size_t size(const EntityType&) const
+    { return 1; }
+
+    template <class MessageBufferImp, class EntityType>
+    void gather(MessageBufferImp& buff, const EntityType& e) const
+    {
+        const Index nativeIdx = static_cast<Index>(mapper_.index(e));
+        buff.write(overlap_.domesticToGlobal(overlap_.nativeToDomestic(nativeIdx)));
+    }
+
+    template <class MessageBufferImp, class EntityType>
+    void scatter(MessageBufferImp& buff, const EntityType& e, std::size_t)
+    {
+        Index globalIdx;
+        buff.read(globalIdx);
+        expected_[static_cast<Index>(mapper_.index(e))] = overlap_.globalToDomestic(globalIdx);
+    }
+
+private:
+    const Opm::OverlapTest::ElementMapper& mapper_;
+    const Overlap& overlap_;
+    std::map<Index, Index>& expected_;
+};
+
+// the border indices must be the local indices of the border list
+template <class ForeignOverlap>
+bool checkBorderIndices(const ForeignOverlap& foreignOverlap, const BorderList& borderList)
+{
+    std::vector<bool> expectedBorder(foreignOverlap.numLocal(), false);
+    for (const auto& borderIdx : borderList) {
+        const Index localIdx = foreignOverlap.nativeToLocal(borderIdx.localIdx);
+        if (localIdx >= 0)
+            expectedBorder[static_cast<std::size_t>(localIdx)] = true;
+    }
+
+    for (std::size_t localIdx = 0; localIdx < foreignOverlap.numLocal(); ++localIdx) {
+        if (foreignOverlap.isBorder(static_cast<Index>(localIdx)) != expectedBorder[localIdx]) {
+            std::cerr << "Wrong border flag for local index " << localIdx << "\n";
+            return false;
+        }
+    }
+
+    return true;
+}
+
+template <class ForeignOverlap>
+bool checkGlobalIndices([[maybe_unused]] const ForeignOverlap& foreignOverlap)
+{
+#if HAVE_MPI
+    const Opm::Linear::GlobalIndices<ForeignOverlap> globalIndices(foreignOverlap);
+    const ReferenceGlobalIndices<ForeignOverlap> reference(foreignOverlap);
+
+    if (globalIndices.numDomestic() != reference.domesticToGlobal().size()) {
+        std::cerr << "Wrong number of domestic indices: " << globalIndices.numDomestic()
+                  << " instead of " << reference.domesticToGlobal().size() << "\n";
+        return false;
+    }
+
+    for (const auto& [domesticIdx, globalIdx] : reference.domesticToGlobal()) {
+        if (globalIndices.domesticToGlobal(domesticIdx) != globalIdx) {
+            std::cerr << "Wrong global index for domestic index " << domesticIdx << ": "
+                      << globalIndices.domesticToGlobal(domesticIdx)
+                      << " instead of " << globalIdx << "\n";
+            return false;
+        }
+    }
+
+    for (const auto& [globalIdx, domesticIdx] : reference.globalToDomestic()) {
+        if (globalIndices.globalToDomestic(globalIdx) != domesticIdx) {
+            std::cerr << "Wrong domestic index for global index " << globalIdx << ": "
+                      << globalIndices.globalToDomestic(globalIdx)
+                      << " instead of " << domesticIdx << "\n";
+            return false;
+        }
+    }
+#endif // HAVE_MPI
+
+    return true;
+}
+
+// each black-listed element must be mapped to the domestic index which corresponds to
+// its interior copy on the process which owns it
+template <class Overlap>
+bool checkBlackList(const Opm::OverlapTest::GridView& gridView,
+                    const Opm::OverlapTest::ElementMapper& mapper,
+                    const Overlap& overlap)
+{
+    std::map<Index, Index> expected;
+    ExpectedDomesticIndexHandle<Overlap> handle(mapper, overlap, expected);
+    gridView.communicate(handle,
+                         Dune::InteriorBorder_All_Interface,
+                         Dune::ForwardCommunication);
+
+    const auto& blackList = overlap.blackList();
+    for (const auto& elem : elements(gridView)) {
+        const Index nativeIdx = static_cast<Index>(mapper.index(elem));
+        const bool isInterior = elem.partitionType() == Dune::InteriorEntity;
+        if (blackList.hasIndex(nativeIdx) == isInterior) {
+            std::cerr << "Wrong black list entry for native index " << nativeIdx << "\n";
+            return false;
+        }
+
+        if (isInterior)
+            continue;
+
+        const auto expectedIt = expected.find(nativeIdx);
+        const Index expectedIdx = expectedIt == expected.end() ? -1 : expectedIt->second;
+        if (blackList.nativeToDomestic(nativeIdx) != expectedIdx) {
+            std::cerr << "Wrong domestic index for the black-listed native index " << nativeIdx
+                      << ": " << blackList.nativeToDomestic(nativeIdx)
+                      << " instead of " << expectedIdx << "\n";
+            return false;
+        }
+    }
+
+    return true;
+}
+
+} // anonymous namespace
+
+int main(int argc, char **argv)
+{
+    const auto& mpiHelper = Dune::MPIHelper::instance(argc, argv);
+    const auto comm = mpiHelper.getCommunication();
+
+    const auto grid = Opm::OverlapTest::createGrid();
+    const auto gridView = grid->leafGridView();
+    const Opm::OverlapTest::ElementMapper mapper(gridView, Dune::mcmgElementLayout());
+    const Opm::OverlapTest::BorderListFromGrid borderListFromGrid(gridView, mapper);
+    const auto matrix = Opm::OverlapTest::createMatrix(gridView, mapper);
+
+    for (unsigned overlapSize = 1; overlapSize <= 2; ++overlapSize) {
+        // the checks are not short-circuited because the overlap is set up collectively
+        const Opm::Linear::ForeignOverlapFromBCRSMatrix foreignOverlap(matrix,
+                                                                       borderListFromGrid.borderList(),
+                                                                       borderListFromGrid.blackList(),
+                                                                       overlapSize);
+        bool success = checkBorderIndices(foreignOverlap, borderListFromGrid.borderList());
+        success = checkGlobalIndices(foreignOverlap) && success;
+
+        const Opm::Linear::DomesticOverlapFromBCRSMatrix domesticOverlap(matrix,
+                                                                         borderListFromGrid.borderList(),
+                                                                         borderListFromGrid.blackList(),
+                                                                         overlapSize);
+        success = checkBlackList(gridView, mapper, domesticOverlap) && success;
+
+        // a failure on any process lets all of them fail
+        if (comm.min(success ? 1 : 0) == 0) {
+            std::cerr << "The overlap of size " << overlapSize << " is wrong\n";
+            return 1;
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,138 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ *
+ * \brief Makes sure that the reverse Cuthill-McKee element mapper yields a permutation
+ *        of the element indices which reduces the bandwidth of the adjacency graph.
+ */
+#include "config.h"
+
+#include <dune/common/version.hh>
+#include <dune/common/parallel/mpihelper.hh>
+#include <dune/grid/common/mcmgmapper.hh>
+#include <dune/grid/yaspgrid.hh>
+
+#include <opm/models/discretization/common/rcmelementmapper.hh>
+
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+namespace {
+
+// the largest difference between the indices of two neighboring elements
+template <class GridView, class Mapper>
+long bandwidth(const GridView& gridView, const Mapper& mapper)
+{
+    long result = 0;
+    for (const auto& elem : elements(gridView)) {
+        const long elemIdx = static_cast<long>(mapper.index(elem));
+        for (const auto& intersection : intersections(gridView, elem)) {
+            if (!intersection.neighbor())
+                continue;
+
+            const long neighborIdx = static_cast<long>(mapper.index(intersection.outside()));
+            result = std::max(result, std::abs(elemIdx - neighborIdx));
+        }
+    }
+
+    return result;
+}
+
+} // anonymous namespace
+
+int main(int argc, char **argv)
+{
+    Dune::MPIHelper::instance(argc, argv);
+
+    using Grid = Dune::YaspGrid<2>;
+    using GridView = Grid::LeafGridView;
+
+    // the grid's index set numbers the elements along the long axis first
+    Grid grid({1.0, 0.2}, {40, 8});
+    const GridView gridView = grid.leafGridView();
+
+    Dune::MultipleCodimMultipleGeomTypeMapper<GridView> gridMapper(gridView, Dune::mcmgElementLayout());
+    Opm::RcmElementMapper<GridView> rcmMapper(gridView, Dune::mcmgElementLayout());
+
+    if (rcmMapper.size() != gridMapper.size()) {
+        std::cerr << "Wrong number of elements\n";
+        return 1;
+    }
+
+    std::vector<int> numHits(rcmMapper.size(), 0);
+    for (const auto& elem : elements(gridView)) {
+        const auto idx = rcmMapper.index(elem);
+        if (idx >= rcmMapper.size()) {
+            std::cerr << "Element index " << idx << " is out of range\n";
+            return 1;
+        }
+
+        ++numHits[idx];
+        if (rcmMapper.gridIndex(idx) != gridMapper.index(elem)) {
+            std::cerr << "The inverse permutation is wrong for element " << idx << "\n";
+            return 1;
+        }
+    }
+
+    if (std::any_of(numHits.begin(), numHits.end(), [](int n) { return n != 1; })) {
+        std::cerr << "The element indices are not a permutation\n";
+        return 1;
+    }
+
+    const long gridBandwidth = bandwidth(gridView, gridMapper);
+    const long rcmBandwidth = bandwidth(gridView, rcmMapper);
+    std::cout << "bandwidth of the grid's ordering: " << gridBandwidth << "\n"
+              << "bandwidth of the RCM ordering: " << rcmBandwidth << "\n";
+
+    if (rcmBandwidth >= gridBandwidth) {
+        std::cerr << "The RCM ordering does not reduce the bandwidth\n";
+        return 1;
+    }
+
+    // the ordering must be recomputed consistently if the grid changes
+    grid.globalRefine(1);
+    const GridView refinedGridView = grid.leafGridView();
+#if DUNE_VERSION_NEWER(DUNE_GRID, 2, 8)
+    rcmMapper.update(refinedGridView);
+#else
+    rcmMapper.update();
+#endif
+    if (static_cast<int>(rcmMapper.size()) != refinedGridView.size(0)) {
+        std::cerr << "Wrong number of elements after refinement\n";
+        return 1;
+    }
+
+    numHits.assign(rcmMapper.size(), 0);
+    for (const auto& elem : elements(refinedGridView))
+        ++numHits[rcmMapper.index(elem)];
+
+    if (std::any_of(numHits.begin(), numHits.end(), [](int n) { return n != 1; })) {
+        std::cerr << "The element indices are not a permutation after refinement\n";
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,133 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ *
+ * \brief Makes sure that the two-pass sparsity pattern yields the same matrix structure
+ *        as one std::set per row.
+ */
+#include "config.h"
+
+#include <dune/common/fmatrix.hh>
+#include <dune/common/parallel/mpihelper.hh>
+
+#include <opm/simulators/linalg/istlsparsematrixadapter.hh>
+#include <opm/simulators/linalg/sparsitypattern.hh>
+
+#include <algorithm>
+#include <cstddef>
+#include <iostream>
+#include <set>
+#include <vector>
+
+namespace {
+
+// the neighbors of a cell of a periodic 1D grid, including the cell itself. the
+// neighbors are visited twice to produce duplicates.
+std::vector<unsigned> neighbors(unsigned rowIdx, unsigned numRows)
+{
+    const unsigned left = (rowIdx + numRows - 1) % numRows;
+    const unsigned right = (rowIdx + 1) % numRows;
+    return {right, rowIdx, left, right, left};
+}
+
+} // anonymous namespace
+
+int main(int argc, char **argv)
+{
+    Dune::MPIHelper::instance(argc, argv);
+
+    using MatrixBlock = Dune::FieldMatrix<double, 2, 2>;
+    using Adapter = Opm::Linear::IstlSparseMatrixAdapter<MatrixBlock>;
+
+    const unsigned numRows = 1000;
+
+    std::vector<std::set<unsigned>> setPattern(numRows);
+    for (unsigned rowIdx = 0; rowIdx < numRows; ++rowIdx)
+        for (unsigned colIdx : neighbors(rowIdx, numRows))
+            setPattern[rowIdx].insert(colIdx);
+    // an additional coupling, like the ones of auxiliary modules
+    setPattern[3].insert(500);
+
+    Opm::Linear::SparsityPattern pattern(numRows);
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+    for (int rowIdx = 0; rowIdx < static_cast<int>(numRows); ++rowIdx)
+        pattern.reserveEntries(rowIdx, neighbors(rowIdx, numRows).size());
+    pattern.reserveEntries(3, 1);
+    // reserving more entries than required must be harmless
+    pattern.reserveEntries(7, 10);
+
+    pattern.allocate();
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+    for (int rowIdx = 0; rowIdx < static_cast<int>(numRows); ++rowIdx)
+        for (unsigned colIdx : neighbors(rowIdx, numRows))
+            pattern.addEntry(rowIdx, colIdx);
+    pattern.addEntry(3, 500);
+    pattern.finalize();
+
+    std::size_t numNonZeros = 0;
+    for (unsigned rowIdx = 0; rowIdx < numRows; ++rowIdx) {
+        const auto row = pattern[rowIdx];
+        if (!std::equal(row.begin(), row.end(), setPattern[rowIdx].begin(), setPattern[rowIdx].end())) {
+            std::cerr << "Row " << rowIdx << " of the sparsity pattern is wrong\n";
+            return 1;
+        }
+        numNonZeros += setPattern[rowIdx].size();
+    }
+    if (pattern.numNonZeros() != numNonZeros) {
+        std::cerr << "Wrong number of non-zero entries\n";
+        return 1;
+    }
+
+    Adapter setMatrix(numRows, numRows);
+    setMatrix.reserve(setPattern);
+    Adapter csrMatrix(numRows, numRows);
+    csrMatrix.reserve(pattern);
+
+    const auto& A = setMatrix.istlMatrix();
+    const auto& B = csrMatrix.istlMatrix();
+    if (A.nonzeroes() != B.nonzeroes()) {
+        std::cerr << "The matrices have a different number of non-zero blocks\n";
+        return 1;
+    }
+    for (unsigned rowIdx = 0; rowIdx < numRows; ++rowIdx) {
+        auto colA = A[rowIdx].begin();
+        auto colB = B[rowIdx].begin();
+        for (; colA != A[rowIdx].end() && colB != B[rowIdx].end(); ++colA, ++colB) {
+            if (colA.index() != colB.index()) {
+                std::cerr << "The structure of row " << rowIdx << " is wrong\n";
+                return 1;
+            }
+        }
+        if (colA != A[rowIdx].end() || colB != B[rowIdx].end()) {
+            std::cerr << "Row " << rowIdx << " has the wrong number of blocks\n";
+            return 1;
+        }
+    }
+
+    return 0;
+}
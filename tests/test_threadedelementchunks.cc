@@ -0,0 +1,125 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ *
+ * \brief Makes sure that the threaded element chunks visit each element exactly once.
+ */
+#include "config.h"
+
+#include <dune/common/parallel/mpihelper.hh>
+#include <dune/grid/common/mcmgmapper.hh>
+#include <dune/grid/yaspgrid.hh>
+
+#include <opm/models/parallel/threadedelementchunks.hh>
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <iostream>
+#include <stdexcept>
+#include <vector>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+int main(int argc, char **argv)
+{
+    Dune::MPIHelper::instance(argc, argv);
+
+    using Grid = Dune::YaspGrid<3>;
+    using GridView = Grid::LeafGridView;
+    using Element = GridView::Codim<0>::Entity;
+
+    Grid grid({1.0, 1.0, 1.0}, {17, 13, 11});
+    const GridView gridView = grid.leafGridView();
+    Dune::MultipleCodimMultipleGeomTypeMapper<GridView> elementMapper(gridView, Dune::mcmgElementLayout());
+
+    unsigned numThreads = 1;
+#ifdef _OPENMP
+    numThreads = static_cast<unsigned>(omp_get_max_threads());
+#endif
+
+    for (unsigned chunkSize : {1u, 7u, 128u, 100000u}) {
+        Opm::ThreadedElementChunks<GridView> chunks(gridView, numThreads, chunkSize);
+        if (chunks.size() != static_cast<std::size_t>(gridView.size(0))) {
+            std::cerr << "Wrong number of elements for chunk size " << chunkSize << "\n";
+            return 1;
+        }
+
+        std::vector<std::atomic<int>> numVisits(gridView.size(0));
+        std::vector<std::atomic<int>> numPrefetches(gridView.size(0));
+        chunks.forEachParallel([&](const Element& elem, unsigned threadId)
+        {
+            if (threadId >= numThreads)
+                throw std::logic_error("invalid thread index");
+            ++numVisits[elementMapper.index(elem)];
+        },
+        [&](const Element& nextElem)
+        {
+            // an element must be prefetched before it is visited
+            if (numVisits[elementMapper.index(nextElem)] != 0)
+                throw std::logic_error("element prefetched after it was visited");
+            ++numPrefetches[elementMapper.index(nextElem)];
+        });
+
+        std::size_t totalPrefetches = 0;
+        for (std::size_t elemIdx = 0; elemIdx < numVisits.size(); ++elemIdx) {
+            if (numVisits[elemIdx] != 1) {
+                std::cerr << "Element visited " << numVisits[elemIdx] << " times for chunk size "
+                          << chunkSize << "\n";
+                return 1;
+            }
+            totalPrefetches += numPrefetches[elemIdx];
+        }
+
+        // all elements except the first one of each chunk are prefetched
+        if (totalPrefetches != chunks.size() - chunks.numChunks()) {
+            std::cerr << "Wrong number of prefetched elements for chunk size "
+                      << chunkSize << "\n";
+            return 1;
+        }
+    }
+
+    // exceptions thrown by the functor must be propagated to the caller
+    Opm::ThreadedElementChunks<GridView> chunks(gridView, numThreads, /*chunkSize=*/16);
+    bool caught = false;
+    try {
+        chunks.forEachParallel([&](const Element& elem, unsigned)
+        {
+            if (elementMapper.index(elem) == 42)
+                throw std::runtime_error("expected failure");
+        });
+    }
+    catch (const std::runtime_error&) {
+        caught = true;
+    }
+
+    if (!caught) {
+        std::cerr << "Exception was not propagated out of the parallel loop\n";
+        return 1;
+    }
+
+    return 0;
+}